@@ -7,7 +7,7 @@
 	This example code is in the public domain.
 
 	created Jan 12 2017
-	latest mod Nov 30 2017
+	latest mod Oct 16 2026
 	by SMFSW
 */
 
@@ -130,31 +130,17 @@ bool I2C_rd_advanced(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data,
 }
 
 
-/*! \brief This procedure calls appropriate functions to get chip ID of FUJITSU devices.
+/*! \brief This procedure gets chip ID of FUJITSU devices (combined transfer: command, then read after a repeated START).
  *  \param [in, out] slave - pointer to the I2C slave structure
  *  \param [in, out] data - pointer to the first byte of a block of data to read
  *  \return Boolean indicating success/fail of read attempt
  */
 bool I2C_get_chip_id(I2C_SLAVE * slave, uint8_t * data)
 {
-	const uint16_t bytes = 3;
-	I2C_SLAVE FRAM_ID;
+	uint8_t cmd = slave->cfg.addr << 1;
+	const I2C_MSG msgs[2] = {
+		{ 0xF8 >> 1, 0, 1, &cmd },				// Device ID command (slave address)
+		{ 0xF8 >> 1, I2C_MSG_RD, 3, data } };	// 3 bytes Device ID
 
-	I2C_slave_init(&FRAM_ID, 0xF8 >> 1, I2C_16B_REG);	// Dummy slave init for I2C_sndAddr
-
-	if (I2C_start() == false)										{ return false; }
-	if (I2C_sndAddr(&FRAM_ID, I2C_WRITE) == false)					{ return false; }
-	if (I2C_wr8(slave->cfg.addr << 1) == false)						{ return false; }
-	if (I2C_start() == false)										{ return false; }
-	if (I2C_sndAddr(&FRAM_ID, I2C_READ) == false)					{ return false; }
-
-	for (uint16_t cnt = 0; cnt < bytes; cnt++)
-	{
-		if (I2C_rd8((cnt == (bytes - 1)) ? false : true) == false)	{ return false; }
-		*data++ = TWDR;
-	}
-
-	if (I2C_stop() == false)										{ return false; }
-
-	return true;
+	return (I2C_transfer(NULL, msgs, 2) == I2C_OK);
 }
@@ -0,0 +1,126 @@
+/*!\file Arduino.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief Linux replacement of Arduino core header (timing services from monotonic clock, AVR registers as plain storage)
+** \details Hardware TWI is absent: its registers only exist so that cI2C builds unmodified, transactions go through i2c-dev buses (ci2c_linux.h).
+**/
+/****************************************************************/
+#ifndef __CI2C_LINUX_ARDUINO_H__
+	#define __CI2C_LINUX_ARDUINO_H__
+/****************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef F_CPU
+#define F_CPU			16000000UL		//!< Nominal CPU frequency (hardware TWI & bit-banged bus clock computations only)
+#endif
+
+/*!\enum enLINUX_REG
+** \brief Placeholder registers index in storage
+**/
+typedef enum enLINUX_REG {
+	LINUX_TWCR = 0,		//!< TWI control register
+	LINUX_TWSR,			//!< TWI status register
+	LINUX_TWDR,			//!< TWI data register
+	LINUX_TWBR,			//!< TWI bit rate register
+	LINUX_TWAR,			//!< TWI (slave) address register
+	LINUX_TWAMR,		//!< TWI (slave) address mask register
+	LINUX_SREG,			//!< Status register (global interrupt flag)
+	LINUX_PORTC,		//!< Port C
+	LINUX_PORTD,		//!< Port D
+	LINUX_NB_REGS		//!< Number of placeholder registers
+} LINUX_REG;
+
+extern volatile uint8_t	linux_regs[];		//!< Placeholder registers storage
+
+// Registers
+#define TWCR			(linux_regs[LINUX_TWCR])			//!< TWI control register
+#define TWSR			(linux_regs[LINUX_TWSR])			//!< TWI status register
+#define TWDR			(linux_regs[LINUX_TWDR])			//!< TWI data register
+#define TWBR			(linux_regs[LINUX_TWBR])			//!< TWI bit rate register
+#define TWAR			(linux_regs[LINUX_TWAR])			//!< TWI (slave) address register
+#define TWAMR			(linux_regs[LINUX_TWAMR])			//!< TWI (slave) address mask register
+#define SREG			(linux_regs[LINUX_SREG])			//!< Status register
+#define PORTC			(linux_regs[LINUX_PORTC])			//!< Port C
+#define PORTD			(linux_regs[LINUX_PORTD])			//!< Port D
+
+// Pins (no GPIO: bit-banged bus init fails)
+#define NOT_A_PIN					0										//!< Invalid port
+#define digitalPinToPort(p)			NOT_A_PIN								//!< Port of pin \b p
+#define digitalPinToBitMask(p)		((uint8_t) (1 << ((p) & 7)))			//!< Mask of pin \b p in its port
+#define portInputRegister(P)		(&linux_regs[LINUX_PORTC])				//!< Input register of port \b P
+#define portModeRegister(P)			(&linux_regs[LINUX_PORTC])				//!< Direction register of port \b P
+#define portOutputRegister(P)		(&linux_regs[LINUX_PORTC])				//!< Output register of port \b P
+
+// TWCR bits
+#define TWINT			7	//!< TWI interrupt flag
+#define TWEA			6	//!< TWI enable acknowledge
+#define TWSTA			5	//!< TWI start condition
+#define TWSTO			4	//!< TWI stop condition
+#define TWWC			3	//!< TWI write collision flag
+#define TWEN			2	//!< TWI enable
+#define TWIE			0	//!< TWI interrupt enable
+
+// TWSR bits
+#define TWPS1			1	//!< TWI prescaler bit 1
+#define TWPS0			0	//!< TWI prescaler bit 0
+
+// TWAR bits
+#define TWGCE			0	//!< TWI general call enable
+
+// Interrupts (TWI interrupt never fires)
+#define ISR(vector)		void vector(void)					//!< Interrupt vectors are plain functions
+#define cli()			(SREG &= (uint8_t) ~0x80)			//!< Disable global interrupts
+#define sei()			(SREG |= 0x80)						//!< Enable global interrupts
+
+// Program memory (plain memory)
+#define PROGMEM														//!< Program memory attribute
+#define PSTR(s)					(s)									//!< Program memory string
+#define pgm_read_byte(addr)		(*(const uint8_t *) (addr))			//!< Read byte from program memory
+#define pgm_read_word(addr)		(*(const uint16_t *) (addr))		//!< Read word from program memory
+#define pgm_read_dword(addr)	(*(const uint32_t *) (addr))		//!< Read double word from program memory
+#define pgm_read_ptr(addr)		(*(void * const *) (addr))			//!< Read pointer from program memory
+#define memcpy_P				memcpy								//!< Copy from program memory
+
+
+/*!\brief Milliseconds elapsed since first time service call (monotonic clock)
+** \return elapsed time (ms)
+**/
+unsigned long millis(void);
+
+/*!\brief Microseconds elapsed since first time service call (monotonic clock)
+** \return elapsed time (us)
+**/
+unsigned long micros(void);
+
+/*!\brief Sleep
+** \param [in] ms - number of milliseconds
+** \return nothing
+**/
+void delay(unsigned long ms);
+
+/*!\brief Sleep
+** \param [in] us - number of microseconds
+** \return nothing
+**/
+void delayMicroseconds(unsigned int us);
+
+/*!\brief Busy loop (bit-banged bus only, unused on Linux)
+** \param [in] count - number of loops (0 for 256)
+** \return nothing
+**/
+void _delay_loop_1(uint8_t count);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+/*!\file arduino_linux.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief Linux replacement of Arduino core services used by cI2C
+**/
+
+#include <time.h>
+
+#include "Arduino.h"
+
+
+volatile uint8_t	linux_regs[LINUX_NB_REGS];		//!< Placeholder registers storage
+static uint64_t		linux_t0_us;					//!< Monotonic clock origin (us)
+
+
+/*!\brief Monotonic clock
+** \return clock value (us)
+**/
+static uint64_t linux_clock_us(void)
+{
+	struct timespec ts;
+
+	(void) clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000ULL) + ((uint64_t) ts.tv_nsec / 1000U);
+}
+
+/*!\brief Microseconds elapsed since first time service call (origin taken on first call)
+** \return elapsed time (us)
+**/
+static uint64_t linux_elapsed_us(void)
+{
+	const uint64_t now = linux_clock_us();
+
+	if (linux_t0_us == 0)	{ linux_t0_us = now; }
+	return now - linux_t0_us;
+}
+
+/*!\brief Sleep for a number of microseconds
+** \param [in] us - number of microseconds
+** \return nothing
+**/
+static void linux_sleep_us(const uint64_t us)
+{
+	struct timespec ts = { (time_t) (us / 1000000U), (long) ((us % 1000000U) * 1000U) };
+
+	while (nanosleep(&ts, &ts) != 0) {}	// Resumed when interrupted by a signal
+}
+
+
+unsigned long millis(void) {
+	return (unsigned long) (linux_elapsed_us() / 1000U); }
+
+unsigned long micros(void) {
+	return (unsigned long) linux_elapsed_us(); }
+
+void delay(unsigned long ms) {
+	linux_sleep_us((uint64_t) ms * 1000U); }
+
+void delayMicroseconds(unsigned int us) {
+	linux_sleep_us(us); }
+
+void _delay_loop_1(uint8_t count) {
+	(void) count; }
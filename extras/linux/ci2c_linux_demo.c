@@ -0,0 +1,140 @@
+/*!\file ci2c_linux_demo.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief cI2C on Linux i2c-dev: unchanged driver code over a Linux bus, I2C_RDWR calls counted per transaction
+** \details Without argument, transactions run against an in-process fake adapter (256 bytes memory device, 8 bits register address @0x50);
+**			with an adapter number, /dev/i2c-N is opened (optional 7 bits device address, 0x50 by default).
+**/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <linux/i2c.h>
+
+#include "Arduino.h"
+#include "ci2c.h"
+#include "ci2c_linux.h"
+
+#define DEMO_ADDR			0x50	//!< Default memory device address
+
+
+static uint8_t		fake_mem[256];		//!< Fake adapter memory device array
+static uint8_t		fake_ptr;			//!< Fake adapter memory device internal pointer
+
+
+/*!\brief Fake adapter I2C_RDWR: memory device with 8 bits register address at DEMO_ADDR, other addresses not acknowledged
+** \param [in] fd - adapter file descriptor (unused)
+** \param [in, out] msgs - pointer to the first i2c-dev message
+** \param [in] nb - number of messages
+** \return 0 on success, -1 with errno set to ENXIO if address not acknowledged
+**/
+static int fake_rdwr(int fd, struct i2c_msg * msgs, const uint32_t nb)
+{
+	(void) fd;
+
+	for (uint32_t i = 0 ; i < nb ; i++)
+	{
+		const struct i2c_msg * const m = &msgs[i];
+
+		if (m->addr != DEMO_ADDR)	{ errno = ENXIO; return -1; }
+
+		for (uint16_t j = 0 ; j < m->len ; j++)
+		{
+			if (m->flags & I2C_M_RD)	{ m->buf[j] = fake_mem[fake_ptr++]; }
+			else if (j == 0)			{ fake_ptr = m->buf[0]; }
+			else						{ fake_mem[fake_ptr++] = m->buf[j]; }
+		}
+	}
+
+	return 0;
+}
+
+
+// Device driver (same code as on AVR targets)
+static I2C_SLAVE	eeprom;		//!< Memory device
+
+/*!\brief Init memory device driver
+** \param [in] addr - 7 bits device address
+** \return nothing
+**/
+static void eeprom_init(const uint8_t addr) {
+	I2C_slave_init(&eeprom, addr, I2C_8B_REG); }
+
+/*!\brief Write memory device
+** \param [in] addr - memory address
+** \param [in] data - pointer to data to write
+** \param [in] nb - number of bytes
+** \return I2C_STATUS status of write
+**/
+static I2C_STATUS eeprom_write(const uint8_t addr, uint8_t * data, const uint16_t nb) {
+	return I2C_write(&eeprom, addr, data, nb); }
+
+/*!\brief Read memory device
+** \param [in] addr - memory address
+** \param [in, out] data - pointer to data read
+** \param [in] nb - number of bytes
+** \return I2C_STATUS status of read
+**/
+static I2C_STATUS eeprom_read(const uint8_t addr, uint8_t * data, const uint16_t nb) {
+	return I2C_read(&eeprom, addr, data, nb); }
+
+
+/*!\brief Sink counting bytes read
+** \param [in, out] ctx - pointer to the bytes counter
+** \param [in] data - bytes read (unused)
+** \param [in] nb - number of bytes
+** \return true (transfer goes on)
+**/
+static bool count_sink(void * ctx, const uint8_t * data, const uint16_t nb)
+{
+	(void) data;
+	*(uint32_t *) ctx += nb;
+	return true;
+}
+
+/*!\brief Print transaction status & number of I2C_RDWR calls it took
+** \param [in] name - transaction name
+** \param [in] st - transaction status
+** \param [in, out] lx - pointer to the Linux bus structure
+** \return nothing
+**/
+static void report(const char * name, const I2C_STATUS st, I2C_LINUX_BUS * lx)
+{
+	printf("%-24s status %u, %u I2C_RDWR call(s)\n", name, st, lx->calls);
+	lx->calls = 0;
+}
+
+int main(int argc, char * argv[])
+{
+	I2C_LINUX_BUS	lx;
+	uint8_t			wr[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	uint8_t			rd[8];
+	uint8_t			hdr[2], pay[6];
+	uint32_t		cnt = 0;
+	const I2C_SEG	segs[2] = { { hdr, sizeof(hdr) }, { pay, sizeof(pay) } };
+	const bool		fake = (argc < 2);
+
+	if (fake)	{ I2C_linux_init_fd(&lx, -1, fake_rdwr, I2C_FM); }
+	else if (!I2C_linux_init(&lx, (uint8_t) atoi(argv[1]), I2C_FM))
+	{
+		fprintf(stderr, "can't open /dev/i2c-%s\n", argv[1]);
+		return 1;
+	}
+
+	I2C_set_default_bus(I2C_linux_get_bus(&lx));	// Before drivers init
+	eeprom_init((argc > 2) ? (uint8_t) strtol(argv[2], NULL, 0) : DEMO_ADDR);
+	printf("%s adapter\n", fake ? "fake" : "i2c-dev");
+
+	if (fake)	{ report("I2C_write (8 bytes)", eeprom_write(0x10, wr, sizeof(wr)), &lx); }
+
+	report("I2C_read (8 bytes)", eeprom_read(0x10, rd, sizeof(rd)), &lx);
+	for (uint8_t i = 0 ; i < sizeof(rd) ; i++)	{ printf(" %02X", rd[i]); }
+	printf("\n");
+
+	report("I2C_read_next (2 bytes)", I2C_read_next(&eeprom, rd, 2), &lx);
+	report("I2C_readv (2 segments)", I2C_readv(&eeprom, 0x10, segs, 2), &lx);
+	report("I2C_read_sink (96 bytes)", I2C_read_sink(&eeprom, 0x10, 96, count_sink, &cnt), &lx);	// A transaction per chunk on i2c-dev
+
+	I2C_linux_close(&lx);
+	return 0;
+}
@@ -0,0 +1,112 @@
+/*!\file Arduino.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief host side replacement of Arduino core header (AVR registers & timing services backed by TWI simulator)
+**/
+/****************************************************************/
+#ifndef __CI2C_SIM_ARDUINO_H__
+	#define __CI2C_SIM_ARDUINO_H__
+/****************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "twi_sim.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef F_CPU
+#define F_CPU			16000000UL		//!< Simulated CPU frequency
+#endif
+
+// Registers
+#define TWCR			(*twi_sim_twcr())					//!< TWCR access goes through simulator (write detection)
+#define TWSR			(twi_sim_regs[TWI_SIM_TWSR])		//!< TWI status register
+#define TWDR			(twi_sim_regs[TWI_SIM_TWDR])		//!< TWI data register
+#define TWBR			(twi_sim_regs[TWI_SIM_TWBR])		//!< TWI bit rate register
+#define TWAR			(twi_sim_regs[TWI_SIM_TWAR])		//!< TWI (slave) address register
+#define TWAMR			(twi_sim_regs[TWI_SIM_TWAMR])		//!< TWI (slave) address mask register
+#define SREG			(twi_sim_regs[TWI_SIM_SREG])		//!< Status register
+#define PORTC			(twi_sim_regs[TWI_SIM_PORTC])		//!< Port C
+#define PORTD			(twi_sim_regs[TWI_SIM_PORTD])		//!< Port D
+#define PINB			(twi_sim_regs[TWI_SIM_PINB])		//!< Port B input
+#define DDRB			(twi_sim_regs[TWI_SIM_DDRB])		//!< Port B direction
+#define PORTB			(twi_sim_regs[TWI_SIM_PORTB])		//!< Port B output
+
+// Pins (all digital pins 0 to 7 mapped on port B)
+#define NOT_A_PIN					0										//!< Invalid port
+#define digitalPinToPort(p)			(((p) < 8) ? 2 : NOT_A_PIN)				//!< Port of pin \b p
+#define digitalPinToBitMask(p)		((uint8_t) (1 << ((p) & 7)))			//!< Mask of pin \b p in its port
+#define portInputRegister(P)		(&twi_sim_regs[TWI_SIM_PINB])			//!< Input register of port \b P
+#define portModeRegister(P)			(&twi_sim_regs[TWI_SIM_DDRB])			//!< Direction register of port \b P
+#define portOutputRegister(P)		(&twi_sim_regs[TWI_SIM_PORTB])			//!< Output register of port \b P
+
+// TWCR bits
+#define TWINT			7	//!< TWI interrupt flag
+#define TWEA			6	//!< TWI enable acknowledge
+#define TWSTA			5	//!< TWI start condition
+#define TWSTO			4	//!< TWI stop condition
+#define TWWC			3	//!< TWI write collision flag
+#define TWEN			2	//!< TWI enable
+#define TWIE			0	//!< TWI interrupt enable
+
+// TWSR bits
+#define TWPS1			1	//!< TWI prescaler bit 1
+#define TWPS0			0	//!< TWI prescaler bit 0
+
+// TWAR bits
+#define TWGCE			0	//!< TWI general call enable
+
+// Interrupts
+#define ISR(vector)		void vector(void)					//!< Interrupt vectors are plain functions called by simulator
+#define cli()			(SREG &= (uint8_t) ~0x80)			//!< Disable global interrupts
+#define sei()			(SREG |= 0x80)						//!< Enable global interrupts
+
+// Program memory (plain memory on host)
+#define PROGMEM														//!< Program memory attribute
+#define PSTR(s)					(s)									//!< Program memory string
+#define pgm_read_byte(addr)		(*(const uint8_t *) (addr))			//!< Read byte from program memory
+#define pgm_read_word(addr)		(*(const uint16_t *) (addr))		//!< Read word from program memory
+#define pgm_read_dword(addr)	(*(const uint32_t *) (addr))		//!< Read double word from program memory
+#define pgm_read_ptr(addr)		(*(void * const *) (addr))			//!< Read pointer from program memory
+#define memcpy_P				memcpy								//!< Copy from program memory
+
+
+/*!\brief Milliseconds elapsed in simulated time
+** \return elapsed time (ms)
+**/
+unsigned long millis(void);
+
+/*!\brief Microseconds elapsed in simulated time
+** \return elapsed time (us)
+**/
+unsigned long micros(void);
+
+/*!\brief Let simulated time elapse
+** \param [in] ms - number of milliseconds
+** \return nothing
+**/
+void delay(unsigned long ms);
+
+/*!\brief Let simulated time elapse
+** \param [in] us - number of microseconds
+** \return nothing
+**/
+void delayMicroseconds(unsigned int us);
+
+/*!\brief Let simulated time elapse (3 cycles per loop as on AVR), software bus lines are sampled afterwards
+** \param [in] count - number of loops (0 for 256)
+** \return nothing
+**/
+void _delay_loop_1(uint8_t count);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
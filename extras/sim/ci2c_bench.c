@@ -0,0 +1,138 @@
+/*!\file ci2c_bench.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief cI2C throughput & latency benchmark (host side, TWI simulated)
+** \details Sweeps transfer sizes, bus speeds, register address sizes, access patterns and injected NACK rates
+**			on I2C_read / I2C_write, and reports one JSON object per configuration on stdout:
+**			- bytes_s: effective throughput (data bytes of successful transactions per second)
+**			- bus_util: ratio of time bus is clocked over transaction time
+**			- gap_us: mean time per data byte not spent clocking the bus (CPU overhead & inter-byte gap)
+**			- p50_us / p99_us: transaction latency percentiles
+**			- starts: mean (repeated) START conditions per transaction (address phase & retries)
+**			- fails: number of failed transactions
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "ci2c.h"
+
+#define BENCH_MAX_SIZE		4096	//!< Largest transfer size
+#define BENCH_MAX_ITER		100		//!< Maximum number of transactions per configuration
+#define BENCH_BYTES_ITER	16384	//!< Data bytes budget per configuration (limits iterations on large sizes)
+#define BENCH_ADDR			0x50	//!< Virtual memory device address
+
+
+static uint8_t		mem[0x10000];				//!< Virtual memory device array
+static uint8_t		buf[BENCH_MAX_SIZE];		//!< Transfer buffer
+static uint32_t		lat[BENCH_MAX_ITER];		//!< Transactions latency (us)
+
+static const uint16_t		speeds[] = { I2C_STD, I2C_FM };
+static const I2C_INT_SIZE	regs[] = { I2C_NO_REG, I2C_8B_REG, I2C_16B_REG };
+static const char *			regs_name[] = { "none", "8b", "16b" };
+static const uint16_t		nacks[] = { 0, 10, 50 };	// per mille
+static uint8_t				call_cycles = 0;			// CPU cycles charged per function call (instrumented build only)
+
+
+/*!\brief Compare latencies (for qsort)
+**/
+static int cmp_lat(const void * a, const void * b)
+{
+	const uint32_t la = *(const uint32_t *) a, lb = *(const uint32_t *) b;
+	return (la > lb) - (la < lb);
+}
+
+/*!\brief Run one benchmark configuration and print results
+** \param [in] speed - bus speed
+** \param [in] reg - register address size index
+** \param [in] contiguous - contiguous accesses (address phase elided on reads) if true, random addresses otherwise
+** \param [in] nack - injected data NACK rate (per mille)
+** \param [in] rw - 0 = write, 1 = read
+** \param [in] size - transfer size
+** \return nothing
+**/
+static void bench(const uint16_t speed, const uint8_t reg, const bool contiguous, const uint16_t nack, const I2C_RW rw, const uint16_t size)
+{
+	static TWI_SIM_DEV	dev;
+	I2C_SLAVE			slave;
+	const uint32_t		space = (regs[reg] == I2C_16B_REG) ? 0x10000 : 0x100;
+	uint32_t			iter = BENCH_BYTES_ITER / size;
+	uint32_t			fails = 0;
+	uint64_t			t0, bus0, total_us, bus_cycles;
+	uint32_t			starts0;
+	uint16_t			addr = 0;
+
+	if (iter > BENCH_MAX_ITER)	{ iter = BENCH_MAX_ITER; }
+	if (iter < 8)				{ iter = 8; }
+
+	twi_sim_init();
+	twi_sim_cfg.nack_permille = nack;
+	twi_sim_cfg.call_cycles = call_cycles;
+	twi_sim_mem(&dev, BENCH_ADDR, mem, space, (uint8_t) regs[reg], 0, 0);
+	twi_sim_attach(&dev);
+
+	I2C_init(speed);
+	I2C_slave_init(&slave, BENCH_ADDR, regs[reg]);
+	srand(1);
+
+	t0 = twi_sim_us();
+	bus0 = twi_sim_stats.bus_cycles;
+	starts0 = twi_sim_stats.starts;
+
+	for (uint32_t i = 0 ; i < iter ; i++)
+	{
+		const uint64_t	start = twi_sim_us();
+		I2C_STATUS		st;
+
+		if (!contiguous)	{ addr = (uint16_t) (rand() % space); }
+		else				{ addr = I2C_slave_get_reg_addr(&slave); }
+
+		st = (rw == I2C_READ) ? I2C_read(&slave, addr, buf, size) : I2C_write(&slave, addr, buf, size);
+		if (st != I2C_OK)	{ fails++; }
+
+		lat[i] = (uint32_t) (twi_sim_us() - start);
+	}
+
+	total_us = twi_sim_us() - t0;
+	bus_cycles = twi_sim_stats.bus_cycles - bus0;
+	qsort(lat, iter, sizeof(lat[0]), cmp_lat);
+
+	printf("{\"op\":\"%s\",\"speed\":%u,\"reg\":\"%s\",\"access\":\"%s\",\"nack_permille\":%u,\"size\":%u,\"iter\":%u,"
+			"\"bytes_s\":%.0f,\"bus_util\":%.3f,\"gap_us\":%.3f,\"p50_us\":%u,\"p99_us\":%u,\"starts\":%.2f,\"fails\":%u}\n",
+			(rw == I2C_READ) ? "read" : "write", speed, regs_name[reg], contiguous ? "contiguous" : "random", nack, size, iter,
+			(double) size * (iter - fails) * 1e6 / (double) total_us,
+			(double) bus_cycles / ((double) total_us * (F_CPU / 1000000UL)),
+			((double) total_us - (double) bus_cycles / (F_CPU / 1000000UL)) / ((double) size * iter),
+			lat[iter / 2], lat[(iter * 99) / 100],
+			(double) (twi_sim_stats.starts - starts0) / iter, fails);
+}
+
+
+int main(int argc, char * argv[])
+{
+	uint16_t max_size = BENCH_MAX_SIZE;
+
+	if (argc > 1)	{ max_size = (uint16_t) atoi(argv[1]); }	// Optional max transfer size (quick runs)
+	if (argc > 2)	{ call_cycles = (uint8_t) atoi(argv[2]); }	// Optional function call cost (library built with -finstrument-functions)
+
+	for (uint16_t size = 1 ; (size <= max_size) && (size != 0) ; size <<= 1)
+	{
+		for (uint8_t s = 0 ; s < sizeof(speeds) / sizeof(speeds[0]) ; s++)
+		{
+			for (uint8_t r = 0 ; r < sizeof(regs) / sizeof(regs[0]) ; r++)
+			{
+				for (uint8_t n = 0 ; n < sizeof(nacks) / sizeof(nacks[0]) ; n++)
+				{
+					for (uint8_t rw = I2C_WRITE ; rw <= I2C_READ ; rw++)
+					{
+						bench(speeds[s], r, true, nacks[n], (I2C_RW) rw, size);
+						if (regs[r] != I2C_NO_REG)	{ bench(speeds[s], r, false, nacks[n], (I2C_RW) rw, size); }
+					}
+				}
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,102 @@
+/*!\file ci2c_bench_dev.cpp
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief cI2C C API vs compile time specialized devices (ci2c.hpp) benchmark (host side, TWI simulated)
+** \details Same random register accesses (address phase never elided) through I2C_read / I2C_write and ci2c::Device,
+**			one JSON object per configuration on stdout:
+**			- xfer_us: mean transaction time
+**			- cpu_us: mean transaction time not spent clocking the bus (CPU overhead)
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "ci2c.h"
+#include "ci2c.hpp"
+
+#define BENCH_ITER			200		//!< Transactions per configuration
+#define BENCH_ADDR			0x50	//!< Virtual memory device address
+
+
+static uint8_t		mem[0x10000];	//!< Virtual memory device array
+static uint8_t		buf[64];		//!< Transfer buffer
+static I2C_SLAVE	slave;			//!< C API slave
+
+
+/*!\brief Transaction through C API (function pointers dispatch)
+**/
+extern "C" __attribute__((noinline)) I2C_STATUS bench_c(const uint16_t addr, const uint16_t size, const I2C_RW rw) {
+	return (rw == I2C_READ) ? I2C_read(&slave, addr, buf, size) : I2C_write(&slave, addr, buf, size); }
+
+/*!\brief Transaction through compile time specialized device
+**/
+template <I2C_INT_SIZE REG>
+__attribute__((noinline)) I2C_STATUS bench_tpl(const uint16_t addr, const uint16_t size, const I2C_RW rw) {
+	typedef ci2c::Device<BENCH_ADDR, REG> DEV;
+	return (rw == I2C_READ) ? DEV::read(addr, buf, size) : DEV::write(addr, buf, size); }
+
+/*!\brief Run one benchmark configuration and print results
+** \param [in] tpl - true to go through ci2c::Device
+** \param [in] reg - register address size
+** \param [in] rw - 0 = write, 1 = read
+** \param [in] size - transfer size
+** \return nothing
+**/
+static void bench(const bool tpl, const I2C_INT_SIZE reg, const I2C_RW rw, const uint16_t size)
+{
+	static TWI_SIM_DEV	dev;
+	const uint32_t		space = (reg == I2C_16B_REG) ? 0x10000 : 0x100;
+	uint32_t			fails = 0;
+	uint64_t			t0, bus0, total_us;
+
+	twi_sim_init();
+	twi_sim_mem(&dev, BENCH_ADDR, mem, space, (uint8_t) reg, 0, 0);
+	twi_sim_attach(&dev);
+
+	I2C_init(I2C_FM);
+	I2C_slave_init(&slave, BENCH_ADDR, reg);
+	srand(1);
+
+	t0 = twi_sim_us();
+	bus0 = twi_sim_stats.bus_cycles;
+
+	for (uint32_t i = 0 ; i < BENCH_ITER ; i++)
+	{
+		const uint16_t	addr = (uint16_t) (rand() % (space - size));
+		I2C_STATUS		st;
+
+		slave.reg_addr = (uint16_t) -1;	// Same address phase on both paths
+		if (tpl)	{ st = (reg == I2C_16B_REG) ? bench_tpl<I2C_16B_REG>(addr, size, rw) : bench_tpl<I2C_8B_REG>(addr, size, rw); }
+		else		{ st = bench_c(addr, size, rw); }
+		if (st != I2C_OK)	{ fails++; }
+	}
+
+	total_us = twi_sim_us() - t0;
+
+	printf("{\"path\":\"%s\",\"op\":\"%s\",\"reg\":\"%s\",\"size\":%u,\"xfer_us\":%.2f,\"cpu_us\":%.2f,\"fails\":%u}\n",
+			tpl ? "template" : "c", (rw == I2C_READ) ? "read" : "write", (reg == I2C_16B_REG) ? "16b" : "8b", size,
+			(double) total_us / BENCH_ITER,
+			((double) total_us - (double) (twi_sim_stats.bus_cycles - bus0) / (F_CPU / 1000000UL)) / BENCH_ITER, fails);
+}
+
+
+int main(void)
+{
+	static const uint16_t		sizes[] = { 1, 4, 16, 64 };
+	static const I2C_INT_SIZE	regs[] = { I2C_8B_REG, I2C_16B_REG };
+
+	for (uint8_t s = 0 ; s < sizeof(sizes) / sizeof(sizes[0]) ; s++)
+	{
+		for (uint8_t r = 0 ; r < sizeof(regs) / sizeof(regs[0]) ; r++)
+		{
+			for (uint8_t rw = I2C_WRITE ; rw <= I2C_READ ; rw++)
+			{
+				bench(false, regs[r], (I2C_RW) rw, sizes[s]);
+				bench(true, regs[r], (I2C_RW) rw, sizes[s]);
+			}
+		}
+	}
+
+	return 0;
+}
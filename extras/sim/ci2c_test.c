@@ -0,0 +1,1747 @@
+/*!\file ci2c_test.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief cI2C functional tests (host side, TWI simulated)
+** \details Each test runs in its own process (library & simulator state fresh, hung test killed after TEST_TIMEOUT seconds),
+**			checking data & status of transactions against virtual slaves; failed checks are listed with their line.
+**			Exit status is the number of failed tests (test names given as arguments to run only those).
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <linux/i2c.h>
+
+#include "Arduino.h"
+#include "ci2c.h"
+#include "ci2c_queue.h"
+#include "ci2c_cache.h"
+#include "ci2c_stream.h"
+#include "ci2c_sched.h"
+#include "ci2c_smbus.h"
+#include "ci2c_sw.h"
+#include "ci2c_linux.h"
+
+#define TEST_TIMEOUT	10		//!< Seconds before a hung test is killed
+
+#define CHECK(cond)		check((cond), #cond, __LINE__)	//!< Check condition, listed with its line if false
+
+
+static unsigned		fails;		//!< Failed checks of current test
+
+static uint8_t		cb_nb;		//!< Completion callbacks count
+static I2C_STATUS	cb_st;		//!< Last completion callback status
+static uint64_t		cb_us;		//!< Last completion callback time (us)
+
+
+/*!\brief Account a check
+** \param [in] ok - check result
+** \param [in] expr - checked expression
+** \param [in] line - line of check
+** \return nothing
+**/
+static void check(const bool ok, const char * expr, const int line)
+{
+	if (ok)	{ return; }
+	fails++;
+	printf("  line %d: %s\n", line, expr);
+}
+
+/*!\brief Completion callback (count, status & time kept)
+**/
+static void cb(void * obj, const I2C_STATUS st)
+{
+	(void) obj;
+	cb_nb++;
+	cb_st = st;
+	cb_us = twi_sim_us();
+}
+
+/*!\brief Wait for completion callbacks count to reach nb
+**/
+static void async_wait(const uint8_t nb)
+{
+	while (cb_nb < nb)
+	{
+		(void) I2C_async_process();
+		delayMicroseconds(100);
+	}
+}
+
+
+/******************************/
+/*** CUSTOM VIRTUAL SLAVES ***/
+/******************************/
+
+static uint8_t		dev_ctr;		//!< Counter device: next byte read
+
+static bool dev_start(TWI_SIM_DEV * dev, const uint8_t rw)	{ (void) dev; (void) rw; return true; }
+static bool dev_write(TWI_SIM_DEV * dev, const uint8_t val)	{ (void) dev; (void) val; return true; }
+static uint8_t dev_count(TWI_SIM_DEV * dev)					{ (void) dev; return dev_ctr++; }
+
+/*!\brief Set up counter device (each byte read is previous one + 1)
+**/
+static void dev_counter(TWI_SIM_DEV * dev, const uint8_t addr)
+{
+	memset(dev, 0, sizeof(*dev));
+	dev->addr = addr;
+	dev->type = TWI_SIM_CUSTOM;
+	dev->on_start = dev_start;
+	dev->on_write = dev_write;
+	dev->on_read = dev_count;
+}
+
+/* Flaky memory: 8 bits register address, single fault on a given data byte (NACKed when written, clock held when read),
+** register addresses of transactions logged */
+static uint8_t		fl_mem[256];	//!< Flaky memory array
+static uint8_t		fl_ptr;			//!< Flaky memory internal pointer
+static bool			fl_areg;		//!< Next byte written is register address
+static uint16_t		fl_bytes;		//!< Data bytes transferred (all transactions)
+static uint16_t		fl_fault;		//!< Data byte index faulted once (0xFFFF: none)
+static uint8_t		fl_log[16];		//!< Register addresses received
+static uint8_t		fl_nlog;		//!< Number of register addresses received
+
+static bool fl_start(TWI_SIM_DEV * dev, const uint8_t rw)	{ dev->stretch_us = 0; if (!rw) { fl_areg = true; } return true; }
+
+static bool fl_write(TWI_SIM_DEV * dev, const uint8_t val)
+{
+	(void) dev;
+	if (fl_areg)
+	{
+		fl_areg = false;
+		fl_ptr = val;
+		if (fl_nlog < sizeof(fl_log))	{ fl_log[fl_nlog++] = val; }
+		return true;
+	}
+	if (fl_bytes++ == fl_fault)	{ fl_fault = 0xFFFF; return false; }
+	fl_mem[fl_ptr++] = val;
+	return true;
+}
+
+static uint8_t fl_read(TWI_SIM_DEV * dev)
+{
+	if (fl_bytes++ == fl_fault)	{ fl_fault = 0xFFFF; dev->stretch_us = 100000; }	// Transaction deadline missed
+	return fl_mem[fl_ptr++];
+}
+
+/*!\brief Set up flaky memory device (fault: data byte index faulted once, 0xFFFF for none)
+**/
+static void dev_flaky(TWI_SIM_DEV * dev, const uint8_t addr, const uint16_t fault)
+{
+	memset(dev, 0, sizeof(*dev));
+	dev->addr = addr;
+	dev->type = TWI_SIM_CUSTOM;
+	dev->on_start = fl_start;
+	dev->on_write = fl_write;
+	dev->on_read = fl_read;
+	fl_bytes = 0;
+	fl_fault = fault;
+	fl_nlog = 0;
+}
+
+/* Large memories: 8 bits register address, block number in slave address bits (24C16 like when blk_bits = 3 & blk_shift = 0,
+** 16 bits register address when wide, 24LC1025 like with blk_bits = 1 & blk_shift = 2), write page wrap, reads run on across blocks */
+static uint8_t		lm_mem[0x20000];	//!< Large memory array
+static uint32_t		lm_ptr;				//!< Large memory internal pointer
+static uint8_t		lm_acnt;			//!< Address bytes received in current write
+static uint8_t		lm_abytes;			//!< Address bytes of register address
+static uint8_t		lm_shift;			//!< Block number position in slave address
+static uint16_t		lm_page;			//!< Page size
+static uint32_t		lm_addr_bytes;		//!< Address bytes received (address phase count)
+static uint8_t		lm_blk;				//!< Block of current transaction
+
+static bool lm_start(TWI_SIM_DEV * dev, const uint8_t rw)
+{
+	lm_blk = (uint8_t) ((dev->addr & 7) >> lm_shift);
+	if (!rw)	{ lm_acnt = 0; }
+	return true;
+}
+
+static bool lm_write(TWI_SIM_DEV * dev, const uint8_t val)
+{
+	const uint32_t blk_base = (uint32_t) lm_blk << (8 * lm_abytes);
+
+	(void) dev;
+	if (lm_acnt < lm_abytes)
+	{
+		lm_ptr = blk_base | (((lm_acnt ? lm_ptr : 0) << 8 | val) & ((1UL << (8 * lm_abytes)) - 1));
+		lm_acnt++;
+		lm_addr_bytes++;
+		return true;
+	}
+	lm_mem[lm_ptr] = val;
+	lm_ptr = (lm_ptr & ~(uint32_t) (lm_page - 1)) | ((lm_ptr + 1) & (lm_page - 1));
+	return true;
+}
+
+static uint8_t lm_read(TWI_SIM_DEV * dev)
+{
+	const uint32_t	size = 1UL << (8 * lm_abytes + ((lm_shift == 2) ? 1 : 3));
+	const uint8_t	val = lm_mem[lm_ptr];
+
+	(void) dev;
+	lm_ptr = (lm_ptr + 1) & (size - 1);
+	return val;
+}
+
+/*!\brief Set up large memory devices (one per block address)
+**/
+static void lm_devs(TWI_SIM_DEV * devs, const uint8_t nb, const uint8_t abytes, const uint8_t shift, const uint16_t page)
+{
+	lm_abytes = abytes;
+	lm_shift = shift;
+	lm_page = page;
+	for (uint8_t i = 0 ; i < nb ; i++)
+	{
+		memset(&devs[i], 0, sizeof(devs[i]));
+		devs[i].addr = (uint8_t) (0x50 | (i << shift));
+		devs[i].type = TWI_SIM_CUSTOM;
+		devs[i].on_start = lm_start;
+		devs[i].on_write = lm_write;
+		devs[i].on_read = lm_read;
+		twi_sim_attach(&devs[i]);
+	}
+}
+
+#if CI2C_MUX
+/* Muxes 0x70 & 0x71 (8 channels each, selection applied on STOP), same sensor address 0x48 behind every channel:
+** sensor reads return (mux << 4 | channel) + register address, failing unless a single channel is enabled */
+static uint8_t		mx_ctl[2], mx_pend[2], mx_wr[2];
+static int			mx_route;
+static uint8_t		mx_ptr;
+
+static int mx_routed(void)
+{
+	int nb = 0, who = -1;
+
+	for (int m = 0 ; m < 2 ; m++)
+	{
+		for (int c = 0 ; c < 8 ; c++)	{ if (mx_ctl[m] & (1 << c))	{ nb++; who = m * 16 + c; } }
+	}
+	return (nb == 1) ? who : -1;
+}
+
+static bool mx_start(TWI_SIM_DEV * dev, const uint8_t rw)	{ (void) rw; mx_wr[dev->addr - 0x70] = 0; return true; }
+static bool mx_write(TWI_SIM_DEV * dev, const uint8_t val)	{ mx_pend[dev->addr - 0x70] = val; mx_wr[dev->addr - 0x70] = 1; return true; }
+static uint8_t mx_read(TWI_SIM_DEV * dev)					{ return mx_ctl[dev->addr - 0x70]; }
+static void mx_stop(TWI_SIM_DEV * dev)
+{
+	const int m = dev->addr - 0x70;
+
+	if (mx_wr[m])	{ mx_ctl[m] = mx_pend[m]; }
+	mx_wr[m] = 0;
+}
+
+static bool sn_start(TWI_SIM_DEV * dev, const uint8_t rw)	{ (void) dev; (void) rw; mx_route = mx_routed(); return mx_route >= 0; }
+static bool sn_write(TWI_SIM_DEV * dev, const uint8_t val)	{ (void) dev; mx_ptr = val; return true; }
+static uint8_t sn_read(TWI_SIM_DEV * dev)					{ (void) dev; return (uint8_t) (mx_route + mx_ptr++); }
+#endif
+
+/* SMBus device 0x0B: word registers, byte registers 10h-1Fh, block 20h, process call 30h (value + 1), PEC checked on writes,
+** PEC of next reads corrupted while sm_corrupt is set */
+static uint16_t		sm_regs[256];
+static uint8_t		sm_blk[32] = { 1, 2, 3, 4, 5 }, sm_blen = 5;
+static uint8_t		sm_rx[40], sm_rxn, sm_tx[40], sm_txn, sm_txi, sm_crc, sm_rw;
+static uint8_t		sm_corrupt, sm_pec = 1, sm_bad;
+
+static uint8_t sm_crc8(uint8_t crc, const uint8_t dat)
+{
+	crc ^= dat;
+	for (int i = 0 ; i < 8 ; i++)	{ crc = (crc & 0x80) ? (uint8_t) ((crc << 1) ^ 7) : (uint8_t) (crc << 1); }
+	return crc;
+}
+
+static bool sm_start(TWI_SIM_DEV * dev, const uint8_t rw)
+{
+	const uint8_t sla = (uint8_t) ((dev->addr << 1) | rw);
+
+	sm_rw = rw;
+	if (!rw)	{ sm_rxn = 0; return true; }
+
+	sm_crc = sm_crc8(0, (uint8_t) (sla & 0xFE));
+	for (int i = 0 ; i < sm_rxn ; i++)	{ sm_crc = sm_crc8(sm_crc, sm_rx[i]); }
+	sm_crc = sm_crc8(sm_crc, sla);
+
+	sm_txn = sm_txi = 0;
+	if (sm_rx[0] == 0x20)
+	{
+		sm_tx[sm_txn++] = sm_blen;
+		memcpy(&sm_tx[sm_txn], sm_blk, sm_blen);
+		sm_txn += sm_blen;
+	}
+	else if (sm_rx[0] == 0x30)
+	{
+		const uint16_t val = (uint16_t) ((sm_rx[1] | (sm_rx[2] << 8)) + 1);
+		sm_tx[sm_txn++] = (uint8_t) val;
+		sm_tx[sm_txn++] = (uint8_t) (val >> 8);
+	}
+	else
+	{
+		sm_tx[sm_txn++] = (uint8_t) sm_regs[sm_rx[0]];
+		if ((sm_rx[0] & 0xF0) != 0x10)	{ sm_tx[sm_txn++] = (uint8_t) (sm_regs[sm_rx[0]] >> 8); }
+	}
+	for (int i = 0 ; i < sm_txn ; i++)	{ sm_crc = sm_crc8(sm_crc, sm_tx[i]); }
+	sm_tx[sm_txn] = (uint8_t) (sm_crc ^ (sm_corrupt ? 1 : 0));
+	return true;
+}
+
+static bool sm_write(TWI_SIM_DEV * dev, const uint8_t val)	{ (void) dev; sm_rx[sm_rxn++] = val; return true; }
+static uint8_t sm_read(TWI_SIM_DEV * dev)					{ (void) dev; return sm_tx[sm_txi++]; }
+
+static void sm_stop(TWI_SIM_DEV * dev)
+{
+	uint8_t crc = sm_crc8(0, (uint8_t) (dev->addr << 1));
+	int		nb = sm_rxn - sm_pec;
+
+	if ((sm_rw) || (sm_rxn < 2))	{ return; }
+	for (int i = 0 ; i < nb ; i++)	{ crc = sm_crc8(crc, sm_rx[i]); }
+	if ((sm_pec) && (crc != sm_rx[nb]))	{ sm_bad++; return; }
+
+	if (sm_rx[0] == 0x20)	{ sm_blen = sm_rx[1]; memcpy(sm_blk, &sm_rx[2], sm_blen); }
+	else if (nb == 3)		{ sm_regs[sm_rx[0]] = (uint16_t) (sm_rx[1] | (sm_rx[2] << 8)); }
+	else if (nb == 2)		{ sm_regs[sm_rx[0]] = sm_rx[1]; }
+	sm_rxn = 0;
+}
+
+static void sm_dev(TWI_SIM_DEV * dev)
+{
+	memset(dev, 0, sizeof(*dev));
+	dev->addr = 0x0B;
+	dev->type = TWI_SIM_CUSTOM;
+	dev->on_start = sm_start;
+	dev->on_write = sm_write;
+	dev->on_read = sm_read;
+	dev->on_stop = sm_stop;
+}
+
+/* Linux adapter replaced by a 16 bits register address memory (I2C_linux_init_fd), or raw answers to SMBus transactions */
+static uint8_t		lx_mem[0x10000];
+static uint16_t		lx_ptr;
+static uint16_t		lx_maxlen;
+static uint8_t		lx_resp[64];		//!< Raw answer of reads (SMBus) when lx_raw is set
+static uint8_t		lx_last[64];		//!< Last written message (SMBus)
+static uint16_t		lx_last_len;
+static bool			lx_raw;
+
+static int lx_rdwr(int fd, struct i2c_msg * msgs, const uint32_t nb)
+{
+	(void) fd;
+	for (uint32_t i = 0 ; i < nb ; i++)
+	{
+		struct i2c_msg * const m = &msgs[i];
+
+		if (m->len > lx_maxlen)	{ lx_maxlen = m->len; }
+		if (lx_raw)
+		{
+			if (m->flags & I2C_M_RD)	{ memcpy(m->buf, lx_resp, m->len); }
+			else						{ memcpy(lx_last, m->buf, m->len); lx_last_len = m->len; }
+			continue;
+		}
+		for (uint16_t j = 0 ; j < m->len ; j++)
+		{
+			if (m->flags & I2C_M_RD)	{ m->buf[j] = lx_mem[lx_ptr++]; }
+			else if (j < 2)				{ lx_ptr = (uint16_t) (j ? ((lx_ptr << 8) | m->buf[j]) : m->buf[j]); }
+			else						{ lx_mem[lx_ptr++] = m->buf[j]; }
+		}
+	}
+	return (int) nb;
+}
+
+
+/*************/
+/*** TESTS ***/
+/*************/
+
+/*!\brief Blocking transactions, internal pointer & NACK
+**/
+static void test_sync(void)
+{
+	static uint8_t	fram[0x10000];
+	const uint8_t	id[3] = { 0x00, 0xA5, 0x10 };
+	TWI_SIM_DEV		df, dn;
+	I2C_SLAVE		f, n;
+	uint8_t			w[8], r[8] = { 0 };
+	I2C_STATUS		st;
+
+	twi_sim_fram(&df, 0x50, fram, sizeof(fram), id);	twi_sim_attach(&df);
+	twi_sim_nack(&dn, 0x51, 0xFF);						twi_sim_attach(&dn);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&f, 0x50, I2C_16B_REG);
+	I2C_slave_init(&n, 0x51, I2C_8B_REG);
+	for (int i = 0 ; i < 8 ; i++)	{ w[i] = (uint8_t) (i * 7 + 1); }
+
+	st = I2C_write(&f, 0xF000, w, 7);
+	CHECK(st == I2C_OK);
+	CHECK(!memcmp(&fram[0xF000], w, 7));
+	st = I2C_read(&f, 0xF000, r, 3);
+	CHECK(st == I2C_OK);
+	st = I2C_read_next(&f, &r[3], 4);
+	CHECK(st == I2C_OK);
+	CHECK(!memcmp(r, w, 7));
+	CHECK(I2C_slave_get_reg_addr(&f) == 0xF007);
+
+	st = I2C_read(&n, 0, r, 1);
+	CHECK(st == I2C_NACK);
+	CHECK(n.status == I2C_NACK);
+	CHECK(!I2C_is_busy());
+}
+
+/*!\brief Interrupt driven transactions: completion & NACK
+**		   delayed retries & deadline abort (I2C_async_process)
+**/
+static void test_async(void)
+{
+	static uint8_t	mem[256];
+	TWI_SIM_DEV		d, dn;
+	I2C_SLAVE		s, n;
+	uint8_t			w[3] = { 1, 2, 3 }, r[4] = { 0 };
+	uint64_t		t0;
+	I2C_STATUS		st;
+
+	for (int i = 0 ; i < 256 ; i++)	{ mem[i] = (uint8_t) i; }
+	twi_sim_mem(&d, 0x50, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d);
+	twi_sim_nack(&dn, 0x51, 0xFF);						twi_sim_attach(&dn);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x50, I2C_8B_REG);
+	I2C_slave_init(&n, 0x51, I2C_8B_REG);
+
+	st = I2C_read_async(&s, 0x10, r, 4, cb);
+	CHECK(st == I2C_OK);
+	async_wait(1);
+	CHECK((cb_nb == 1) && (cb_st == I2C_OK));
+	CHECK((r[0] == 0x10) && (r[3] == 0x13));
+
+	st = I2C_write_async(&s, 0x80, w, 3, cb);
+	CHECK(st == I2C_OK);
+	async_wait(2);
+	CHECK((cb_nb == 2) && (cb_st == I2C_OK));
+	CHECK(!memcmp(&mem[0x80], w, 3));
+
+	(void) I2C_read_async(&n, 0, r, 1, cb);
+	async_wait(3);
+	CHECK((cb_nb == 3) && (cb_st == I2C_NACK));
+	CHECK(!I2C_is_busy());
+
+	// Retries delayed (not run back-to-back from interrupt), driven by I2C_async_process
+	d.addr_nack = 2;
+	cb_nb = 0;
+	t0 = twi_sim_us();
+	st = I2C_read_async(&s, 0x20, r, 4, cb);
+	CHECK(st == I2C_OK);
+	delay(5);
+	CHECK(cb_nb == 0);
+	while (I2C_async_process())	{ delayMicroseconds(100); }
+	CHECK((cb_nb == 1) && (cb_st == I2C_OK));
+	CHECK(r[0] == 0x20);
+	CHECK(cb_us - t0 >= 2 * 1000);
+
+	// Slave holding clock: aborted on deadline, bus released
+	d.stretch_us = 100000;
+	cb_nb = 0;
+	st = I2C_read_async(&s, 0x30, r, 4, cb);
+	CHECK(st == I2C_OK);
+	t0 = twi_sim_us();
+	while (I2C_async_process())	{ delayMicroseconds(50); }
+	CHECK((cb_nb == 1) && (cb_st == I2C_TIMEOUT));
+	CHECK(s.status == I2C_TIMEOUT);
+	CHECK(cb_us - t0 < 5000);
+	CHECK(!I2C_is_busy());
+
+	d.stretch_us = 0;
+	delay(200);
+	st = I2C_read(&s, 0x30, r, 4);
+	CHECK(st == I2C_OK);
+	CHECK(r[0] == 0x30);
+	CHECK(cb_nb == 1);
+}
+
+static I2C_SLAVE *	q_order[4];		//!< Queue completion order
+static uint8_t		q_nb;
+
+static void q_cb(void * obj, const I2C_STATUS st)
+{
+	(void) st;
+	if (q_nb < 4)	{ q_order[q_nb] = (I2C_SLAVE *) obj; }
+	q_nb++;
+	cb(obj, st);
+}
+
+/*!\brief Transactions queue: priorities, completion & statistics
+**/
+static void test_queue(void)
+{
+	static uint8_t		mem[0x10000];
+	const uint8_t		id[3] = { 0 };
+	TWI_SIM_DEV			d, dn;
+	I2C_SLAVE			f, n;
+	I2C_QUEUE_STATS		qs;
+	uint8_t				a[4] = { 0 }, b[4] = { 0 }, c[4] = { 0 };
+
+	for (int i = 0 ; i < 8 ; i++)	{ mem[0xF000 + i] = (uint8_t) (0x10 + i); }
+	twi_sim_fram(&d, 0x50, mem, sizeof(mem), id);	twi_sim_attach(&d);
+	twi_sim_nack(&dn, 0x51, 0xFF);					twi_sim_attach(&dn);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&f, 0x50, I2C_16B_REG);
+	I2C_slave_init(&n, 0x51, I2C_8B_REG);
+
+	CHECK(I2C_queue_post(&f, 0xF000, a, 4, I2C_READ, CI2C_PRIO_LOW, q_cb) == I2C_OK);	// Launched right away
+	CHECK(I2C_queue_post(&f, 0xF002, b, 4, I2C_READ, CI2C_PRIO_LOW, q_cb) == I2C_OK);
+	CHECK(I2C_queue_post(&n, 0, c, 4, I2C_READ, CI2C_PRIO_URGENT, q_cb) == I2C_OK);
+	while (q_nb < 3)	{ I2C_queue_process(); delay(1); }
+
+	CHECK((q_order[0] == &f) && (q_order[1] == &n) && (q_order[2] == &f));	// Urgent one overtakes
+	CHECK((a[0] == 0x10) && (a[3] == 0x13));
+	CHECK((b[0] == 0x12) && (b[3] == 0x15));
+	CHECK((f.status == I2C_OK) && (n.status == I2C_NACK));
+	I2C_queue_get_stats(&qs);
+	CHECK(qs.posted == 3);
+	CHECK(qs.depth_max == 2);
+	CHECK((qs.wait_max >= 150) && (qs.wait_cumul >= qs.wait_max));	// Queued behind a 4 bytes read (about 180us at 400KHz)
+	CHECK(!I2C_is_busy());
+}
+
+/*!\brief Paged memory: writes split at page boundaries, acknowledge polling during internal write cycles
+**/
+static void test_paged(void)
+{
+	static uint8_t	ee[0x1000];
+	TWI_SIM_DEV		de;
+	I2C_SLAVE		e;
+	uint8_t			w[100], r[100] = { 0 };
+	uint64_t		t0;
+	I2C_STATUS		st;
+
+	twi_sim_mem(&de, 0x54, ee, sizeof(ee), 2, 32, 5000);	twi_sim_attach(&de);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&e, 0x54, I2C_16B_REG);
+	for (int i = 0 ; i < 100 ; i++)	{ w[i] = (uint8_t) (i * 7 + 1); }
+
+	CHECK(!I2C_slave_set_page_size(&e, 24));	// Not a power of 2
+	CHECK(I2C_slave_set_page_size(&e, 32));
+	t0 = twi_sim_us();
+	st = I2C_write(&e, 0x10, w, 100);	// Across 4 pages
+	CHECK(st == I2C_OK);
+	CHECK(twi_sim_us() - t0 >= 3 * 5000);	// Each page written once previous write cycle is over
+	CHECK(!memcmp(&ee[0x10], w, 100));
+
+	st = I2C_read(&e, 0x10, r, 100);	// Polled until last write cycle is over
+	CHECK(st == I2C_OK);
+	CHECK(!memcmp(r, w, 100));
+	CHECK(twi_sim_us() - t0 < 4 * 5000 + 10000);	// No fixed delays on top of write cycles
+}
+
+/*!\brief Registers shadow cache: cached reads, volatile registers, deferred coalesced writes
+**/
+static void test_cache(void)
+{
+	static uint8_t			regs[256];
+	static const uint8_t	cacheable[4] = { 0xDF, 0xFF, 0xFF, 0xFF };	// Register 5 volatile
+	static uint8_t			img[32], valid[4], dirty[4];
+	TWI_SIM_DEV				d;
+	I2C_SLAVE				s;
+	I2C_CACHE				c;
+	uint8_t					b[12];
+	uint32_t				st0;
+
+	for (int i = 0 ; i < 256 ; i++)	{ regs[i] = (uint8_t) i; }
+	twi_sim_mem(&d, 0x68, regs, sizeof(regs), 1, 0, 0);	twi_sim_attach(&d);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x68, I2C_8B_REG);
+	I2C_cache_init(&c, &s, 0, 32, img, cacheable, valid, dirty);
+
+	CHECK(I2C_cache_read(&c, 0, b, 8) == I2C_OK);
+	regs[5] = 55;
+	regs[3] = 33;
+	st0 = twi_sim_stats.starts;
+	CHECK(I2C_cache_read(&c, 0, b, 8) == I2C_OK);
+	CHECK(twi_sim_stats.starts - st0 == 2);		// Volatile register only
+	CHECK((b[5] == 55) && (b[3] == 3));
+	st0 = twi_sim_stats.starts;
+	CHECK(I2C_cache_read(&c, 0, b, 4) == I2C_OK);
+	CHECK(twi_sim_stats.starts == st0);
+
+	for (uint8_t r = 10 ; r < 20 ; r += 2)
+	{
+		uint8_t v = (uint8_t) (100 + r);
+		CHECK(I2C_cache_write(&c, r, &v, 1) == I2C_OK);
+	}
+	CHECK(regs[10] == 10);
+	CHECK(I2C_cache_is_dirty(&c));
+	CHECK(I2C_cache_flush(&c) == I2C_OK);
+	CHECK((regs[10] == 110) && (regs[12] == 112) && (regs[18] == 118));
+	CHECK(!I2C_cache_is_dirty(&c));
+
+	CHECK(I2C_cache_read(&c, 20, b, 12) == I2C_OK);
+	for (uint8_t r = 20 ; r < 30 ; r += 2)
+	{
+		uint8_t v = (uint8_t) (200 + r);
+		(void) I2C_cache_write(&c, r, &v, 1);
+	}
+	st0 = twi_sim_stats.starts;
+	CHECK(I2C_cache_flush(&c) == I2C_OK);
+	CHECK(twi_sim_stats.starts - st0 == 1);		// Gaps filled from valid image
+	CHECK((regs[20] == 220) && (regs[21] == 21) && (regs[28] == 228));
+}
+
+/*!\brief Transaction deadline: clock stretching within allowance, slave holding clock aborted, bus released
+**/
+static void test_deadline(void)
+{
+	static uint8_t	mem[256];
+	TWI_SIM_DEV		d;
+	I2C_SLAVE		s;
+	uint8_t			r[16] = { 0 };
+	uint64_t		t0;
+	I2C_STATUS		st;
+
+	for (int i = 0 ; i < 256 ; i++)	{ mem[i] = (uint8_t) i; }
+	twi_sim_mem(&d, 0x50, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x50, I2C_8B_REG);
+
+	d.stretch_us = 300;
+	CHECK(I2C_set_stretch(500) == 500);
+	st = I2C_read(&s, 0x40, r, 16);
+	CHECK((st == I2C_OK) && (r[0] == 0x40) && (r[15] == 0x4F));
+
+	d.stretch_us = 100000;
+	t0 = twi_sim_us();
+	st = I2C_read(&s, 0x40, r, 16);
+	CHECK((st == I2C_NACK) && (s.status == I2C_NACK));	// Blocking transactions report timeouts as NACK
+	CHECK(twi_sim_us() - t0 < d.stretch_us);	// All attempts bounded by their deadline, not by a single held byte
+	CHECK(!I2C_is_busy());
+
+	d.stretch_us = 0;
+	delay(200);
+	st = I2C_read(&s, 0x80, r, 4);
+	CHECK((st == I2C_OK) && (r[0] == 0x80));
+}
+#if CI2C_STATS
+
+/*!\brief Instrumentation: slave statistics & bus events trace
+**/
+static void test_stats(void)
+{
+	static uint8_t	mem[256];
+	TWI_SIM_DEV		d, dn;
+	I2C_SLAVE		s, n;
+	I2C_SLAVE_STATS	ss;
+	I2C_TRACE_EVT	evt[CI2C_TRACE_SIZE];
+	uint8_t			r[8];
+	uint8_t			nb;
+
+	twi_sim_mem(&d, 0x50, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d);
+	twi_sim_nack(&dn, 0x51, 0xFF);						twi_sim_attach(&dn);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x50, I2C_8B_REG);
+	I2C_slave_init(&n, 0x51, I2C_8B_REG);
+
+	CHECK(I2C_read(&s, 0, r, 8) == I2C_OK);
+	CHECK(I2C_write(&s, 0, r, 4) == I2C_OK);
+	I2C_slave_get_stats(&s, &ss);
+	CHECK((ss.xfers == 2) && (ss.bytes == 12) && (ss.nacks == 0) && (ss.retries == 0));
+	CHECK((ss.time_max != 0) && (ss.time_cumul >= ss.time_max));
+
+	I2C_trace_reset();
+	CHECK(I2C_read(&n, 0, r, 1) == I2C_NACK);
+	I2C_slave_get_stats(&n, &ss);
+	CHECK((ss.xfers == 1) && (ss.bytes == 0) && (ss.nacks != 0) && (ss.retries != 0));
+	I2C_slave_reset_stats(&n);
+	I2C_slave_get_stats(&n, &ss);
+	CHECK((ss.xfers == 0) && (ss.nacks == 0));
+
+	nb = I2C_trace_get(evt, CI2C_TRACE_SIZE);
+	CHECK((nb != 0) && (evt[0].status == 0x08) && (evt[0].time <= evt[nb - 1].time));	// START first
+	CHECK((evt[1].status == 0x20) && (evt[1].addr == 0x51));							// SLA+W not acknowledged
+	I2C_trace_reset();
+	CHECK(I2C_trace_get(evt, CI2C_TRACE_SIZE) == 0);
+}
+#endif
+
+/*!\brief Streaming reads: continuous & triggered streams
+**		   stopped streams left out of launch loop
+**/
+static void test_stream(void)
+{
+	TWI_SIM_DEV		d;
+	I2C_SLAVE		s;
+	I2C_STREAM		a, b, c;
+	uint8_t			buf_a[2 * 8], buf_b[4 * 4], buf_c[2 * 4];
+	uint8_t			expect = 0, bad = 0;
+
+	dev_counter(&d, 0x68);	twi_sim_attach(&d);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x68, I2C_8B_REG);
+
+	CHECK(I2C_stream_init(&a, &s, 0x3B, buf_a, 8, 2, I2C_STREAM_CONTINUOUS, cb));
+	CHECK(!I2C_stream_init(&b, &s, 0, buf_b, 4, 3, I2C_STREAM_TRIGGERED, NULL));	// Slots count not a power of 2
+	I2C_stream_start(&a);
+	for (int k = 0 ; k < 50 ; k++)
+	{
+		uint8_t * p;
+
+		while ((p = I2C_stream_peek(&a)) == NULL)	{ delayMicroseconds(50); }
+		for (int i = 0 ; i < 8 ; i++)	{ if (p[i] != expect++)	{ bad++; } }
+		I2C_stream_release(&a);
+	}
+	CHECK(bad == 0);
+	CHECK(a.chunks >= 50);
+	CHECK(cb_nb >= 50);
+	I2C_stream_stop(&a);
+	delay(2);
+	CHECK(!I2C_is_busy());
+
+	CHECK(I2C_stream_init(&b, &s, 0, buf_b, 4, 4, I2C_STREAM_TRIGGERED, NULL));
+	I2C_stream_start(&b);
+	delay(1);
+	CHECK(I2C_stream_available(&b) == 0);
+	I2C_stream_trigger(&b);
+	I2C_stream_trigger(&b);
+	I2C_stream_trigger(&b);
+	delay(2);
+	CHECK(I2C_stream_available(&b) == 3);
+	for (int i = 0 ; i < 3 ; i++)	{ I2C_stream_trigger(&b); }
+	delay(2);
+	CHECK((I2C_stream_available(&b) == 4) && (b.pending == 2));
+	I2C_stream_release(&b);
+	delay(1);
+	CHECK((I2C_stream_available(&b) == 4) && (b.pending == 1));
+	I2C_stream_stop(&b);
+
+	// Stopped stream released / triggered: launch loop used to spin forever
+	CHECK(I2C_stream_init(&a, &s, 0, buf_a, 8, 2, I2C_STREAM_CONTINUOUS, NULL));
+	CHECK(I2C_stream_init(&b, &s, 0, buf_b, 4, 2, I2C_STREAM_TRIGGERED, NULL));
+	CHECK(I2C_stream_init(&c, &s, 0, buf_c, 4, 2, I2C_STREAM_CONTINUOUS, NULL));
+	I2C_stream_start(&a);
+	I2C_stream_start(&b);
+	delay(2);
+	CHECK((I2C_stream_available(&a) == 2) && (a.stalled));
+	I2C_stream_stop(&a);
+	I2C_stream_release(&a);
+	delay(1);
+	CHECK(I2C_stream_available(&a) == 1);
+	I2C_stream_trigger(&a);
+	delay(1);
+	CHECK(I2C_stream_available(&a) == 1);
+	I2C_stream_trigger(&b);
+	delay(1);
+	CHECK(I2C_stream_available(&b) == 1);
+
+	// Stopped while its chunk is read: other streams go on
+	I2C_stream_release(&a);
+	I2C_stream_start(&a);
+	CHECK(a.reading);
+	I2C_stream_start(&c);
+	I2C_stream_stop(&a);
+	delay(2);
+	CHECK(I2C_stream_available(&c) == 2);
+	CHECK(a.next == NULL);
+}
+
+static uint16_t	hook_reg, hook_nb;	//!< Slave mode hook arguments
+static uint8_t	hook_calls;
+
+static void hook(const uint16_t reg, const uint16_t nb)	{ hook_reg = reg; hook_nb = nb; hook_calls++; }
+
+/*!\brief Interrupt driven slave mode addressed by simulated external master
+**/
+static void test_slave_mode(void)
+{
+	static uint8_t	regs[300];
+	const uint8_t	w[] = { 0x01, 0x2A, 0xAA, 0xBB, 0xCC };
+	const uint8_t	w2[] = { 0x01, 0x2A, 1, 2, 3, 4, 5 };
+	uint8_t			b[4];
+	int				nb;
+
+	for (int i = 0 ; i < 300 ; i++)	{ regs[i] = (uint8_t) i; }
+	I2C_init(I2C_FM);
+	CHECK(I2C_slave_mode_start(0x42, I2C_16B_REG, regs, sizeof(regs), hook));
+
+	nb = twi_sim_ext_write(0x42, w, sizeof(w));
+	CHECK(nb == 4);	// Last byte out of registers map not acknowledged
+	CHECK((regs[0x12A] == 0xAA) && (regs[0x12B] == 0xBB));
+	CHECK((hook_calls == 1) && (hook_reg == 0x12A) && (hook_nb == 2));
+	CHECK(I2C_slave_mode_get_reg_addr() == 300);
+
+	nb = twi_sim_ext_write(0x42, w, 2);
+	CHECK(nb == 2);
+	nb = twi_sim_ext_read(0x42, b, 4);
+	CHECK(nb == 4);
+	CHECK((b[0] == 0xAA) && (b[1] == 0xBB) && (b[2] == 0xFF));	// Padding past registers map
+	CHECK(hook_calls == 1);
+
+	CHECK(twi_sim_ext_read(0x43, b, 1) < 0);
+	nb = twi_sim_ext_write(0x42, w2, sizeof(w2));
+	CHECK(nb == 4);
+	CHECK((hook_reg == 0x12A) && (hook_nb == 2));
+
+	I2C_slave_mode_stop();
+	CHECK(twi_sim_ext_read(0x42, b, 1) < 0);
+}
+
+/*!\brief Bit-banged bus: same transactions as hardware TWI on port lines, hardware TWI left untouched
+**/
+static void test_sw(void)
+{
+	static uint8_t	mem[0x1000];
+	TWI_SIM_DEV		d, dn;
+	I2C_SW_BUS		sw;
+	I2C_SLAVE		s, n;
+	uint8_t			w[40], r[40] = { 0 };
+	uint32_t		st0;
+	I2C_STATUS		st;
+
+	twi_sim_sw_pins(1 << 4, 1 << 5);
+	twi_sim_mem(&d, 0x50, mem, sizeof(mem), 2, 0, 0);	twi_sim_sw_attach(&d);
+	twi_sim_nack(&dn, 0x51, 0xFF);						twi_sim_sw_attach(&dn);
+	I2C_init(I2C_FM);
+	CHECK(I2C_sw_init(&sw, 4, 5, 100));
+	I2C_slave_init(&s, 0x50, I2C_16B_REG);
+	I2C_slave_set_bus(&s, I2C_sw_get_bus(&sw));
+	I2C_slave_init(&n, 0x51, I2C_8B_REG);
+	I2C_slave_set_bus(&n, I2C_sw_get_bus(&sw));
+	for (int i = 0 ; i < 40 ; i++)	{ w[i] = (uint8_t) (i * 3 + 5); }
+
+	st0 = twi_sim_stats.starts;
+	st = I2C_write(&s, 0x123, w, 40);
+	CHECK((st == I2C_OK) && (!memcmp(&mem[0x123], w, 40)));
+	st = I2C_read(&s, 0x123, r, 20);
+	CHECK(st == I2C_OK);
+	st = I2C_read_next(&s, &r[20], 20);
+	CHECK((st == I2C_OK) && (!memcmp(r, w, 40)));
+	CHECK(twi_sim_stats.starts == st0);		// Hardware TWI not used
+
+	st = I2C_read(&n, 0, r, 1);
+	CHECK((st == I2C_NACK) && (n.status == I2C_NACK));
+	CHECK(!I2C_bus_is_busy(I2C_sw_get_bus(&sw)));
+}
+
+/*!\brief Slave speed profiles: hardware TWI clock registers switched between slaves only when speed changes
+**/
+static void test_speed(void)
+{
+	static uint8_t	mem[256];
+	TWI_SIM_DEV		d1, d2;
+	I2C_SLAVE		slow, fast;
+	uint8_t			r[4];
+
+	twi_sim_mem(&d1, 0x50, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d1);
+	twi_sim_mem(&d2, 0x68, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d2);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&slow, 0x50, I2C_8B_REG);
+	I2C_slave_init(&fast, 0x68, I2C_8B_REG);
+
+	CHECK(TWBR == 12);
+	CHECK(I2C_slave_set_speed(&slow, I2C_STD) == I2C_STD);
+	CHECK(I2C_slave_get_speed(&slow) == I2C_STD);
+	CHECK(I2C_slave_set_speed(&fast, 0) == 0);
+
+	CHECK(I2C_read(&slow, 0, r, 4) == I2C_OK);
+	CHECK(TWBR == 72);
+	CHECK(I2C_read(&fast, 0, r, 4) == I2C_OK);
+	CHECK(TWBR == 12);	// Back to bus speed
+	CHECK(I2C_read(&slow, 0, r, 4) == I2C_OK);
+	CHECK(TWBR == 72);
+	CHECK(I2C_read_async(&fast, 0, r, 4, cb) == I2C_OK);
+	async_wait(1);
+	CHECK((cb_st == I2C_OK) && (TWBR == 12));
+}
+
+/*!\brief Bus scan: presence map of acknowledged addresses
+**/
+static void test_scan(void)
+{
+	static uint8_t	mem[256];
+	TWI_SIM_DEV		d1, d2, d3;
+	uint8_t			map[CI2C_SCAN_MAP_SIZE];
+
+	twi_sim_mem(&d1, 0x50, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d1);
+	twi_sim_mem(&d2, 0x68, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d2);
+	twi_sim_nack(&d3, 0x20, 0xFF);						twi_sim_attach(&d3);
+	I2C_init(I2C_FM);
+
+	CHECK(I2C_scan(NULL, map) == I2C_OK);
+	for (uint8_t addr = CI2C_SCAN_FIRST ; addr <= CI2C_SCAN_LAST ; addr++)
+	{
+		if (I2C_scan_present(map, addr) != ((addr == 0x50) || (addr == 0x68)))	{ CHECK(false); }
+	}
+	CHECK(!I2C_is_busy());
+}
+
+#if CI2C_BREAKER
+/*!\brief Circuit breaker: absent slave fails fast, half-open attempts, probe
+**/
+static void test_breaker(void)
+{
+	static uint8_t	mem[256];
+	TWI_SIM_DEV		d1, d3;
+	I2C_SLAVE		a, ghost;
+	uint8_t			buf[4] = { 0 };
+	uint32_t		st0;
+	uint64_t		t0;
+	I2C_STATUS		st;
+
+	twi_sim_mem(&d1, 0x50, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d1);
+	twi_sim_nack(&d3, 0x20, 0xFF);						twi_sim_attach(&d3);
+	I2C_init(I2C_FM);
+
+	I2C_slave_init(&a, 0x50, I2C_8B_REG);
+	I2C_slave_init(&ghost, 0x20, I2C_8B_REG);
+	I2C_slave_set_breaker(&ghost, 3);
+	for (int i = 0 ; i < 3 ; i++)	{ CHECK(I2C_read(&ghost, 0, buf, 1) == I2C_NACK); }
+	CHECK(I2C_slave_is_broken(&ghost));
+
+	st0 = twi_sim_stats.starts;
+	t0 = twi_sim_us();
+	st = I2C_read(&ghost, 0, buf, 1);
+	CHECK((st == I2C_NACK) && (twi_sim_stats.starts == st0) && (twi_sim_us() - t0 < 100));	// No bus traffic
+
+	twi_sim_run((uint64_t) F_CPU / 1000 * (CI2C_BREAKER_PROBE + 1));
+	st0 = twi_sim_stats.starts;
+	st = I2C_read(&ghost, 0, buf, 1);
+	CHECK((st == I2C_NACK) && (twi_sim_stats.starts - st0 == 1) && (I2C_slave_is_broken(&ghost)));	// Single half-open attempt
+	st0 = twi_sim_stats.starts;
+	CHECK(I2C_read(&ghost, 0, buf, 1) == I2C_NACK);
+	CHECK(twi_sim_stats.starts == st0);
+
+	d3.addr_nack = 0;
+	CHECK(I2C_slave_probe(&ghost) == I2C_OK);
+	CHECK(!I2C_slave_is_broken(&ghost));
+
+	d3.addr_nack = 0xFF;
+	for (int i = 0 ; i < 3 ; i++)	{ (void) I2C_read(&ghost, 0, buf, 1); }
+	CHECK(I2C_slave_is_broken(&ghost));
+	CHECK(I2C_read_async(&ghost, 0, buf, 1, NULL) == I2C_NACK);
+	CHECK(I2C_queue_post(&ghost, 0, buf, 1, I2C_READ, 0, cb) == I2C_OK);
+	CHECK(I2C_queue_post(&a, 0, buf, 1, I2C_READ, 0, cb) == I2C_OK);
+	twi_sim_run(F_CPU / 100);
+	CHECK((cb_nb == 2) && (cb_st == I2C_OK) && (!I2C_is_busy()));
+}
+#endif
+
+#if !CI2C_ADAPTIVE || !CI2C_BREAKER || !CI2C_MUX
+/*!\brief Optional slave features not built (library default configuration): setters refuse or ignore, slave works as without them
+**/
+static void test_no_features(void)
+{
+	static uint8_t	mem[256];
+	TWI_SIM_DEV		d, dn;
+	I2C_SLAVE		s, n;
+	I2C_MUX			mx;
+	uint8_t			r[4];
+	uint32_t		st0;
+
+	for (int i = 0 ; i < 256 ; i++)	{ mem[i] = (uint8_t) i; }
+	twi_sim_mem(&d, 0x50, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d);
+	twi_sim_nack(&dn, 0x20, 0xFF);						twi_sim_attach(&dn);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x50, I2C_8B_REG);
+	I2C_slave_init(&n, 0x20, I2C_8B_REG);
+
+#if !CI2C_ADAPTIVE
+	CHECK(I2C_slave_set_speed(&s, I2C_STD) == I2C_STD);
+	CHECK(!I2C_slave_set_adaptive(&s, true));
+	CHECK(I2C_slave_set_adaptive(&s, false));
+	CHECK(I2C_slave_get_speed(&s) == I2C_STD);
+#endif
+#if !CI2C_BREAKER
+	I2C_slave_set_breaker(&n, 1);
+	for (int i = 0 ; i < 3 ; i++)	{ CHECK(I2C_read(&n, 0, r, 1) == I2C_NACK); }
+	CHECK(!I2C_slave_is_broken(&n));
+	st0 = twi_sim_stats.starts;
+	CHECK(I2C_read(&n, 0, r, 1) == I2C_NACK);
+	CHECK(twi_sim_stats.starts != st0);		// Bus still tried
+#endif
+#if !CI2C_MUX
+	CHECK(I2C_mux_init(&mx, NULL, 0x70));
+	CHECK(!I2C_slave_set_mux(&s, &mx, 0));
+	CHECK(I2C_slave_set_mux(&s, NULL, 0));
+	CHECK(I2C_slave_get_mux(&s) == NULL);
+#endif
+	CHECK((I2C_read(&s, 0x10, r, 4) == I2C_OK) && (r[0] == 0x10) && (r[3] == 0x13));
+}
+#endif
+
+/*!\brief Internal pointer tracking: address phase skipped only while pointer is known
+**/
+static void test_reg_track(void)
+{
+	static uint8_t	mem[256];
+	TWI_SIM_DEV		d;
+	I2C_SLAVE		s;
+	uint8_t			r[8];
+	uint32_t		st0;
+
+	for (int i = 0 ; i < 256 ; i++)	{ mem[i] = (uint8_t) i; }
+	twi_sim_mem(&d, 0x50, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&d);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x50, I2C_8B_REG);
+	CHECK(!I2C_slave_reg_addr_known(&s));
+
+	CHECK(I2C_read(&s, 0x20, r, 4) == I2C_OK);
+	CHECK(I2C_slave_reg_addr_known(&s) && (I2C_slave_get_reg_addr(&s) == 0x24));
+	st0 = twi_sim_stats.starts;
+	CHECK((I2C_read(&s, 0x24, r, 4) == I2C_OK) && (r[0] == 0x24));
+	CHECK(twi_sim_stats.starts - st0 == 1);		// Address phase skipped
+
+	I2C_slave_forget_reg_addr(&s);
+	st0 = twi_sim_stats.starts;
+	CHECK((I2C_read_next(&s, r, 4) == I2C_OK) && (r[0] == 0x28));
+	CHECK(twi_sim_stats.starts - st0 == 2);
+
+	I2C_bus_forget_regs(NULL);
+	CHECK(!I2C_slave_reg_addr_known(&s));
+
+	CHECK(I2C_read(&s, 0xFE, r, 2) == I2C_OK);	// Ends at top of register space: pointer rolled over
+	CHECK(!I2C_slave_reg_addr_known(&s));
+
+	d.addr_nack = 0xFF;
+	CHECK(I2C_read(&s, 0x40, r, 4) == I2C_NACK);
+	CHECK((!I2C_slave_reg_addr_known(&s)) && (I2C_slave_get_reg_addr(&s) == 0x40));
+	d.addr_nack = 0;
+	st0 = twi_sim_stats.starts;
+	CHECK((I2C_read_next(&s, r, 4) == I2C_OK) && (r[0] == 0x40));
+	CHECK(twi_sim_stats.starts - st0 == 2);		// Address sent again after failure
+}
+
+/*!\brief Burst data phase: long transfers on hardware TWI & bit-banged bus, data NACK stopping burst
+**/
+static void test_burst(void)
+{
+	static uint8_t	mem[0x1000], mem2[0x1000];
+	TWI_SIM_DEV		d, d2;
+	I2C_SW_BUS		sw;
+	I2C_SLAVE		s, s2;
+	uint8_t			w[300], r[300];
+
+	twi_sim_mem(&d, 0x50, mem, sizeof(mem), 2, 0, 0);	twi_sim_attach(&d);
+	twi_sim_sw_pins(1 << 4, 1 << 5);
+	twi_sim_mem(&d2, 0x50, mem2, sizeof(mem2), 2, 0, 0);	twi_sim_sw_attach(&d2);
+	I2C_init(I2C_FM);
+	(void) I2C_sw_init(&sw, 4, 5, 400);
+	I2C_slave_init(&s, 0x50, I2C_16B_REG);
+	I2C_slave_init(&s2, 0x50, I2C_16B_REG);
+	I2C_slave_set_bus(&s2, I2C_sw_get_bus(&sw));
+	for (int i = 0 ; i < 300 ; i++)	{ w[i] = (uint8_t) (i * 13 + 3); }
+
+	CHECK(I2C_write(&s, 0x100, w, 300) == I2C_OK);
+	CHECK(!memcmp(&mem[0x100], w, 300));
+	memset(r, 0, sizeof(r));
+	CHECK(I2C_read(&s, 0x100, r, 300) == I2C_OK);
+	CHECK(!memcmp(r, w, 300));
+
+	CHECK(I2C_write(&s2, 0x200, w, 300) == I2C_OK);
+	CHECK(!memcmp(&mem2[0x200], w, 300));
+	memset(r, 0, sizeof(r));
+	CHECK(I2C_read(&s2, 0x200, r, 300) == I2C_OK);
+	CHECK(!memcmp(r, w, 300));
+
+	twi_sim_cfg.nack_permille = 1000;	// Every data byte NACKed
+	CHECK(I2C_write(&s, 0x100, w, 300) == I2C_NACK);
+	CHECK(s.status == I2C_NACK);
+	twi_sim_cfg.nack_permille = 0;
+	CHECK(!I2C_is_busy());
+	CHECK(I2C_read(&s, 0x100, r, 4) == I2C_OK);
+}
+
+/*!\brief Vectored transfers: segments gathered in a single transaction, scattered on reads
+**/
+static void test_vectored(void)
+{
+	static uint8_t	mem[0x1000], ee[0x1000];
+	TWI_SIM_DEV		d, e;
+	I2C_SLAVE		s, p;
+	uint8_t			hdr[3] = { 0xA1, 0xA2, 0xA3 }, pay[20], r1[5], r2[18];
+	I2C_SEG			wsegs[3] = { { hdr, sizeof(hdr) }, { NULL, 0 }, { pay, sizeof(pay) } };
+	I2C_SEG			rsegs[2] = { { r1, sizeof(r1) }, { r2, sizeof(r2) } };
+	uint32_t		st0;
+
+	twi_sim_mem(&d, 0x50, mem, sizeof(mem), 2, 0, 0);	twi_sim_attach(&d);
+	twi_sim_mem(&e, 0x51, ee, sizeof(ee), 2, 16, 0);	twi_sim_attach(&e);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x50, I2C_16B_REG);
+	I2C_slave_init(&p, 0x51, I2C_16B_REG);
+	for (int i = 0 ; i < 20 ; i++)	{ pay[i] = (uint8_t) (0x40 + i); }
+
+	st0 = twi_sim_stats.starts;
+	CHECK(I2C_writev(&s, 0x300, wsegs, 3) == I2C_OK);
+	CHECK(twi_sim_stats.starts - st0 == 1);
+	CHECK((!memcmp(&mem[0x300], hdr, 3)) && (!memcmp(&mem[0x303], pay, 20)));
+	CHECK(I2C_slave_get_reg_addr(&s) == 0x300 + 23);
+
+	CHECK(I2C_readv(&s, 0x300, rsegs, 2) == I2C_OK);
+	CHECK((!memcmp(r1, &mem[0x300], 5)) && (!memcmp(r2, &mem[0x305], 18)));
+	CHECK(I2C_writev(&s, 0x300, wsegs, 0) == I2C_NACK);
+
+	// Paged memory: split at page boundaries across segments (4 + 16 + 3 bytes)
+	CHECK(I2C_slave_set_page_size(&p, 16));
+	st0 = twi_sim_stats.starts;
+	CHECK(I2C_writev(&p, 0x30C, wsegs, 3) == I2C_OK);
+	CHECK(twi_sim_stats.starts - st0 >= 3);
+	CHECK((!memcmp(&ee[0x30C], hdr, 3)) && (!memcmp(&ee[0x30F], pay, 20)));
+}
+
+/*!\brief Combined transfers: messages chained with repeated STARTs, single STOP, invalid messages refused
+**/
+static void test_transfer(void)
+{
+	static uint8_t	mem[0x1000];
+	TWI_SIM_DEV		d, dn;
+	uint8_t			addr[2] = { 0x01, 0x20 }, wr[6] = { 0x01, 0x20, 9, 8, 7, 6 }, r[4] = { 0 };
+	const I2C_MSG	wmsg[1] = { { 0x50, 0, 6, wr } };
+	const I2C_MSG	rmsg[2] = { { 0x50, 0, 2, addr }, { 0x50, I2C_MSG_RD, 4, r } };
+	const I2C_MSG	bad[1] = { { 0x50, I2C_MSG_RD, 0, r } };
+	const I2C_MSG	absent[2] = { { 0x51, 0, 2, addr }, { 0x51, I2C_MSG_RD, 4, r } };
+	uint32_t		st0, sp0;
+
+	twi_sim_mem(&d, 0x50, mem, sizeof(mem), 2, 0, 0);	twi_sim_attach(&d);
+	twi_sim_nack(&dn, 0x51, 0xFF);						twi_sim_attach(&dn);
+	I2C_init(I2C_FM);
+
+	CHECK(I2C_transfer(NULL, wmsg, 1) == I2C_OK);
+	CHECK((mem[0x120] == 9) && (mem[0x123] == 6));
+	st0 = twi_sim_stats.starts;
+	sp0 = twi_sim_stats.stops;
+	CHECK(I2C_transfer(NULL, rmsg, 2) == I2C_OK);
+	CHECK((twi_sim_stats.starts - st0 == 2) && (twi_sim_stats.stops - sp0 == 1));
+	CHECK((r[0] == 9) && (r[3] == 6));
+
+	CHECK(I2C_transfer(NULL, bad, 1) == I2C_NACK);
+	CHECK(I2C_transfer(NULL, absent, 2) == I2C_NACK);
+	CHECK(!I2C_is_busy());
+}
+
+/*!\brief Source / sink context: bytes given, calls, call returning false (0: none), bytes given twice or out of order
+**/
+typedef struct {
+	uint32_t	pos;
+	uint16_t	calls;
+	uint16_t	abort_at;
+	uint16_t	errs;
+	uint16_t	base;
+} CK_CTX;
+
+static bool ck_src(void * ctx, uint8_t * buf, const uint16_t nb)
+{
+	CK_CTX * c = (CK_CTX *) ctx;
+
+	if (++c->calls == c->abort_at)	{ return false; }
+	for (uint16_t i = 0 ; i < nb ; i++)	{ buf[i] = (uint8_t) (0x80 + c->pos++); }
+	return true;
+}
+
+static bool ck_sink(void * ctx, const uint8_t * buf, const uint16_t nb)
+{
+	CK_CTX * c = (CK_CTX *) ctx;
+
+	if (++c->calls == c->abort_at)	{ return false; }
+	for (uint16_t i = 0 ; i < nb ; i++)
+	{
+		if (buf[i] != fl_mem[c->base + c->pos++])	{ c->errs++; }
+	}
+	return true;
+}
+
+/*!\brief Source / sink transfers & copies: restart from failed chunk, no data pulled or given twice, aborts, paged writes
+**/
+static void test_chunks(void)
+{
+	static uint8_t	mem[256];
+	TWI_SIM_DEV		d, m;
+	I2C_SLAVE		s, src;
+	CK_CTX			c;
+	uint32_t		st0, sp0;
+	bool			ok;
+
+	for (int i = 0 ; i < 256 ; i++)	{ mem[i] = (uint8_t) (255 - i); }
+	dev_flaky(&d, 0x52, 40);						twi_sim_attach(&d);	// Fault in second chunk
+	twi_sim_mem(&m, 0x50, mem, sizeof(mem), 1, 0, 0);	twi_sim_attach(&m);
+	I2C_init(I2C_FM);
+	I2C_set_retries(1);
+	I2C_slave_init(&s, 0x52, I2C_8B_REG);
+	I2C_slave_init(&src, 0x50, I2C_8B_REG);
+
+	// Write: NACK in second chunk, retried from its first byte, source asked once per chunk
+	memset(&c, 0, sizeof(c));
+	CHECK(I2C_write_src(&s, 0x10, 100, ck_src, &c) == I2C_OK);
+	CHECK((c.calls == 4) && (c.pos == 100));
+	CHECK((fl_nlog == 2) && (fl_log[0] == 0x10) && (fl_log[1] == 0x10 + CI2C_CHUNK_SIZE));
+	ok = true;
+	for (int i = 0 ; i < 100 ; i++)	{ ok &= (fl_mem[0x10 + i] == (uint8_t) (0x80 + i)); }
+	CHECK(ok);
+
+	// Read: clock held in second chunk, retried from its first byte, sink never given a byte twice
+	dev_flaky(&d, 0x52, 40);
+	memset(&c, 0, sizeof(c));
+	c.base = 0x10;
+	CHECK(I2C_read_sink(&s, 0x10, 100, ck_sink, &c) == I2C_OK);
+	CHECK((c.calls == 4) && (c.pos == 100) && (c.errs == 0));
+	CHECK((fl_nlog == 2) && (fl_log[0] == 0x10) && (fl_log[1] == 0x10 + CI2C_CHUNK_SIZE));
+
+	// Callback refusing a chunk: NACK & STOP, no retries
+	dev_flaky(&d, 0x52, 0xFFFF);
+	memset(&c, 0, sizeof(c));
+	c.abort_at = 2;
+	st0 = twi_sim_stats.starts;
+	sp0 = twi_sim_stats.stops;
+	CHECK(I2C_write_src(&s, 0x10, 100, ck_src, &c) == I2C_NACK);
+	CHECK((c.calls == 2) && (twi_sim_stats.starts - st0 == 1) && (twi_sim_stats.stops - sp0 == 1));
+	memset(&c, 0, sizeof(c));
+	c.abort_at = 2;
+	c.base = 0x10;
+	st0 = twi_sim_stats.starts;
+	sp0 = twi_sim_stats.stops;
+	CHECK(I2C_read_sink(&s, 0x10, 100, ck_sink, &c) == I2C_NACK);
+	CHECK((c.calls == 2) && (twi_sim_stats.starts - st0 == 2) && (twi_sim_stats.stops - sp0 == 1));
+	CHECK(!I2C_is_busy());
+	CHECK(I2C_write_src(&s, 0x10, 0, ck_src, &c) == I2C_NACK);
+
+	// Paged write: a transaction per chunk within a page, failed chunk retried from chunk buffer
+	CHECK(I2C_slave_set_page_size(&s, 64));
+	dev_flaky(&d, 0x52, 40);
+	memset(&c, 0, sizeof(c));
+	CHECK(I2C_write_src(&s, 0x10, 100, ck_src, &c) == I2C_OK);
+	CHECK((c.calls == 4) && (c.pos == 100));
+	CHECK((fl_nlog == 5) && (fl_log[0] == 0x10) && (fl_log[1] == 0x30) && (fl_log[2] == 0x30) && (fl_log[3] == 0x40) && (fl_log[4] == 0x60));
+	ok = true;
+	for (int i = 0 ; i < 100 ; i++)	{ ok &= (fl_mem[0x10 + i] == (uint8_t) (0x80 + i)); }
+	CHECK(ok);
+
+	// Copy to paged memory: chunks cut at page boundaries, NACKed chunk retried
+	dev_flaky(&d, 0x52, 40);
+	CHECK(I2C_copy(&s, 0x10, &src, 0x20, 100) == I2C_OK);
+	CHECK((fl_nlog == 5) && (fl_log[1] == 0x30) && (fl_log[2] == 0x30) && (fl_log[4] == 0x60));
+	ok = true;
+	for (int i = 0 ; i < 100 ; i++)	{ ok &= (fl_mem[0x10 + i] == mem[0x20 + i]); }
+	CHECK(ok);
+	CHECK(I2C_copy(&s, 0x10, &src, 0x20, 0) == I2C_NACK);
+	CHECK(!I2C_is_busy());
+}
+
+static uint16_t	job_cbs;	//!< Scheduler job successful callbacks
+
+static void job_cb(void * job, const I2C_STATUS st)	{ (void) job; if (st == I2C_OK)	{ job_cbs++; } }
+
+/*!\brief Periodic polling scheduler: admission control, periods met, skipped releases
+**/
+static void test_sched(void)
+{
+	static uint8_t	ee[4096], regs[256];
+	TWI_SIM_DEV		d, e;
+	I2C_SLAVE		imu, eep;
+	I2C_JOB			ji, je, jx, jz;
+	uint8_t			bi[12], be[64], bx[200];
+	uint32_t		t0;
+	bool			rm1, rm2;
+
+	twi_sim_mem(&d, 0x68, regs, sizeof(regs), 1, 0, 0);	twi_sim_attach(&d);
+	twi_sim_mem(&e, 0x50, ee, sizeof(ee), 2, 0, 0);			twi_sim_attach(&e);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&imu, 0x68, I2C_8B_REG);
+	I2C_slave_init(&eep, 0x50, I2C_16B_REG);
+	regs[0x3B] = 0x5A;
+
+	CHECK(I2C_sched_add(&ji, &imu, 0x3B, bi, 12, 2000, job_cb) == I2C_OK);
+	CHECK(I2C_sched_add(&je, &eep, 0, be, 16, 100000, NULL) == I2C_OK);
+	CHECK(I2C_sched_add(&jx, &eep, 0, bx, 200, 100000, NULL) == I2C_BUSY);	// Refused: bus load too high
+	CHECK(I2C_sched_add(&jz, &eep, 0, bx, 0, 1000, NULL) == I2C_NACK);
+	CHECK(I2C_sched_load() == 461);
+
+	t0 = micros();
+	while (micros() - t0 < 1000000UL)
+	{
+		const uint32_t next = (I2C_sched_process(), I2C_sched_next());
+		delayMicroseconds((next > 50) ? 50 : (next ? next : 1));
+	}
+	CHECK((ji.stats.runs >= 499) && (ji.stats.fails == 0) && (ji.stats.misses == 0));
+	CHECK((je.stats.runs >= 10) && (je.stats.misses == 0));
+	CHECK(job_cbs == ji.stats.runs);
+	CHECK(bi[0] == 0x5A);
+
+	delay(5);	// Stall: releases skipped, not run back-to-back
+	(void) I2C_sched_process();
+	CHECK((ji.stats.skips >= 1) && (ji.stats.misses >= 1));
+
+	rm1 = I2C_sched_remove(&je);
+	rm2 = I2C_sched_remove(&je);
+	CHECK(rm1 && !rm2);
+}
+
+/*!\brief SMBus protocols & PEC on hardware TWI & bit-banged bus
+**		   message level (Linux) bus
+**/
+static void test_smbus(void)
+{
+	TWI_SIM_DEV		d, d2;
+	I2C_SLAVE		s, absent;
+	I2C_SW_BUS		sw;
+	I2C_LINUX_BUS	lx;
+	const uint8_t	t[3] = { 0x16, 0x09, 0x00 };
+	uint8_t			wb[7] = { 9, 8, 7, 6, 5, 4, 3 }, bl[32], by = 0, n;
+	uint16_t		w = 0, r = 0;
+	I2C_STATUS		st;
+
+	sm_dev(&d);	twi_sim_attach(&d);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x0B, I2C_8B_REG);
+	I2C_smbus_set_pec(&s, true);
+	CHECK(I2C_smbus_pec(0, t, 3) == 0x62);
+
+	CHECK(I2C_smbus_write_word(&s, 0x09, 0x3A98) == I2C_OK);
+	st = I2C_smbus_read_word(&s, 0x09, &w);
+	CHECK((st == I2C_OK) && (w == 0x3A98));
+	CHECK(I2C_smbus_write_byte(&s, 0x11, 0x5C) == I2C_OK);
+	st = I2C_smbus_read_byte(&s, 0x11, &by);
+	CHECK((st == I2C_OK) && (by == 0x5C));
+	CHECK(sm_bad == 0);
+	st = I2C_smbus_process_call(&s, 0x30, 0x1233, &r);
+	CHECK((st == I2C_OK) && (r == 0x1234));
+
+	n = sizeof(bl);
+	st = I2C_smbus_block_read(&s, 0x20, bl, &n);
+	CHECK((st == I2C_OK) && (n == 5) && (bl[0] == 1) && (bl[4] == 5));
+	CHECK(I2C_smbus_block_write(&s, 0x20, wb, 7) == I2C_OK);
+	n = sizeof(bl);
+	st = I2C_smbus_block_read(&s, 0x20, bl, &n);
+	CHECK((st == I2C_OK) && (n == 7) && (!memcmp(bl, wb, 7)));
+	n = 4;
+	st = I2C_smbus_block_read(&s, 0x20, bl, &n);
+	CHECK((st == I2C_NACK) && (n == 0));	// Block larger than buffer
+	CHECK(I2C_smbus_block_write(&s, 0x20, wb, 0) == I2C_NACK);
+	CHECK(I2C_smbus_block_write(&s, 0x20, wb, CI2C_SMBUS_BLOCK_MAX + 1) == I2C_NACK);
+
+	sm_corrupt = 1;
+	w = 0;
+	st = I2C_smbus_read_word(&s, 0x09, &w);
+	CHECK((st == I2C_PEC_ERR) && (s.status == I2C_PEC_ERR) && (w == 0));
+	sm_corrupt = 0;
+
+	I2C_smbus_set_pec(&s, false);
+	sm_pec = 0;
+	CHECK(I2C_smbus_write_word(&s, 0x09, 0x1111) == I2C_OK);
+	st = I2C_smbus_read_word(&s, 0x09, &w);
+	CHECK((st == I2C_OK) && (w == 0x1111));
+
+	// Bit-banged bus
+	twi_sim_sw_pins(1 << 4, 1 << 5);
+	d2 = d;
+	twi_sim_sw_attach(&d2);
+	I2C_sw_init(&sw, 4, 5, 100);
+	I2C_slave_set_bus(&s, I2C_sw_get_bus(&sw));
+	I2C_smbus_set_pec(&s, true);
+	sm_pec = 1;
+	CHECK(I2C_smbus_write_word(&s, 0x0A, 0xBEEF) == I2C_OK);
+	st = I2C_smbus_read_word(&s, 0x0A, &w);
+	CHECK((st == I2C_OK) && (w == 0xBEEF));
+	sm_corrupt = 1;
+	st = I2C_smbus_read_word(&s, 0x0A, &w);
+	CHECK(st == I2C_PEC_ERR);
+	sm_corrupt = 0;
+
+	// Message level bus: PEC computed beforehand, checked once read
+	lx_raw = true;
+	I2C_linux_init_fd(&lx, -1, lx_rdwr, 100);
+	I2C_slave_set_bus(&s, I2C_linux_get_bus(&lx));
+	CHECK(I2C_smbus_write_word(&s, 0x21, 0x1234) == I2C_OK);
+	{
+		const uint8_t ref[4] = { 0x16, 0x21, 0x34, 0x12 };
+		CHECK((lx_last_len == 4) && (!memcmp(lx_last, &ref[1], 3)) && (lx_last[3] == I2C_smbus_pec(0, ref, 4)));
+	}
+	{
+		const uint8_t hdr[3] = { 0x16, 0x09, 0x17 };
+		lx_resp[0] = 0xCD;
+		lx_resp[1] = 0xAB;
+		lx_resp[2] = I2C_smbus_pec(I2C_smbus_pec(0, hdr, 3), lx_resp, 2);
+	}
+	st = I2C_smbus_read_word(&s, 0x09, &w);
+	CHECK((st == I2C_OK) && (w == 0xABCD));
+	lx_resp[2] ^= 1;
+	st = I2C_smbus_read_word(&s, 0x09, &w);
+	CHECK(st == I2C_PEC_ERR);
+	{
+		const uint8_t hdr[3] = { 0x16, 0x20, 0x17 };
+		memset(lx_resp, 0xFF, sizeof(lx_resp));
+		lx_resp[0] = 3;
+		lx_resp[1] = 'a';
+		lx_resp[2] = 'b';
+		lx_resp[3] = 'c';
+		lx_resp[4] = I2C_smbus_pec(I2C_smbus_pec(0, hdr, 3), lx_resp, 4);
+	}
+	n = sizeof(bl);
+	st = I2C_smbus_block_read(&s, 0x20, bl, &n);
+	CHECK((st == I2C_OK) && (n == 3) && (!memcmp(bl, "abc", 3)));
+	lx_resp[4] ^= 1;
+	n = sizeof(bl);
+	st = I2C_smbus_block_read(&s, 0x20, bl, &n);
+	CHECK((st == I2C_PEC_ERR) && (n == 0));
+
+	I2C_slave_init(&absent, 0x33, I2C_8B_REG);
+	CHECK(I2C_smbus_read_word(&absent, 0, &w) == I2C_NACK);
+}
+
+#if CI2C_MUX
+/*!\brief Bus multiplexers: channel selection cached, batched reads grouped by channel, interrupt driven transactions
+**/
+static void test_mux(void)
+{
+	TWI_SIM_DEV		m0, m1, sd;
+	I2C_MUX			mx[2];
+	I2C_SLAVE		s[16];
+	I2C_REQ			rq[32];
+	uint8_t			b[16][2];
+	uint32_t		w0;
+	bool			ok = true;
+	uint8_t			nb;
+
+	memset(&m0, 0, sizeof(m0));
+	m0.addr = 0x70;
+	m0.type = TWI_SIM_CUSTOM;
+	m0.on_start = mx_start;
+	m0.on_write = mx_write;
+	m0.on_read = mx_read;
+	m0.on_stop = mx_stop;
+	m1 = m0;
+	m1.addr = 0x71;
+	memset(&sd, 0, sizeof(sd));
+	sd.addr = 0x48;
+	sd.type = TWI_SIM_CUSTOM;
+	sd.on_start = sn_start;
+	sd.on_write = sn_write;
+	sd.on_read = sn_read;
+	twi_sim_attach(&m0);
+	twi_sim_attach(&m1);
+	twi_sim_attach(&sd);
+	I2C_init(I2C_FM);
+
+	CHECK(I2C_mux_init(&mx[0], NULL, 0x70));
+	CHECK(!I2C_mux_init(&mx[1], NULL, 0x80));
+	CHECK(I2C_mux_init(&mx[1], NULL, 0x71));
+	for (int i = 0 ; i < 16 ; i++)
+	{
+		I2C_slave_init(&s[i], 0x48, I2C_8B_REG);
+		CHECK(I2C_slave_set_mux(&s[i], &mx[i / 8], (uint8_t) (i % 8)));
+	}
+	CHECK(!I2C_slave_set_mux(&s[0], &mx[0], 8));
+
+	for (int i = 0 ; i < 16 ; i++)
+	{
+		ok &= (I2C_read(&s[i], 0, b[i], 2) == I2C_OK) && (b[i][0] == (i / 8) * 16 + i % 8);
+	}
+	CHECK(ok);
+	w0 = mx[1].writes;
+	(void) I2C_read(&s[15], 0, b[15], 2);
+	(void) I2C_read(&s[15], 0, b[15], 2);
+	CHECK(mx[1].writes == w0);	// Channel already selected
+
+	for (int k = 0 ; k < 32 ; k++)
+	{
+		const int i = (k * 7) % 16;
+		rq[k].slave = &s[i];
+		rq[k].reg_addr = 0;
+		rq[k].data = b[i];
+		rq[k].bytes = 2;
+	}
+	w0 = mx[0].writes + mx[1].writes;
+	nb = I2C_read_batch(rq, 32);
+	CHECK(nb == 0);
+	ok = true;
+	for (int k = 0 ; k < 32 ; k++)
+	{
+		const int i = (int) (rq[k].slave - s);
+		ok &= (rq[k].status == I2C_OK) && (b[i][0] == (i / 8) * 16 + i % 8);
+	}
+	CHECK(ok);
+	CHECK(mx[0].writes + mx[1].writes - w0 == 17);	// One write per channel, previous mux disabled once
+	CHECK(rq[0].slave == &s[15]);					// Current channel first
+
+	I2C_bus_forget_regs(NULL);
+	w0 = mx[0].writes + mx[1].writes;
+	CHECK(I2C_read(&s[3], 0, b[3], 2) == I2C_OK);
+	CHECK((mx[0].writes + mx[1].writes - w0 == 2) && (b[3][0] == 0x03));
+
+	w0 = mx[0].writes + mx[1].writes;
+	CHECK(I2C_read_async(&s[12], 0, b[12], 2, cb) == I2C_OK);
+	async_wait(1);
+	CHECK((cb_st == I2C_OK) && (b[12][0] == 0x14) && (mx_routed() == 0x14));
+	CHECK(mx[0].writes + mx[1].writes - w0 == 2);
+
+	m0.addr = 0x30;	// Mux absent
+	CHECK(I2C_read(&s[2], 0, b[2], 2) == I2C_NACK);
+	m0.addr = 0x70;
+	CHECK(I2C_read(&s[2], 0, b[2], 2) == I2C_OK);
+	CHECK(b[2][0] == 0x02);
+
+	I2C_slave_set_bus(&s[0], NULL);
+	CHECK(I2C_slave_get_mux(&s[0]) != NULL);	// Same bus: still behind mux
+}
+#endif
+
+/*!\brief Large memories: blocks in slave address (16 bits 24LC1025
+**		   & 8 bits 24C16
+**		   register addresses), pointer tracked across blocks
+**/
+static void test_large_mem(void)
+{
+	static uint8_t	w[70000], r[70000];
+	TWI_SIM_DEV		devs[8];
+	I2C_SLAVE		s;
+	I2C_STATUS		st;
+
+	for (uint32_t i = 0 ; i < sizeof(w) ; i++)	{ w[i] = (uint8_t) (i * 31 + 7); }
+
+	// 24LC1025: 128KB, block bit at slave address bit 2, 128 bytes pages
+	lm_devs(devs, 2, 2, 2, 128);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x50, I2C_16B_REG);
+	(void) I2C_slave_set_page_size(&s, 128);
+	CHECK(!I2C_slave_set_blocks(&s, 3, 5));
+	CHECK(I2C_slave_set_blocks(&s, 1, 2));
+	CHECK(I2C_slave_get_mem_size(&s) == 0x20000);
+
+	st = I2C_write_mem(&s, 0xFF00, w, 3000);
+	CHECK(st == I2C_OK);
+	CHECK(!memcmp(&lm_mem[0xFF00], w, 3000));
+
+	lm_addr_bytes = 0;
+	st = I2C_read_mem(&s, 0xFF00, r, 256);
+	CHECK((st == I2C_OK) && (lm_addr_bytes == 2));	// Read on across block boundary
+	CHECK((I2C_slave_get_mem_addr(&s) == 0x10000) && (I2C_slave_reg_addr_known(&s)));
+	st = I2C_read_mem_next(&s, &r[256], 3000 - 256);
+	CHECK((st == I2C_OK) && (lm_addr_bytes == 2) && (!memcmp(r, w, 3000)));
+
+	CHECK(I2C_read_mem(&s, 0x1FFFF, r, 2) == I2C_NACK);
+	CHECK(I2C_read_mem(&s, 0x20000, r, 1) == I2C_NACK);
+
+	st = I2C_write_mem(&s, 0x8000, w, 70000);
+	CHECK(st == I2C_OK);
+	memset(r, 0, sizeof(r));
+	lm_addr_bytes = 0;
+	st = I2C_read_mem(&s, 0x8000, r, 70000);
+	CHECK((st == I2C_OK) && (!memcmp(r, w, 70000)) && (lm_addr_bytes == 2));
+	CHECK(I2C_slave_get_addr(&s) == 0x50);
+
+	// 24C16: 2KB, 8 blocks at 50h-57h, 8 bits register address, 16 bytes pages
+	twi_sim_init();
+	memset(lm_mem, 0, sizeof(lm_mem));
+	lm_devs(devs, 8, 1, 0, 16);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&s, 0x50, I2C_8B_REG);
+	(void) I2C_slave_set_page_size(&s, 16);
+	CHECK(I2C_slave_set_blocks(&s, 3, 0));
+
+	st = I2C_write_mem(&s, 0, w, 2048);
+	CHECK((st == I2C_OK) && (!memcmp(lm_mem, w, 2048)));
+	CHECK(I2C_slave_get_addr(&s) == 0x50);	// Base address left unchanged
+	lm_addr_bytes = 0;
+	st = I2C_read_mem(&s, 0x1F0, r, 16);
+	CHECK((st == I2C_OK) && (lm_addr_bytes == 1) && (!memcmp(r, &w[0x1F0], 16)));
+	CHECK((I2C_slave_get_mem_addr(&s) == 0x200) && (I2C_slave_reg_addr_known(&s)));
+	lm_addr_bytes = 0;
+	st = I2C_read_mem_next(&s, r, 32);
+	CHECK((st == I2C_OK) && (lm_addr_bytes == 0) && (!memcmp(r, &w[0x200], 32)));
+	lm_addr_bytes = 0;
+	st = I2C_read_mem(&s, 0x310, r, 8);
+	CHECK(st == I2C_OK);
+	st = I2C_read_mem(&s, 0x318, &r[8], 8);
+	CHECK((st == I2C_OK) && (lm_addr_bytes == 1) && (!memcmp(r, &w[0x310], 16)));
+
+	devs[5].addr_nack = 0xFF;
+	st = I2C_read_mem(&s, 0x500, r, 4);
+	CHECK((st == I2C_NACK) && (I2C_slave_get_addr(&s) == 0x50) && (I2C_slave_get_xfer_addr(&s) == 0x55));
+	devs[5].addr_nack = 0;
+	st = I2C_read_mem(&s, 0x7FC, r, 4);
+	CHECK((st == I2C_OK) && (!memcmp(r, &w[0x7FC], 4)));
+	CHECK((I2C_slave_get_mem_addr(&s) == 0) && (!I2C_slave_reg_addr_known(&s)));	// Wrapped to block 0
+}
+
+static const I2C_SLAVE_DESC ee_desc PROGMEM = { 0x50, I2C_16B_REG, 32, NULL, NULL, 0, NULL, NULL };	//!< Paged EEPROM on default bus
+static const I2C_SLAVE_DESC bad_desc PROGMEM = { 0x51, I2C_8B_REG, 0, NULL, NULL, 0, NULL, NULL };	//!< Absent slave on default bus
+
+/*!\brief Constant slaves: same transactions & internal pointer tracking as I2C_SLAVE
+**		   default bus honored
+**/
+static void test_cslave(void)
+{
+	static uint8_t	mem[4096];
+	TWI_SIM_DEV		e;
+	I2C_SLAVE		ee;
+	I2C_CSLAVE		ce, cb;
+	I2C_LINUX_BUS	lx;
+	uint8_t			w[100], r1[100], r2[100];
+	uint32_t		st0;
+	I2C_STATUS		st;
+
+	twi_sim_mem(&e, 0x50, mem, sizeof(mem), 2, 32, 3000);	twi_sim_attach(&e);
+	I2C_init(I2C_FM);
+	I2C_slave_init(&ee, 0x50, I2C_16B_REG);
+	(void) I2C_slave_set_page_size(&ee, 32);
+	I2C_cslave_init(&ce, &ee_desc);
+	I2C_cslave_init(&cb, &bad_desc);
+	for (int i = 0 ; i < 100 ; i++)	{ w[i] = (uint8_t) (i * 7 + 1); }
+
+	st = I2C_cslave_write(&ce, 0x10, w, 100);	// Paged
+	CHECK((st == I2C_OK) && (!memcmp(&mem[0x10], w, 100)));
+	st = I2C_read(&ee, 0x10, r1, 100);
+	CHECK((st == I2C_OK) && (!memcmp(r1, w, 100)));
+	st = I2C_cslave_read(&ce, 0x10, r2, 50);
+	CHECK(st == I2C_OK);
+	st0 = twi_sim_stats.starts;
+	st = I2C_cslave_read_next(&ce, &r2[50], 50);
+	CHECK((st == I2C_OK) && (twi_sim_stats.starts - st0 == 1));	// Address phase skipped
+	CHECK(!memcmp(r2, w, 100));
+	CHECK(I2C_cslave_get_reg_addr(&ce) == 0x10 + 100);
+
+	st = I2C_cslave_read(&cb, 0, r2, 1);
+	CHECK((st == I2C_NACK) && (cb.status == I2C_NACK));
+
+	I2C_bus_forget_regs(NULL);
+	st0 = twi_sim_stats.starts;
+	st = I2C_cslave_read_next(&ce, r2, 4);
+	CHECK((st == I2C_OK) && (twi_sim_stats.starts - st0 == 2) && (!memcmp(r2, &mem[0x10 + 100], 4)));	// Address sent again
+
+	// Descriptor without bus: default bus used, as for I2C_slave_init
+	lx_raw = false;
+	I2C_linux_init_fd(&lx, -1, lx_rdwr, 400);
+	I2C_set_default_bus(I2C_linux_get_bus(&lx));
+	I2C_cslave_init(&ce, &ee_desc);
+	st = I2C_cslave_write(&ce, 0x20, w, 4);
+	CHECK((st == I2C_OK) && (lx.calls != 0) && (!memcmp(&lx_mem[0x20], w, 4)));	// Paged write: ack polling may add calls
+	st0 = lx.calls;
+	st = I2C_cslave_read(&ce, 0x20, r2, 4);
+	CHECK((st == I2C_OK) && (lx.calls - st0 == 1) && (!memcmp(r2, w, 4)));
+	I2C_set_default_bus(NULL);
+}
+
+/*!\brief Linux i2c-dev backend (fake adapter): single I2C_RDWR call per transaction, vectored transfers (bounded segments count),
+**		   writes larger than bounce buffer
+**/
+static void test_linux(void)
+{
+	static uint8_t	w[600], r[600];
+	I2C_LINUX_BUS	lx;
+	I2C_SLAVE		s;
+	uint8_t			h[2] = { 0xA1, 0xA2 };
+	I2C_SEG			segs[2] = { { h, sizeof(h) }, { w, 100 } };
+	I2C_SEG			many[CI2C_XFER_SEGS + 2];
+	I2C_STATUS		st;
+
+	lx_raw = false;
+	I2C_linux_init_fd(&lx, -1, lx_rdwr, 400);
+	I2C_slave_init(&s, 0x50, I2C_16B_REG);
+	I2C_slave_set_bus(&s, I2C_linux_get_bus(&lx));
+	for (int i = 0 ; i < 600 ; i++)	{ w[i] = (uint8_t) (i * 7 + 1); }
+
+	st = I2C_write(&s, 0x10, w, 200);
+	CHECK((st == I2C_OK) && (lx.calls == 1) && (!memcmp(&lx_mem[0x10], w, 200)));
+	st = I2C_read(&s, 0x10, r, 200);
+	CHECK((st == I2C_OK) && (lx.calls == 2) && (!memcmp(r, w, 200)));
+
+	st = I2C_writev(&s, 0x1000, segs, 2);
+	CHECK((st == I2C_OK) && (lx_mem[0x1000] == 0xA1) && (!memcmp(&lx_mem[0x1002], w, 100)));
+
+	for (int i = 0 ; i < CI2C_XFER_SEGS + 2 ; i++)	{ many[i] = (I2C_SEG) { &r[i], 1 }; }
+	many[0].len = 0;	// Empty segment not counted
+	lx.calls = 0;
+	st = I2C_readv(&s, 0x10, many, CI2C_XFER_SEGS + 1);
+	CHECK((st == I2C_OK) && (lx.calls == 1) && (r[1] == w[0]) && (r[CI2C_XFER_SEGS] == w[CI2C_XFER_SEGS - 1]));
+	st = I2C_readv(&s, 0x10, many, CI2C_XFER_SEGS + 2);
+	CHECK((st == I2C_NACK) && (lx.calls == 1));	// Too many segments: refused without adapter call
+
+	lx.calls = 0;
+	st = I2C_write(&s, 0x10, w, 600);	// Register address & data merged past bounce buffer size
+	CHECK((st == I2C_OK) && (lx.calls == 1) && (lx_maxlen == 602));
+	CHECK(!memcmp(&lx_mem[0x10], w, 600));
+	st = I2C_read(&s, 0x10, r, 600);
+	CHECK((st == I2C_OK) && (!memcmp(r, w, 600)));
+}
+
+
+/*!\struct StructTest
+** \brief Test entry
+**/
+typedef struct StructTest {
+	const char *	name;		//!< Test name
+	void			(*fct) (void);	//!< Test function
+} TEST;
+
+static const TEST tests[] = {
+	{ "sync", test_sync },
+	{ "async", test_async },
+	{ "queue", test_queue },
+	{ "paged", test_paged },
+	{ "cache", test_cache },
+	{ "deadline", test_deadline },
+#if CI2C_STATS
+	{ "stats", test_stats },
+#endif
+	{ "stream", test_stream },
+	{ "slave_mode", test_slave_mode },
+	{ "sw", test_sw },
+	{ "speed", test_speed },
+	{ "scan", test_scan },
+#if CI2C_BREAKER
+	{ "breaker", test_breaker },
+#endif
+	{ "reg_track", test_reg_track },
+	{ "burst", test_burst },
+	{ "vectored", test_vectored },
+	{ "transfer", test_transfer },
+	{ "chunks", test_chunks },
+	{ "sched", test_sched },
+	{ "smbus", test_smbus },
+#if CI2C_MUX
+	{ "mux", test_mux },
+#endif
+#if !CI2C_ADAPTIVE || !CI2C_BREAKER || !CI2C_MUX
+	{ "no_features", test_no_features },
+#endif
+	{ "large_mem", test_large_mem },
+	{ "cslave", test_cslave },
+	{ "linux", test_linux },
+};
+
+
+/*!\brief Run a test in a child process
+** \param [in] test - pointer to the test entry
+** \return true if test passed
+**/
+static bool run(const TEST * test)
+{
+	int		wst;
+	pid_t	pid;
+
+	fflush(stdout);
+	if ((pid = fork()) == 0)
+	{
+		alarm(TEST_TIMEOUT);
+		twi_sim_init();
+		test->fct();
+		fflush(stdout);
+		_exit(fails ? 1 : 0);
+	}
+
+	if ((pid < 0) || (waitpid(pid, &wst, 0) != pid))	{ wst = -1; }
+	if ((wst != -1) && WIFSIGNALED(wst))	{ printf("  killed by signal %d%s\n", WTERMSIG(wst), (WTERMSIG(wst) == SIGALRM) ? " (timeout)" : ""); }
+
+	const bool ok = (wst != -1) && WIFEXITED(wst) && (WEXITSTATUS(wst) == 0);
+	printf("%-12s %s\n", test->name, ok ? "ok" : "FAILED");
+	return ok;
+}
+
+int main(int argc, char * argv[])
+{
+	int failed = 0;
+
+	for (size_t i = 0 ; i < sizeof(tests) / sizeof(tests[0]) ; i++)
+	{
+		bool sel = (argc < 2);
+
+		for (int a = 1 ; a < argc ; a++)	{ if (!strcmp(argv[a], tests[i].name))	{ sel = true; } }
+		if ((sel) && (!run(&tests[i])))		{ failed++; }
+	}
+
+	return failed;
+}
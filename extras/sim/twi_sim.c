@@ -0,0 +1,866 @@
+/*!\file twi_sim.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief host side AVR TWI peripheral simulator
+** \details Simulates TWCR/TWSR/TWDR/TWBR registers, bus timing (from TWBR/prescaler and F_CPU),
+**			CPU time spent polling registers and scriptable virtual slaves, so cI2C sources run unmodified on a host.
+**			Writes to TWCR are detected thanks to a reserved TWCR bit (always read as 0 on target) set by the simulator
+**			after each access: any value written by code differs from the marked value, and is then processed on next access.
+**/
+
+#include "Arduino.h"
+
+#define TWCR_REG				twi_sim_regs[TWI_SIM_TWCR]	//!< TWCR backing store (direct access)
+#define TWCR_MARK				0x02						//!< Reserved TWCR bit used to detect writes
+
+#define START					0x08
+#define REPEATED_START			0x10
+#define MT_SLA_ACK				0x18
+#define MT_SLA_NACK				0x20
+#define MT_DATA_ACK				0x28
+#define MT_DATA_NACK			0x30
+#define MR_SLA_ACK				0x40
+#define MR_SLA_NACK				0x48
+#define MR_DATA_ACK				0x50
+#define MR_DATA_NACK			0x58
+#define LOST_ARBTRTN			0x38
+#define SR_SLA_ACK				0x60
+#define SR_DATA_ACK				0x80
+#define SR_DATA_NACK			0x88
+#define SR_STOP					0xA0
+#define ST_SLA_ACK				0xA8
+#define ST_DATA_ACK				0xB8
+#define ST_DATA_NACK			0xC0
+#define NO_INFO					0xF8
+
+/*!\enum enSIM_BUS
+** \brief Simulated master state on bus
+**/
+typedef enum enSIM_BUS {
+	SIM_IDLE = 0,	//!< Bus not owned
+	SIM_START,		//!< (Repeated) START sent, waiting for address
+	SIM_MT,			//!< Master transmitter
+	SIM_MR,			//!< Master receiver
+	SIM_WAIT		//!< Bus owned, address NACKed (waiting for STOP or repeated START)
+} SIM_BUS;
+
+
+volatile uint8_t	twi_sim_regs[TWI_SIM_NB_REGS];
+uint64_t			twi_sim_cycles;
+TWI_SIM_CFG			twi_sim_cfg;
+TWI_SIM_STATS		twi_sim_stats;
+
+extern void TWI_vect(void) __attribute__((weak));	//!< TWI interrupt vector (if defined by code under simulation)
+
+/*!\struct sim
+** \brief static simulator state
+**/
+static struct {
+	TWI_SIM_DEV *		devs;		//!< Attached devices list
+	TWI_SIM_DEV *		cur;		//!< Currently addressed device
+	TWI_SIM_DEV *		id_dev;		//!< Device targeted by Device ID command
+	bool				id_cmd;		//!< Device ID command in progress
+	uint8_t				id_idx;		//!< Device ID byte index
+	SIM_BUS				state;		//!< Master state on bus
+	uint8_t				cr;			//!< Last marked TWCR value
+	bool				pending;	//!< Operation in progress
+	uint64_t			done_at;	//!< Operation completion time (cycles)
+	uint8_t				status;		//!< Operation resulting status
+	bool				rx;			//!< Operation received a byte
+	uint8_t				rx_dat;		//!< Received byte
+	bool				sto;		//!< STOP in progress
+	uint64_t			sto_at;		//!< STOP completion time (cycles)
+	bool				irq;		//!< TWINT set and not serviced yet
+	bool				in_isr;		//!< TWI interrupt vector running
+	uint32_t			rng;		//!< Pseudo random generator state
+} sim;
+
+
+/*!\enum enSIM_SW
+** \brief Software bus decoder phase (devices side)
+**/
+typedef enum enSIM_SW {
+	SIM_SW_IDLE = 0,	//!< No START seen
+	SIM_SW_RX,			//!< Receiving a byte (address or data)
+	SIM_SW_ACK,			//!< Acknowledge clock of a received byte
+	SIM_SW_TX,			//!< Transmitting a byte
+	SIM_SW_TX_ACK,		//!< Acknowledge clock of a transmitted byte
+	SIM_SW_WAIT			//!< Not addressed (waiting for STOP or repeated START)
+} SIM_SW;
+
+/*!\struct sw
+** \brief static software bus decoder state
+**/
+static struct {
+	TWI_SIM_DEV *		devs;		//!< Attached devices list
+	TWI_SIM_DEV *		cur;		//!< Currently addressed device
+	uint8_t				sda_mask;	//!< SDA pin mask in port B
+	uint8_t				scl_mask;	//!< SCL pin mask in port B
+	SIM_SW				phase;		//!< Decoder phase
+	bool				addr;		//!< Byte being received is an address byte
+	bool				rd;			//!< Addressed device is read
+	bool				ack;		//!< Acknowledge of current byte
+	uint8_t				cnt;		//!< Bits count in current byte
+	uint8_t				shift;		//!< Current byte
+	bool				drive;		//!< Device pulls SDA low
+	bool				sda;		//!< SDA level at last sample
+	bool				scl;		//!< SCL level at last sample
+	uint64_t			hold_until;	//!< Device holds SCL low until (cycles, clock stretching)
+} sw;
+
+
+/*!\brief Pseudo random fault draw
+** \param [in] permille - fault probability (per mille)
+** \return true if fault has to be injected
+**/
+static bool sim_fault(const uint16_t permille)
+{
+	if (permille == 0)	{ return false; }
+
+	sim.rng ^= sim.rng << 13;
+	sim.rng ^= sim.rng >> 17;
+	sim.rng ^= sim.rng << 5;
+
+	return ((sim.rng % 1000) < permille);
+}
+
+/*!\brief SCL period from TWBR & prescaler
+** \return SCL period (cycles)
+**/
+static uint32_t sim_bit(void)
+{
+	static const uint8_t prescaler[4] = { 1, 4, 16, 64 };
+
+	return 16 + (2 * (uint32_t) twi_sim_regs[TWI_SIM_TWBR] * prescaler[twi_sim_regs[TWI_SIM_TWSR] & 0x03]);
+}
+
+/*!\brief Convert microseconds to cycles
+** \param [in] us - duration (us)
+** \return duration (cycles)
+**/
+static inline uint64_t sim_us2cycles(const uint64_t us) {
+	return us * (F_CPU / 1000000UL); }
+
+
+/*!\brief Find attached device
+** \param [in] addr - 7 bits slave address
+** \return pointer to device (NULL if none)
+**/
+static TWI_SIM_DEV * sim_find(const uint8_t addr)
+{
+	for (TWI_SIM_DEV * dev = sim.devs ; dev ; dev = dev->next)
+	{
+		if (dev->addr == addr)	{ return dev; }
+	}
+	return NULL;
+}
+
+/*!\brief Device address phase
+** \param [in, out] dev - pointer to device
+** \param [in] rw - 0 = write, 1 = read
+** \return true if address acknowledged
+**/
+static bool sim_dev_start(TWI_SIM_DEV * dev, const uint8_t rw)
+{
+	if (dev == NULL)						{ return false; }
+	if (dev->addr_nack != 0)
+	{
+		if (dev->addr_nack != 0xFF)			{ dev->addr_nack--; }
+		return false;
+	}
+	if (dev->busy_until > twi_sim_cycles)	{ return false; }	// Internal write cycle in progress
+
+	if (rw == 0)	{ dev->addr_cnt = 0; }
+
+	if (dev->type == TWI_SIM_CUSTOM)	{ return dev->on_start ? dev->on_start(dev, rw) : true; }
+	return true;
+}
+
+/*!\brief Device byte written by master
+** \param [in, out] dev - pointer to device
+** \param [in] dat - byte written
+** \return true if byte acknowledged
+**/
+static bool sim_dev_write(TWI_SIM_DEV * dev, const uint8_t dat)
+{
+	if (dev->type == TWI_SIM_CUSTOM)	{ return dev->on_write ? dev->on_write(dev, dat) : true; }
+	if ((dev->type != TWI_SIM_MEM) || (dev->size == 0))	{ return true; }
+
+	if (dev->addr_cnt < dev->reg_size)
+	{
+		dev->ptr = (dev->addr_cnt == 0) ? dat : ((dev->ptr << 8) | dat);
+		dev->ptr %= dev->size;
+		dev->addr_cnt++;
+		return true;
+	}
+
+	dev->mem[dev->ptr] = dat;
+	dev->wr_cnt++;
+
+	if (dev->page_size)	{ dev->ptr = (dev->ptr - (dev->ptr % dev->page_size)) + ((dev->ptr + 1) % dev->page_size); }
+	else				{ dev->ptr = (dev->ptr + 1) % dev->size; }
+
+	return true;
+}
+
+/*!\brief Device byte read by master
+** \param [in, out] dev - pointer to device
+** \return byte read
+**/
+static uint8_t sim_dev_read(TWI_SIM_DEV * dev)
+{
+	uint8_t dat;
+
+	if (dev->type == TWI_SIM_CUSTOM)	{ return dev->on_read ? dev->on_read(dev) : 0xFF; }
+	if ((dev->type != TWI_SIM_MEM) || (dev->size == 0))	{ return 0xFF; }
+
+	dat = dev->mem[dev->ptr];
+	dev->ptr = (dev->ptr + 1) % dev->size;
+
+	return dat;
+}
+
+/*!\brief Device STOP condition
+** \param [in, out] dev - pointer to device
+** \return nothing
+**/
+static void sim_dev_stop(TWI_SIM_DEV * dev)
+{
+	if (dev->type == TWI_SIM_CUSTOM)	{ if (dev->on_stop) { dev->on_stop(dev); } }
+	else if ((dev->wr_cnt != 0) && (dev->write_us != 0))	{ dev->busy_until = twi_sim_cycles + sim_us2cycles(dev->write_us); }
+
+	dev->wr_cnt = 0;
+}
+
+
+/*!\brief Release bus (STOP condition sent or module disabled)
+** \return nothing
+**/
+static void sim_release(void)
+{
+	if (sim.cur)	{ sim_dev_stop(sim.cur); }
+	sim.cur = NULL;
+	sim.id_cmd = false;
+	sim.state = SIM_IDLE;
+}
+
+/*!\brief Schedule operation completion
+** \param [in] status - resulting status
+** \param [in] duration - bus duration (cycles)
+** \return nothing
+**/
+static void sim_schedule(const uint8_t status, const uint64_t duration)
+{
+	const uint64_t from = sim.sto ? sim.sto_at : twi_sim_cycles;	// Wait for STOP completion if any
+
+	sim.pending = true;
+	sim.status = status;
+	sim.done_at = from + duration;
+	twi_sim_stats.bus_cycles += duration;
+}
+
+/*!\brief Address phase
+** \param [in] sla - slave address & rw bit
+** \return nothing
+**/
+static void sim_address(const uint8_t sla)
+{
+	const uint8_t	rw = sla & 0x01;
+	const uint8_t	addr = sla >> 1;
+	uint64_t		duration = 9 * (uint64_t) sim_bit();
+	bool			ack;
+
+	twi_sim_stats.bytes++;
+
+	if (sim_fault(twi_sim_cfg.arb_permille))
+	{
+		twi_sim_stats.arb_lost++;
+		sim.cur = NULL;
+		sim.state = SIM_IDLE;
+		sim_schedule(LOST_ARBTRTN, duration);
+		return;
+	}
+
+	if (addr == TWI_SIM_ID_ADDR)
+	{
+		if (rw == 0)	{ sim.id_dev = NULL; }
+		ack = (rw == 0) || ((sim.id_dev != NULL) && sim.id_cmd);
+		sim.id_cmd = true;
+		sim.id_idx = 0;
+		sim.cur = NULL;
+	}
+	else
+	{
+		TWI_SIM_DEV * dev = sim_find(addr);
+
+		if (sim.cur && (sim.cur != dev))	{ sim_dev_stop(sim.cur); }
+		sim.id_cmd = false;
+		ack = sim_dev_start(dev, rw);
+		sim.cur = ack ? dev : NULL;
+		if (sim.cur)	{ duration += sim_us2cycles(dev->stretch_us); }
+	}
+
+	if (!ack)	{ twi_sim_stats.nacks++; }
+	sim.state = ack ? (rw ? SIM_MR : SIM_MT) : SIM_WAIT;
+	sim_schedule(rw ? (ack ? MR_SLA_ACK : MR_SLA_NACK) : (ack ? MT_SLA_ACK : MT_SLA_NACK), duration);
+}
+
+/*!\brief Master transmitter data phase
+** \param [in] dat - byte to send
+** \return nothing
+**/
+static void sim_transmit(const uint8_t dat)
+{
+	uint64_t	duration = 9 * (uint64_t) sim_bit();
+	bool		ack;
+
+	twi_sim_stats.bytes++;
+
+	if (sim.id_cmd)
+	{
+		sim.id_dev = sim_find(dat >> 1);
+		if ((sim.id_dev != NULL) && !sim.id_dev->has_id)	{ sim.id_dev = NULL; }
+		ack = (sim.id_dev != NULL);
+	}
+	else
+	{
+		ack = sim_dev_write(sim.cur, dat) && !sim_fault(twi_sim_cfg.nack_permille);
+		duration += sim_us2cycles(sim.cur->stretch_us);
+	}
+
+	if (!ack)	{ twi_sim_stats.nacks++; }
+	sim_schedule(ack ? MT_DATA_ACK : MT_DATA_NACK, duration);
+}
+
+/*!\brief Master receiver data phase
+** \param [in] ack - master acknowledges byte
+** \return nothing
+**/
+static void sim_receive(const bool ack)
+{
+	uint64_t	duration = 9 * (uint64_t) sim_bit();
+
+	twi_sim_stats.bytes++;
+
+	if (sim.id_cmd)
+	{
+		sim.rx_dat = (sim.id_dev && (sim.id_idx < sizeof(sim.id_dev->id))) ? sim.id_dev->id[sim.id_idx++] : 0xFF;
+	}
+	else
+	{
+		sim.rx_dat = sim_dev_read(sim.cur);
+		duration += sim_us2cycles(sim.cur->stretch_us);
+	}
+
+	sim.rx = true;
+	sim_schedule(ack ? MR_DATA_ACK : MR_DATA_NACK, duration);
+}
+
+/*!\brief Process a value written to TWCR
+** \param [in] cr - value written
+** \return nothing
+**/
+static void sim_write(const uint8_t cr)
+{
+	if (!(cr & (1 << TWEN)))	// Module disabled: bus released, pending operations aborted
+	{
+		sim_release();
+		sim.pending = sim.sto = sim.irq = false;
+		TWCR_REG = cr & (uint8_t) ~(1 << TWINT);
+		twi_sim_regs[TWI_SIM_TWSR] = (twi_sim_regs[TWI_SIM_TWSR] & 0x03) | NO_INFO;
+		return;
+	}
+
+	if (!(cr & (1 << TWINT)))	{ return; }		// Control bits only (TWINT not cleared, no action)
+
+	TWCR_REG = cr & (uint8_t) ~(1 << TWINT);
+	sim.irq = false;
+
+	if (cr & (1 << TWSTO))
+	{
+		if (sim.state != SIM_IDLE)
+		{
+			sim_release();
+			twi_sim_stats.stops++;
+			sim.sto = true;
+			sim.sto_at = twi_sim_cycles + sim_bit();
+			twi_sim_stats.bus_cycles += sim_bit();
+		}
+		else	{ TWCR_REG &= (uint8_t) ~(1 << TWSTO); }
+	}
+
+	if (cr & (1 << TWSTA))
+	{
+		twi_sim_stats.starts++;
+		sim_schedule((sim.state == SIM_IDLE) ? START : REPEATED_START, sim_bit());
+		sim.state = SIM_START;
+	}
+	else if (sim.state == SIM_START)	{ sim_address(twi_sim_regs[TWI_SIM_TWDR]); }
+	else if (sim.state == SIM_MT)		{ sim_transmit(twi_sim_regs[TWI_SIM_TWDR]); }
+	else if (sim.state == SIM_MR)		{ sim_receive((cr & (1 << TWEA)) != 0); }
+}
+
+/*!\brief Mark TWCR (to detect next write)
+** \return nothing
+**/
+static inline void sim_mark(void)
+{
+	TWCR_REG |= TWCR_MARK;
+	sim.cr = TWCR_REG;
+}
+
+/*!\brief Process due bus events & TWI interrupt
+** \return nothing
+**/
+static void sim_events(void)
+{
+	if (sim.sto && (twi_sim_cycles >= sim.sto_at))
+	{
+		sim.sto = false;
+		TWCR_REG &= (uint8_t) ~(1 << TWSTO);
+	}
+
+	if (sim.pending && (twi_sim_cycles >= sim.done_at))
+	{
+		sim.pending = false;
+		twi_sim_regs[TWI_SIM_TWSR] = (twi_sim_regs[TWI_SIM_TWSR] & 0x03) | sim.status;
+		if (sim.rx)		{ twi_sim_regs[TWI_SIM_TWDR] = sim.rx_dat; sim.rx = false; }
+		TWCR_REG |= (1 << TWINT);
+		sim.irq = true;
+	}
+
+	sim_mark();
+
+	while (sim.irq && (TWCR_REG & (1 << TWIE)) && (twi_sim_regs[TWI_SIM_SREG] & 0x80) && !sim.in_isr && TWI_vect)	// Flag set again during vector: taken right after it (as on AVR)
+	{
+		sim.irq = false;
+		sim.in_isr = true;
+		twi_sim_stats.isr++;
+		twi_sim_regs[TWI_SIM_SREG] &= 0x7F;
+		TWI_vect();
+		twi_sim_regs[TWI_SIM_SREG] |= 0x80;
+		sim.in_isr = false;
+	}
+}
+
+/*!\brief Process TWCR write (if any) and due events
+** \return nothing
+**/
+static void sim_sync(void)
+{
+	do	// TWI interrupt vector may have written TWCR
+	{
+		if (TWCR_REG != sim.cr)	{ sim_write(TWCR_REG & (uint8_t) ~TWCR_MARK); }
+		sim_events();
+	} while (TWCR_REG != sim.cr);
+}
+
+
+/*!\brief Slave mode event (external master on bus): TWINT set with status, bus held until TWINT is cleared
+** \param [in] status - slave status
+** \return true if TWINT was cleared (false if slave mode is not serviced)
+**/
+static bool sim_slave_event(const uint8_t status)
+{
+	uint64_t held = twi_sim_cycles;
+
+	twi_sim_regs[TWI_SIM_TWSR] = (twi_sim_regs[TWI_SIM_TWSR] & 0x03) | status;
+	TWCR_REG |= (1 << TWINT);
+	sim.irq = true;
+	sim_mark();
+	sim_sync();
+
+	held = twi_sim_cycles - held;
+	if (held > twi_sim_stats.slave_hold_max)	{ twi_sim_stats.slave_hold_max = held; }
+	twi_sim_cycles += 9 * (uint64_t) sim_bit();
+	twi_sim_stats.bus_cycles += held + (9 * (uint64_t) sim_bit());
+	twi_sim_stats.bytes++;
+
+	return !(TWCR_REG & (1 << TWINT));
+}
+
+/*!\brief Test if simulated TWI acknowledges address in slave mode
+** \param [in] addr - 7 bits slave address
+** \return true if addressed
+**/
+static bool sim_slave_addressed(const uint8_t addr)
+{
+	sim_sync();
+	twi_sim_stats.starts++;
+
+	if ((sim.state == SIM_IDLE) && ((TWCR_REG & ((1 << TWEN) | (1 << TWEA))) == ((1 << TWEN) | (1 << TWEA)))
+		&& ((twi_sim_regs[TWI_SIM_TWAR] >> 1) == addr))	{ return true; }
+
+	twi_sim_stats.bytes++;
+	twi_sim_stats.stops++;
+	twi_sim_cycles += 9 * (uint64_t) sim_bit();
+	return false;
+}
+
+
+/*!\brief Software bus device byte received (address or data)
+** \return true if acknowledged
+**/
+static bool sim_sw_byte(void)
+{
+	bool ack;
+
+	twi_sim_stats.sw_bytes++;
+
+	if (sw.addr)
+	{
+		TWI_SIM_DEV * dev = NULL;
+
+		for (TWI_SIM_DEV * d = sw.devs ; d ; d = d->next)	{ if (d->addr == (sw.shift >> 1)) { dev = d; break; } }
+
+		if (sw.cur && (sw.cur != dev))	{ sim_dev_stop(sw.cur); }
+		sw.addr = false;
+		sw.rd = (sw.shift & 0x01) != 0;
+		ack = sim_dev_start(dev, sw.shift & 0x01);
+		sw.cur = ack ? dev : NULL;
+	}
+	else	{ ack = sim_dev_write(sw.cur, sw.shift); }
+
+	if (!ack)	{ twi_sim_stats.sw_nacks++; }
+	return ack;
+}
+
+/*!\brief Software bus device loads next byte to transmit
+** \return nothing
+**/
+static void sim_sw_load(void)
+{
+	twi_sim_stats.sw_bytes++;
+	sw.shift = sim_dev_read(sw.cur);
+	sw.cnt = 0;
+	sw.drive = !(sw.shift & 0x80);
+	sw.phase = SIM_SW_TX;
+}
+
+/*!\brief Software bus SCL falling edge (devices change SDA)
+** \return nothing
+**/
+static void sim_sw_falling(void)
+{
+	switch (sw.phase)
+	{
+		case SIM_SW_RX:
+			if (sw.cnt == 8)	{ sw.drive = sw.ack; sw.phase = SIM_SW_ACK; }
+			break;
+
+		case SIM_SW_ACK:
+			sw.drive = false;
+			if (!sw.ack)	{ sw.phase = SIM_SW_WAIT; break; }
+			if (sw.cur->stretch_us)	{ sw.hold_until = twi_sim_cycles + sim_us2cycles(sw.cur->stretch_us); }
+			if (sw.rd)		{ sim_sw_load(); }
+			else			{ sw.cnt = 0; sw.phase = SIM_SW_RX; }
+			break;
+
+		case SIM_SW_TX:
+			if (++sw.cnt < 8)	{ sw.drive = !(sw.shift & (0x80 >> sw.cnt)); }
+			else				{ sw.drive = false; sw.phase = SIM_SW_TX_ACK; }
+			break;
+
+		case SIM_SW_TX_ACK:
+			if (sw.ack)		{ sim_sw_load(); }
+			else			{ sw.phase = SIM_SW_WAIT; }
+			break;
+
+		default:
+			break;
+	}
+}
+
+/*!\brief Software bus SCL rising edge (devices sample SDA)
+** \param [in] sda - SDA level
+** \return nothing
+**/
+static void sim_sw_rising(const bool sda)
+{
+	if ((sw.phase == SIM_SW_RX) && (sw.cnt < 8))
+	{
+		sw.shift = (uint8_t) ((sw.shift << 1) | sda);
+		if (++sw.cnt == 8)	{ sw.ack = sim_sw_byte(); }
+	}
+	else if (sw.phase == SIM_SW_TX_ACK)	{ sw.ack = !sda; }
+}
+
+/*!\brief Sample software bus lines (master drive from DDRB, devices drive), decode conditions & edges, update PINB
+** \return nothing
+**/
+static void sim_sw_sample(void)
+{
+	const uint8_t	ddr = twi_sim_regs[TWI_SIM_DDRB];
+	const bool		scl = !(ddr & sw.scl_mask) && (twi_sim_cycles >= sw.hold_until);
+	bool			sda = !(ddr & sw.sda_mask) && !sw.drive;
+
+	if (sw.scl && scl)
+	{
+		if (sw.sda && !sda)		// START (or repeated START)
+		{
+			sw.phase = SIM_SW_RX;
+			sw.addr = true;
+			sw.cnt = 0;
+		}
+		else if (!sw.sda && sda)	// STOP
+		{
+			if (sw.cur)	{ sim_dev_stop(sw.cur); }
+			sw.cur = NULL;
+			sw.phase = SIM_SW_IDLE;
+		}
+	}
+	else if (!sw.scl && scl)	{ sim_sw_rising(sda); }
+	else if (sw.scl && !scl)
+	{
+		sim_sw_falling();
+		sda = !(ddr & sw.sda_mask) && !sw.drive;
+	}
+
+	sw.sda = sda;
+	sw.scl = scl;
+	twi_sim_regs[TWI_SIM_PINB] = (uint8_t) ((twi_sim_regs[TWI_SIM_PINB] & ~(sw.sda_mask | sw.scl_mask)) | (sda ? sw.sda_mask : 0) | (scl ? sw.scl_mask : 0));
+}
+
+
+/*!\brief Reset simulator (registers, time, statistics, detach all devices)
+** \return nothing
+**/
+void twi_sim_init(void)
+{
+	memset((void *) twi_sim_regs, 0, sizeof(twi_sim_regs));
+	memset(&sim, 0, sizeof(sim));
+	memset(&twi_sim_stats, 0, sizeof(twi_sim_stats));
+	memset(&sw, 0, sizeof(sw));
+
+	twi_sim_cycles = 0;
+	twi_sim_regs[TWI_SIM_SREG] = 0x80;
+	twi_sim_regs[TWI_SIM_TWSR] = NO_INFO;
+
+	twi_sim_cfg.reg_cycles = 4;
+	twi_sim_cfg.clock_cycles = 40;
+	twi_sim_cfg.call_cycles = 0;
+	twi_sim_cfg.nack_permille = 0;
+	twi_sim_cfg.arb_permille = 0;
+	twi_sim_cfg.seed = 0x1234567;
+
+	sim.rng = twi_sim_cfg.seed;
+	sim_mark();
+}
+
+/*!\brief Access simulated TWCR (processes pending write and bus events first)
+** \return pointer to TWCR backing store
+**/
+volatile uint8_t * twi_sim_twcr(void)
+{
+	twi_sim_cycles += twi_sim_cfg.reg_cycles;
+	sim_sync();
+	return &TWCR_REG;
+}
+
+/*!\brief Let simulated time elapse (bus events and TWI interrupts are processed meanwhile, software bus lines sampled afterwards)
+** \param [in] cycles - number of CPU cycles to elapse
+** \return nothing
+**/
+void twi_sim_run(const uint64_t cycles)
+{
+	const uint64_t end = twi_sim_cycles + cycles;
+
+	sim_sync();
+	while (true)
+	{
+		uint64_t next = end;
+
+		if (sim.sto && (sim.sto_at < next))			{ next = sim.sto_at; }
+		if (sim.pending && (sim.done_at < next))	{ next = sim.done_at; }
+		if (next > twi_sim_cycles)					{ twi_sim_cycles = next; }
+
+		sim_sync();
+		if (twi_sim_cycles >= end)	{ break; }
+	}
+
+	sim_sw_sample();
+}
+
+/*!\brief Init a memory device (EEPROM / FRAM)
+** \param [in, out] dev - pointer to device to init
+** \param [in] addr - 7 bits slave address
+** \param [in] mem - memory array
+** \param [in] size - memory array size
+** \param [in] reg_size - number of internal address bytes
+** \param [in] page_size - write page size (0 if none)
+** \param [in] write_us - internal write cycle duration (0 if none)
+** \return nothing
+**/
+void twi_sim_mem(TWI_SIM_DEV * dev, const uint8_t addr, uint8_t * mem, const uint32_t size, const uint8_t reg_size, const uint16_t page_size, const uint32_t write_us)
+{
+	memset(dev, 0, sizeof(TWI_SIM_DEV));
+	dev->addr = addr;
+	dev->type = TWI_SIM_MEM;
+	dev->mem = mem;
+	dev->size = size;
+	dev->reg_size = reg_size;
+	dev->page_size = page_size;
+	dev->write_us = write_us;
+}
+
+/*!\brief Init a FRAM device (no write cycle, answering to Device ID command)
+** \param [in, out] dev - pointer to device to init
+** \param [in] addr - 7 bits slave address
+** \param [in] mem - memory array
+** \param [in] size - memory array size
+** \param [in] id - 3 bytes device ID
+** \return nothing
+**/
+void twi_sim_fram(TWI_SIM_DEV * dev, const uint8_t addr, uint8_t * mem, const uint32_t size, const uint8_t id[3])
+{
+	twi_sim_mem(dev, addr, mem, size, 2, 0, 0);
+	memcpy(dev->id, id, sizeof(dev->id));
+	dev->has_id = true;
+}
+
+/*!\brief Init a device NACKing its address
+** \param [in, out] dev - pointer to device to init
+** \param [in] addr - 7 bits slave address
+** \param [in] times - number of address phases to NACK before answering (0xFF: always)
+** \return nothing
+**/
+void twi_sim_nack(TWI_SIM_DEV * dev, const uint8_t addr, const uint8_t times)
+{
+	memset(dev, 0, sizeof(TWI_SIM_DEV));
+	dev->addr = addr;
+	dev->type = TWI_SIM_NACK;
+	dev->addr_nack = times;
+}
+
+/*!\brief Attach device to simulated bus
+** \param [in, out] dev - pointer to device to attach
+** \return nothing
+**/
+void twi_sim_attach(TWI_SIM_DEV * dev)
+{
+	dev->next = sim.devs;
+	sim.devs = dev;
+}
+
+/*!\brief Get simulated elapsed time in microseconds
+** \return elapsed time (us)
+**/
+uint64_t twi_sim_us(void) {
+	return twi_sim_cycles / (F_CPU / 1000000UL); }
+
+/*!\brief Function entry hook (sources built with -finstrument-functions): call overhead charged as CPU time
+** \param [in] fn - entered function
+** \param [in] site - call site
+** \return nothing
+**/
+void __attribute__((__no_instrument_function__)) __cyg_profile_func_enter(void * fn, void * site)
+{
+	(void) fn;
+	(void) site;
+	twi_sim_cycles += twi_sim_cfg.call_cycles;
+}
+
+/*!\brief Function exit hook (sources built with -finstrument-functions): nothing charged, return included in call overhead
+** \param [in] fn - exited function
+** \param [in] site - call site
+** \return nothing
+**/
+void __attribute__((__no_instrument_function__)) __cyg_profile_func_exit(void * fn, void * site)
+{
+	(void) fn;
+	(void) site;
+}
+
+
+unsigned long millis(void)
+{
+	twi_sim_run(twi_sim_cfg.clock_cycles);
+	return (unsigned long) (twi_sim_cycles / (F_CPU / 1000UL));
+}
+
+unsigned long micros(void)
+{
+	twi_sim_run(twi_sim_cfg.clock_cycles);
+	return (unsigned long) (twi_sim_cycles / (F_CPU / 1000000UL));
+}
+
+void delay(unsigned long ms) {
+	twi_sim_run(sim_us2cycles((uint64_t) ms * 1000)); }
+
+void delayMicroseconds(unsigned int us) {
+	twi_sim_run(sim_us2cycles(us)); }
+
+void _delay_loop_1(uint8_t count) {
+	twi_sim_run(3 * (uint64_t) (count ? count : 256)); }
+
+/*!\brief Set software bus lines (bit-banged master on port B)
+** \param [in] sda_mask - SDA pin mask in port B
+** \param [in] scl_mask - SCL pin mask in port B
+** \return nothing
+**/
+void twi_sim_sw_pins(const uint8_t sda_mask, const uint8_t scl_mask)
+{
+	sw.sda_mask = sda_mask;
+	sw.scl_mask = scl_mask;
+	sw.sda = sw.scl = true;
+	sim_sw_sample();
+}
+
+/*!\brief Attach device to simulated software bus (port B lines decoded whenever simulated time elapses)
+** \param [in, out] dev - pointer to device to attach
+** \return nothing
+**/
+void twi_sim_sw_attach(TWI_SIM_DEV * dev)
+{
+	dev->next = sw.devs;
+	sw.devs = dev;
+}
+
+/*!\brief External master write to simulated TWI in slave mode (START, address, data bytes, STOP)
+** \param [in] addr - 7 bits slave address
+** \param [in] data - bytes to write
+** \param [in] nb - number of bytes to write
+** \return number of bytes acknowledged (-1 if address not acknowledged)
+**/
+int twi_sim_ext_write(const uint8_t addr, const uint8_t * data, const uint16_t nb)
+{
+	int n = 0;
+
+	if (!sim_slave_addressed(addr))				{ return -1; }
+	if (!sim_slave_event(SR_SLA_ACK))			{ return -1; }
+
+	while (n < nb)
+	{
+		const bool ack = (TWCR_REG & (1 << TWEA)) != 0;
+
+		twi_sim_regs[TWI_SIM_TWDR] = data[n];
+		(void) sim_slave_event(ack ? SR_DATA_ACK : SR_DATA_NACK);
+		if (!ack)	{ twi_sim_stats.nacks++; break; }	// Slave not addressed anymore
+		n++;
+	}
+
+	if (n == nb)	{ (void) sim_slave_event(SR_STOP); }
+	twi_sim_stats.stops++;
+	return n;
+}
+
+/*!\brief External master read from simulated TWI in slave mode (START, address, data bytes, STOP)
+** \param [in] addr - 7 bits slave address
+** \param [in, out] data - bytes read
+** \param [in] nb - number of bytes to read
+** \return number of bytes read (-1 if address not acknowledged)
+**/
+int twi_sim_ext_read(const uint8_t addr, uint8_t * data, const uint16_t nb)
+{
+	if (!sim_slave_addressed(addr))				{ return -1; }
+	if (!sim_slave_event(ST_SLA_ACK))			{ return -1; }
+
+	for (uint16_t n = 0 ; n < nb ; n++)
+	{
+		data[n] = twi_sim_regs[TWI_SIM_TWDR];
+		(void) sim_slave_event(((n + 1) < nb) ? ST_DATA_ACK : ST_DATA_NACK);
+	}
+
+	twi_sim_stats.stops++;
+	return nb;
+}
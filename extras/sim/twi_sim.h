@@ -0,0 +1,213 @@
+/*!\file twi_sim.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief host side AVR TWI peripheral simulator declarations
+** \details Simulates TWCR/TWSR/TWDR/TWBR registers, bus timing (from TWBR/prescaler and F_CPU),
+**			CPU time spent polling registers and scriptable virtual slaves, so cI2C sources run unmodified on a host.
+**/
+/****************************************************************/
+#ifndef __TWI_SIM_H__
+	#define __TWI_SIM_H__
+/****************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TWI_SIM_ID_ADDR			0x7C	//!< Reserved Device ID address (0xF8 >> 1)
+
+
+/*!\enum enTWI_SIM_REG
+** \brief Simulated registers index in backing store
+**/
+typedef enum enTWI_SIM_REG {
+	TWI_SIM_TWCR = 0,	//!< TWI control register
+	TWI_SIM_TWSR,		//!< TWI status register
+	TWI_SIM_TWDR,		//!< TWI data register
+	TWI_SIM_TWBR,		//!< TWI bit rate register
+	TWI_SIM_TWAR,		//!< TWI (slave) address register
+	TWI_SIM_TWAMR,		//!< TWI (slave) address mask register
+	TWI_SIM_SREG,		//!< Status register (global interrupt flag)
+	TWI_SIM_PORTC,		//!< Port C
+	TWI_SIM_PORTD,		//!< Port D
+	TWI_SIM_PINB,		//!< Port B input (software bus lines level)
+	TWI_SIM_DDRB,		//!< Port B direction (software bus lines driven low when set)
+	TWI_SIM_PORTB,		//!< Port B output
+	TWI_SIM_NB_REGS		//!< Number of simulated registers
+} TWI_SIM_REG;
+
+
+/*!\enum enTWI_SIM_DEV_TYPE
+** \brief Virtual slave type
+**/
+typedef enum enTWI_SIM_DEV_TYPE {
+	TWI_SIM_MEM = 0,	//!< Memory device (EEPROM / FRAM)
+	TWI_SIM_NACK,		//!< Device NACKing its address (absent / busy device)
+	TWI_SIM_CUSTOM		//!< Device handled by user callbacks
+} TWI_SIM_DEV_TYPE;
+
+
+/*!\struct StructTwiSimDev
+** \brief Virtual slave description and runtime state
+**/
+typedef struct StructTwiSimDev {
+	uint8_t				addr;			//!< 7 bits slave address
+	TWI_SIM_DEV_TYPE	type;			//!< Device type
+	uint8_t *			mem;			//!< Memory array
+	uint32_t			size;			//!< Memory array size
+	uint8_t				reg_size;		//!< Number of internal address bytes (0 to 2)
+	uint16_t			page_size;		//!< Write page size (internal pointer wraps in page when writing, 0 if none)
+	uint32_t			write_us;		//!< Internal write cycle duration (address NACKed meanwhile, 0 if none)
+	uint32_t			stretch_us;		//!< Clock stretching applied on each byte (us)
+	uint8_t				addr_nack;		//!< Number of next address phases to NACK (0xFF: always)
+	uint8_t				id[3];			//!< Device ID returned through TWI_SIM_ID_ADDR (FRAM)
+	bool				has_id;			//!< Device answers to Device ID command
+
+	// user callbacks (TWI_SIM_CUSTOM)
+	bool	(*on_start)(struct StructTwiSimDev *, const uint8_t rw);	//!< Address phase (return ack)
+	bool	(*on_write)(struct StructTwiSimDev *, const uint8_t dat);	//!< Byte written by master (return ack)
+	uint8_t	(*on_read)(struct StructTwiSimDev *);						//!< Byte read by master
+	void	(*on_stop)(struct StructTwiSimDev *);						//!< Stop condition
+	void *				ctx;			//!< User context
+
+	// runtime
+	uint32_t			ptr;			//!< Internal address pointer
+	uint8_t				addr_cnt;		//!< Internal address bytes received in current write
+	uint8_t				wr_cnt;			//!< Data bytes written in current transaction
+	uint64_t			busy_until;		//!< End of internal write cycle (cycles)
+	struct StructTwiSimDev *	next;	//!< Next attached device
+} TWI_SIM_DEV;
+
+
+/*!\struct StructTwiSimStats
+** \brief Simulated bus statistics
+**/
+typedef struct StructTwiSimStats {
+	uint64_t			bus_cycles;		//!< Cycles where bus was clocked (START, bytes, STOP, stretching)
+	uint32_t			starts;			//!< Number of (repeated) START conditions
+	uint32_t			stops;			//!< Number of STOP conditions
+	uint32_t			bytes;			//!< Number of bytes clocked (address bytes included)
+	uint32_t			nacks;			//!< Number of NACKs received by master
+	uint32_t			arb_lost;		//!< Number of arbitration losses
+	uint32_t			isr;			//!< Number of TWI interrupts fired
+	uint64_t			slave_hold_max;	//!< Max cycles bus was held by slave mode (TWINT set) on a single event
+	uint32_t			sw_bytes;		//!< Number of bytes clocked on software bus (address bytes included)
+	uint32_t			sw_nacks;		//!< Number of NACKs sent by devices on software bus
+} TWI_SIM_STATS;
+
+
+/*!\struct StructTwiSimCfg
+** \brief Simulator configuration
+**/
+typedef struct StructTwiSimCfg {
+	uint8_t				reg_cycles;		//!< CPU cycles charged for each TWCR access
+	uint8_t				clock_cycles;	//!< CPU cycles charged for each millis()/micros() call
+	uint8_t				call_cycles;	//!< CPU cycles charged for each function call (sources built with -finstrument-functions only)
+	uint16_t			nack_permille;	//!< Injected data NACK rate (per mille)
+	uint16_t			arb_permille;	//!< Injected arbitration loss rate on address phase (per mille)
+	uint32_t			seed;			//!< Pseudo random generator seed (faults injection)
+} TWI_SIM_CFG;
+
+
+extern volatile uint8_t	twi_sim_regs[];		//!< Simulated registers backing store
+extern uint64_t			twi_sim_cycles;		//!< Simulated CPU time (cycles)
+extern TWI_SIM_CFG		twi_sim_cfg;		//!< Simulator configuration
+extern TWI_SIM_STATS	twi_sim_stats;		//!< Simulated bus statistics
+
+
+/*!\brief Reset simulator (registers, time, statistics, detach all devices)
+** \return nothing
+**/
+void twi_sim_init(void);
+
+/*!\brief Access simulated TWCR (processes pending write and bus events first)
+** \return pointer to TWCR backing store
+**/
+volatile uint8_t * twi_sim_twcr(void);
+
+/*!\brief Let simulated time elapse (bus events and TWI interrupts are processed meanwhile, software bus lines sampled afterwards)
+** \param [in] cycles - number of CPU cycles to elapse
+** \return nothing
+**/
+void twi_sim_run(const uint64_t cycles);
+
+/*!\brief Init a memory device (EEPROM / FRAM)
+** \param [in, out] dev - pointer to device to init
+** \param [in] addr - 7 bits slave address
+** \param [in] mem - memory array
+** \param [in] size - memory array size
+** \param [in] reg_size - number of internal address bytes
+** \param [in] page_size - write page size (0 if none)
+** \param [in] write_us - internal write cycle duration (0 if none)
+** \return nothing
+**/
+void twi_sim_mem(TWI_SIM_DEV * dev, const uint8_t addr, uint8_t * mem, const uint32_t size, const uint8_t reg_size, const uint16_t page_size, const uint32_t write_us);
+
+/*!\brief Init a FRAM device (no write cycle, answering to Device ID command)
+** \param [in, out] dev - pointer to device to init
+** \param [in] addr - 7 bits slave address
+** \param [in] mem - memory array
+** \param [in] size - memory array size
+** \param [in] id - 3 bytes device ID
+** \return nothing
+**/
+void twi_sim_fram(TWI_SIM_DEV * dev, const uint8_t addr, uint8_t * mem, const uint32_t size, const uint8_t id[3]);
+
+/*!\brief Init a device NACKing its address
+** \param [in, out] dev - pointer to device to init
+** \param [in] addr - 7 bits slave address
+** \param [in] times - number of address phases to NACK before answering (0xFF: always)
+** \return nothing
+**/
+void twi_sim_nack(TWI_SIM_DEV * dev, const uint8_t addr, const uint8_t times);
+
+/*!\brief Attach device to simulated bus
+** \param [in, out] dev - pointer to device to attach
+** \return nothing
+**/
+void twi_sim_attach(TWI_SIM_DEV * dev);
+
+/*!\brief Set software bus lines (bit-banged master on port B)
+** \param [in] sda_mask - SDA pin mask in port B
+** \param [in] scl_mask - SCL pin mask in port B
+** \return nothing
+**/
+void twi_sim_sw_pins(const uint8_t sda_mask, const uint8_t scl_mask);
+
+/*!\brief Attach device to simulated software bus (port B lines decoded whenever simulated time elapses)
+** \param [in, out] dev - pointer to device to attach
+** \return nothing
+**/
+void twi_sim_sw_attach(TWI_SIM_DEV * dev);
+
+/*!\brief External master write to simulated TWI in slave mode (START, address, data bytes, STOP)
+** \param [in] addr - 7 bits slave address
+** \param [in] data - bytes to write
+** \param [in] nb - number of bytes to write
+** \return number of bytes acknowledged (-1 if address not acknowledged)
+**/
+int twi_sim_ext_write(const uint8_t addr, const uint8_t * data, const uint16_t nb);
+
+/*!\brief External master read from simulated TWI in slave mode (START, address, data bytes, STOP)
+** \param [in] addr - 7 bits slave address
+** \param [in, out] data - bytes read
+** \param [in] nb - number of bytes to read
+** \return number of bytes read (-1 if address not acknowledged)
+**/
+int twi_sim_ext_read(const uint8_t addr, uint8_t * data, const uint16_t nb);
+
+/*!\brief Get simulated elapsed time in microseconds
+** \return elapsed time (us)
+**/
+uint64_t twi_sim_us(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
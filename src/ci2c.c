@@ -1,13 +1,10 @@
 /*!\file ci2c.c
 ** \author SMFSW
 ** \copyright MIT SMFSW (2017-2018)
-** \brief arduino master i2c in plain c code
+** \brief arduino master (and interrupt driven slave) i2c in plain c code
 ** \warning Don't access (r/w) last 16b internal address byte alone right after init, this would lead to hazardous result (in such case, make a dummy read of addr 0 before)
 **/
 
-// TODO: add interrupt vector / callback for it operations (if not too messy)
-// TODO: consider interrupts at least for RX when slave (and TX when master)
-
 #include "ci2c.h"
 
 #define START					0x08
@@ -21,8 +18,34 @@
 #define MR_DATA_ACK				0x50
 #define MR_DATA_NACK			0x58
 #define LOST_ARBTRTN			0x38
+#define SR_SLA_ACK				0x60
+#define SR_ARB_SLA_ACK			0x68
+#define SR_GCALL_ACK			0x70
+#define SR_ARB_GCALL_ACK		0x78
+#define SR_DATA_ACK				0x80
+#define SR_DATA_NACK			0x88
+#define SR_GCALL_DATA_ACK		0x90
+#define SR_GCALL_DATA_NACK		0x98
+#define SR_STOP					0xA0
+#define ST_SLA_ACK				0xA8
+#define ST_ARB_SLA_ACK			0xB0
+#define ST_DATA_ACK				0xB8
+#define ST_DATA_NACK			0xC0
+#define ST_LAST_DATA			0xC8
 #define TWI_STATUS				(TWSR & 0xF8)
 
+#define CI2C_TIMEOUT_SPIN		16		//!< Polling loops between two time checks
+#define CI2C_XFER_OVERHEAD		8		//!< Bytes time allowed for transaction overhead (START, addresses, STOP)
+#define CI2C_RETRY_DELAY		1		//!< Delay before retrying a failed transaction (ms)
+
+#if CI2C_STATS
+	#define I2C_STAT_INC(f)		do { if (i2c_st_slave) { i2c_st_slave->stats.f++; } } while (0)	//!< Increment current slave statistic \b f
+	#define I2C_TRACE(st)		I2C_trace_add(st)													//!< Trace bus event with status \b st
+#else
+	#define I2C_STAT_INC(f)		//!< Increment current slave statistic \b f (instrumentation disabled)
+	#define I2C_TRACE(st)		//!< Trace bus event with status \b st (instrumentation disabled)
+#endif
+
 //#define isSetRegBit(r, b)		((r & (1 << b)) != 0)
 //#define isClrRegBit(r, b)		((r & (1 << b)) == 0)
 
@@ -30,26 +53,142 @@
 #define clrRegBit(r, b)			r &= (uint8_t) (~(1 << b))	//!< clear bit \b b in register \b r
 #define invRegBit(r, b)			r ^= (1 << b)				//!< invert bit \b b in register \b r
 
-/*!\struct i2c
-** \brief static ci2c bus config and control parameters
+#define I2C_BUS_SEL(b)			((b) ? (b) : &i2c)			//!< bus \b b (hardware TWI if NULL)
+
+// Hardware TWI backend prototypes
+static uint16_t I2C_hw_clk_regs(const uint16_t speed, uint8_t * twbr, uint8_t * twps);
+static uint16_t I2C_hw_set_speed(I2C_BUS * bus, const uint16_t speed);
+static bool I2C_hw_start(I2C_BUS * bus);
+static bool I2C_hw_stop(I2C_BUS * bus);
+static bool I2C_hw_sndSla(I2C_BUS * bus, const uint8_t sla);
+static bool I2C_hw_wr8(I2C_BUS * bus, const uint8_t dat);
+static bool I2C_hw_rd8(I2C_BUS * bus, uint8_t * dat, const bool ack);
+static bool I2C_hw_wr_burst(I2C_BUS * bus, const uint8_t * data, const uint16_t bytes);
+static bool I2C_hw_rd_burst(I2C_BUS * bus, uint8_t * data, const uint16_t bytes, const bool last);
+
+/*!\brief Hardware TWI backend operations
+**/
+static const I2C_BUS_OPS i2c_hw_ops = { I2C_hw_set_speed, I2C_hw_start, I2C_hw_stop, I2C_hw_sndSla, I2C_hw_wr8, I2C_hw_rd8, I2C_hw_wr_burst, I2C_hw_rd_burst, NULL };
+
+/*!\brief static ci2c hardware TWI bus
+**/
+static I2C_BUS i2c = { &i2c_hw_ops, { (I2C_SPEED) 0, DEF_CI2C_NB_RETRIES, DEF_CI2C_TIMEOUT, DEF_CI2C_STRETCH }, 0, 0, 0, 0, 0, false, 0, false, 1, NULL, false };
+static I2C_BUS *	i2c_def_bus = NULL;		//!< Bus slaves are attached to by I2C_slave_init (NULL for hardware TWI)
+
+/*!\struct i2c_clk
+** \brief static hardware TWI clock registers for bus speed (restored after slaves with their own speed profile)
+**/
+static struct {
+	uint8_t			twbr;		//!< Bit rate register
+	uint8_t			twps;		//!< Prescaler bits
+} i2c_clk;
+
+#if CI2C_STATS
+static I2C_SLAVE *	i2c_st_slave;	//!< Slave statistics are accounted to
+#endif
+
+/*!\struct StructI2CMuxWr
+** \brief Mux control register write preceding a transaction
+**/
+typedef struct StructI2CMuxWr {
+	I2C_MUX *			mux;		//!< Mux to write
+	uint8_t				sel;		//!< Control register value
+} I2C_MUX_WR;
+
+/*!\struct i2c_it
+** \brief static ci2c asynchronous (interrupt driven) transaction context
+**/
+static struct {
+	I2C_SLAVE *			slave;		//!< Slave owning the transaction
+	ci2c_cb_fct_ptr		cb;			//!< Completion callback
+	uint8_t *			buf;		//!< Transaction data buffer (kept for retries)
+	uint8_t *			data;		//!< Pointer to next data byte to handle
+	uint16_t			bytes;		//!< Number of data bytes still to handle
+	uint16_t			nb;			//!< Transaction data length (kept for retries)
+	uint16_t			reg_addr;	//!< Transaction register address (kept for retries)
+	uint8_t				reg[2];		//!< Register address bytes to send
+	uint8_t				reg_nb;		//!< Number of register address bytes to send
+	uint8_t				reg_idx;	//!< Index of next register address byte to send
+	I2C_MUX_WR			ctl[2];		//!< Mux control register writes preceding transaction
+	uint8_t				ctl_nb;		//!< Number of mux control register writes
+	uint8_t				ctl_idx;	//!< Index of current mux control register write
+	bool				ctl_val;	//!< Current mux control register value sent (STOP pending)
+	I2C_RW				rw;			//!< Transaction direction
+	I2C_RW				phase;		//!< Direction of the current address phase
+	uint8_t				retry;		//!< Remaining retries
+	bool				wait;		//!< Retry delayed (attempt relaunched by I2C_async_process once retry delay elapsed)
+	uint32_t			t_arm;		//!< Current attempt (or retry delay) start time (us)
+	uint32_t			budget;		//!< Time allowed to current attempt (us)
+#if CI2C_STATS
+	uint32_t			t_start;	//!< Transaction start time (us)
+#endif
+} i2c_it;
+
+/*!\struct i2c_slv
+** \brief static ci2c slave mode context
+**/
+static struct {
+	uint8_t *			regs;		//!< Registers map (served in place, NULL if slave mode stopped)
+	uint16_t			size;		//!< Registers map size
+	I2C_INT_SIZE		reg_size;	//!< Register address size
+	ci2c_reg_cb_fct_ptr	on_write;	//!< Registers written hook
+	uint16_t			ptr;		//!< Current register address
+	uint8_t				addr_cnt;	//!< Register address bytes still expected in current write
+	uint16_t			wr_start;	//!< First register written in current write
+	uint16_t			wr_cnt;		//!< Number of registers written in current write
+	volatile bool		active;		//!< true while addressed by a master (bus not available for master transactions)
+	bool				resume;		//!< Asynchronous master transaction to restart (arbitration lost, then addressed as slave)
+} i2c_slv;
+
+#if CI2C_STATS
+/*!\struct i2c_trace
+** \brief static ci2c bus events trace ring
 **/
 static struct {
-	/*!\struct cfg
-	** \brief ci2c bus parameters
-	**/
-	struct {
-		I2C_SPEED	speed;			//!< i2c bus speed
-		uint8_t		retries;		//!< i2c message retries when fail
-		uint16_t	timeout;		//!< i2c timeout (ms)
-	} cfg;
-	uint16_t		start_wait;		//!< time start waiting for acknowledge
-	bool			busy;			//!< true if already busy (in case of interrupts implementation)
-} i2c = { { (I2C_SPEED) 0, DEF_CI2C_NB_RETRIES, DEF_CI2C_TIMEOUT }, 0, false };
+	I2C_TRACE_EVT		evt[CI2C_TRACE_SIZE];	//!< Events ring
+	uint8_t				idx;					//!< Index of next event to write
+	uint8_t				nb;						//!< Number of events in ring
+} i2c_trace;
+#endif
+
+/*!\struct StructI2CVec
+** \brief Vectored transfer descriptor (given as data to vectored transaction functions)
+**/
+typedef struct StructI2CVec {
+	const I2C_SEG *		segs;		//!< First segment
+	uint16_t			base;		//!< Register address of first byte of first segment
+} I2C_VEC;
+
+/*!\struct StructI2CChunks
+** \brief Source / sink transfer descriptor (given as data to chunked transaction functions)
+**/
+typedef struct StructI2CChunks {
+	union {
+		ci2c_src_fct_ptr	src;	//!< Write source
+		ci2c_sink_fct_ptr	sink;	//!< Read sink
+	} fct;
+	void *				ctx;		//!< Source / sink context
+	uint16_t			base;		//!< Register address of first byte
+	uint32_t			bytes;		//!< Number of bytes to transfer
+	uint32_t			done;		//!< Number of bytes transferred (written & acknowledged, or read & given to sink)
+	uint32_t			end;		//!< End of current transaction (from first byte)
+	uint16_t			held;		//!< Number of bytes given by source not written yet (chunk buffer)
+	uint8_t				buf[CI2C_CHUNK_SIZE];	//!< Chunk buffer
+} I2C_CHUNKS;
 
 
 // Needed prototypes
 static bool I2C_wr(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
 static bool I2C_rd(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+static bool I2C_wrv(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+static bool I2C_rdv(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+static bool I2C_wr_src(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+static bool I2C_rd_sink(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+static bool I2C_bus_wr(I2C_BUS * bus, const uint8_t * data, const uint16_t bytes);
+static bool I2C_bus_rd(I2C_BUS * bus, uint8_t * data, const uint16_t bytes, const bool last);
+static bool I2C_msgs(I2C_BUS * bus, const I2C_MSG * msgs, const uint8_t nb);
+static void I2C_it_launch(void);
+static void I2C_it_done(const I2C_STATUS status);
 
 
 /*!\brief Init an I2C slave structure for cMI2C communication
@@ -64,8 +203,19 @@ void I2C_slave_init(I2C_SLAVE * slave, const uint8_t sl_addr, const I2C_INT_SIZE
 	(void) I2C_slave_set_reg_size(slave, reg_sz);
 	I2C_slave_set_rw_func(slave, (ci2c_fct_ptr) I2C_wr, I2C_WRITE);
 	I2C_slave_set_rw_func(slave, (ci2c_fct_ptr) I2C_rd, I2C_READ);
-	slave->reg_addr = (uint16_t) -1;	// To be sure to send address on first access (warning: unless last 16b byte address is accessed alone)
+	(void) I2C_slave_set_page_size(slave, 0);
+	(void) I2C_slave_set_blocks(slave, 0, 0);
+	(void) I2C_slave_set_mux(slave, NULL, 0);
+	I2C_slave_set_bus(slave, i2c_def_bus);
+	(void) I2C_slave_set_speed(slave, 0);
+	I2C_slave_set_breaker(slave, 0);
+	slave->cfg.pec = false;
+	slave->reg_addr = 0;
+	I2C_slave_forget_reg_addr(slave);	// Address sent on first access
 	slave->status = I2C_OK;
+#if CI2C_STATS
+	I2C_slave_reset_stats(slave);
+#endif
 }
 
 /*!\brief Redirect slave I2C read/write function (if needed for advanced use)
@@ -89,6 +239,7 @@ bool I2C_slave_set_addr(I2C_SLAVE * slave, const uint8_t sl_addr)
 {
 	if (sl_addr > 0x7F)		{ return false; }
 	slave->cfg.addr = sl_addr;
+	I2C_slave_forget_reg_addr(slave);
 	return true;
 }
 
@@ -100,18 +251,369 @@ bool I2C_slave_set_addr(I2C_SLAVE * slave, const uint8_t sl_addr)
 bool I2C_slave_set_reg_size(I2C_SLAVE * slave, const I2C_INT_SIZE reg_sz)
 {
 	slave->cfg.reg_size = reg_sz > I2C_16B_REG ? I2C_16B_REG : reg_sz;
+	I2C_slave_forget_reg_addr(slave);
 	return !(reg_sz > I2C_16B_REG);
 }
 
-/*!\brief Set I2C current register address
+/*!\brief Change I2C bus slave is connected to
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \return nothing
+**/
+void I2C_slave_set_bus(I2C_SLAVE * slave, I2C_BUS * bus)
+{
+	slave->cfg.bus = (bus == &i2c) ? NULL : bus;
+#if CI2C_MUX
+	if ((slave->cfg.mux) && (slave->cfg.mux->bus != slave->cfg.bus))	{ slave->cfg.mux = NULL; }	// Detached from mux on another bus
+#endif
+	I2C_slave_forget_reg_addr(slave);
+}
+
+/*!\brief Change I2C mux channel slave is reachable through (slave attached to mux upstream bus)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] mux - pointer to the I2C mux structure (NULL if slave is directly on bus)
+** \param [in] chan - mux channel slave is connected to
+** \return true if set (false if channel is out of range or mux given while not built with CI2C_MUX, slave left unchanged)
+**/
+bool I2C_slave_set_mux(I2C_SLAVE * slave, I2C_MUX * mux, const uint8_t chan)
+{
+	if (chan >= CI2C_MUX_CHANNELS)	{ return false; }
+#if CI2C_MUX
+	slave->cfg.mux = NULL;
+	if (mux)	{ I2C_slave_set_bus(slave, mux->bus); }
+	slave->cfg.mux = mux;
+	slave->cfg.chan = chan;
+	I2C_slave_forget_reg_addr(slave);
+	return true;
+#else
+	(void) slave;
+	return (mux == NULL);
+#endif
+}
+
+/*!\brief Compute hardware TWI clock registers of slave current speed
+** \param [in, out] slave - pointer to the I2C slave structure
+** \return Actual slave speed
+**/
+static uint16_t I2C_slave_clk_regs(I2C_SLAVE * slave)
+{
+	uint8_t		twbr, twps;
+	uint16_t	speed = I2C_hw_clk_regs(I2C_slave_get_speed(slave), &twbr, &twps);
+
+	slave->twbr = twbr;
+	slave->twps = twps;
+	return speed;
+}
+
+/*!\brief Change I2C slave speed profile (bus clocked at this speed for slave transactions only)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] speed - I2C slave speed in KHz (max 400KHz, 0 to use bus speed)
+** \return Configured slave speed (actual hardware TWI clock, 0 if bus speed)
+**/
+uint16_t I2C_slave_set_speed(I2C_SLAVE * slave, const uint16_t speed)
+{
+	slave->cfg.speed = (speed > (uint16_t) I2C_FM) ? (uint16_t) I2C_FM : speed;
+#if CI2C_ADAPTIVE
+	slave->drop = 0;
+	slave->fails = 0;
+	slave->probe = CI2C_SPEED_PROBE;
+#endif
+
+	if (slave->cfg.speed == 0)
+	{
+#if CI2C_ADAPTIVE
+		slave->cfg.adaptive = false;
+#endif
+		slave->twbr = slave->twps = 0;
+		return 0;
+	}
+	return I2C_slave_clk_regs(slave);
+}
+
+/*!\brief Enable/disable I2C slave adaptive speed
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] adaptive - true to enable adaptive speed
+** \return true if set (false if slave has no speed profile or adaptive speed is not built: CI2C_ADAPTIVE)
+**/
+bool I2C_slave_set_adaptive(I2C_SLAVE * slave, const bool adaptive)
+{
+	if (adaptive && (slave->cfg.speed == 0))	{ return false; }
+#if CI2C_ADAPTIVE
+	slave->cfg.adaptive = adaptive;
+	if ((!adaptive) && (slave->drop))	{ (void) I2C_slave_set_speed(slave, slave->cfg.speed); }	// Back to nominal speed
+	return true;
+#else
+	return !adaptive;
+#endif
+}
+
+/*!\brief Adaptive speed: account transaction result (speed stepped down after failures, probed back up after successes)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] ack - true if transaction succeeded
+** \return nothing
+**/
+static void I2C_slave_speed_track(I2C_SLAVE * slave, const bool ack)
+{
+#if CI2C_ADAPTIVE
+	if (!slave->cfg.adaptive)	{ return; }
+
+	if (!ack)
+	{
+		slave->probe = CI2C_SPEED_PROBE;
+		if ((++slave->fails >= CI2C_SPEED_FAILS) && (slave->drop < CI2C_SPEED_MAX_DROP) && ((slave->cfg.speed >> (slave->drop + 1)) != 0))
+		{
+			slave->drop++;
+			slave->fails = 0;
+			(void) I2C_slave_clk_regs(slave);
+		}
+	}
+	else
+	{
+		slave->fails = 0;
+		if ((slave->drop) && (--slave->probe == 0))
+		{
+			slave->drop--;
+			slave->probe = CI2C_SPEED_PROBE;
+			(void) I2C_slave_clk_regs(slave);
+		}
+	}
+#else
+	(void) slave;
+	(void) ack;
+#endif
+}
+
+/*!\brief Change I2C slave circuit breaker threshold
+** \param [in, out] slave - pointer to the I2C slave structure
+** \note No effect unless built with CI2C_BREAKER
+** \param [in] fails - consecutive failed transactions opening breaker (0 to disable circuit breaker)
+** \return nothing
+**/
+void I2C_slave_set_breaker(I2C_SLAVE * slave, const uint8_t fails)
+{
+#if CI2C_BREAKER
+	slave->cfg.breaker = fails;
+	slave->brk_cnt = 0;
+#else
+	(void) slave;
+	(void) fails;
+#endif
+}
+
+/*!\brief Circuit breaker gate of a slave transaction
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] retries - retries of transaction when breaker is closed
+** \param [in, out] allowed - pointer to retries allowed for transaction (none for half-open attempt)
+** \return true if transaction may go on bus (false if it has to fail fast)
+**/
+static bool I2C_slave_gate(I2C_SLAVE * slave, const uint8_t retries, uint8_t * allowed)
+{
+	*allowed = retries;
+#if CI2C_BREAKER
+	if (!I2C_slave_is_broken(slave))	{ return true; }
+
+	if (((uint16_t) millis() - slave->brk_time) < CI2C_BREAKER_PROBE)
+	{
+#if CI2C_STATS
+		slave->stats.fast_fails++;
+#endif
+		return false;
+	}
+
+	slave->brk_time = (uint16_t) millis();	// Half-open attempt
+	*allowed = 0;
+#else
+	(void) slave;
+#endif
+	return true;
+}
+
+/*!\brief Circuit breaker: account transaction result (opened after consecutive failures, closed on success)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] ack - true if transaction succeeded
+** \return nothing
+**/
+static void I2C_slave_breaker_track(I2C_SLAVE * slave, const bool ack)
+{
+#if CI2C_BREAKER
+	if (!slave->cfg.breaker)	{ return; }
+
+	if (ack)											{ slave->brk_cnt = 0; }
+	else if (slave->brk_cnt < slave->cfg.breaker)
+	{
+		if (++slave->brk_cnt == slave->cfg.breaker)		{ slave->brk_time = (uint16_t) millis(); }
+	}
+#else
+	(void) slave;
+	(void) ack;
+#endif
+}
+
+/*!\brief Change I2C slave memory page size (paged memory mode)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] page_size - memory write page size (0 if slave is not a paged memory)
+** \return true if new page size set (false if page size is not a power of 2, paged mode disabled then)
+**/
+bool I2C_slave_set_page_size(I2C_SLAVE * slave, const uint16_t page_size)
+{
+	const bool pow2 = ((page_size & (page_size - 1)) == 0);
+
+	slave->cfg.page_size = pow2 ? page_size : 0;
+	return pow2;
+}
+
+/*!\brief Change I2C slave large memory mode (memory spanning several slave addresses)
+** \param [in, out] slave - pointer to the I2C slave structure (address of block 0)
+** \param [in] bits - number of block number bits (0 to disable large memory mode)
+** \param [in] shift - block number bits position in slave address
+** \return true if set (false if slave has no register address or block bits exceed 7 bits address, large memory mode disabled then)
+**/
+bool I2C_slave_set_blocks(I2C_SLAVE * slave, const uint8_t bits, const uint8_t shift)
+{
+	const bool ok = (bits == 0) || ((slave->cfg.reg_size != I2C_NO_REG) && ((bits + shift) <= 7));
+
+	slave->cfg.blk_bits = ok ? bits : 0;
+	slave->cfg.blk_shift = ok ? shift : 0;
+	slave->blk = 0;
+	I2C_slave_forget_reg_addr(slave);
+	return ok;
+}
+
+/*!\brief Test if I2C slave internal pointer is known on its bus
 ** \attribute inline
+** \param [in] bus - pointer to the I2C bus structure slave is connected to
+** \param [in] slave - pointer to the I2C slave structure
+** \return true if known (other masters may access devices while slave mode is started)
+**/
+static inline bool __attribute__((__always_inline__)) I2C_slave_reg_known(const I2C_BUS * bus, const I2C_SLAVE * slave) {
+	return (slave->reg_gen == bus->gen) && ((bus != &i2c) || (i2c_slv.regs == NULL)); }
+
+/*!\brief Start I2C slave transaction register address tracking (internal pointer unknown until transaction is confirmed)
+** \attribute inline
+** \param [in] bus - pointer to the I2C bus structure slave is connected to
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - transaction register address
+** \return true if register address phase can be skipped (internal pointer known at transaction register address)
+**/
+static inline bool __attribute__((__always_inline__)) I2C_slave_reg_begin(const I2C_BUS * bus, I2C_SLAVE * slave, const uint16_t reg_addr)
+{
+	const bool elide = (reg_addr == slave->reg_addr) && I2C_slave_reg_known(bus, slave);
+
+	slave->reg_addr = reg_addr;
+	slave->reg_gen = 0;
+	return elide;
+}
+
+/*!\brief Confirm I2C slave internal pointer after a successful transaction
+** \param [in] bus - pointer to the I2C bus structure slave is connected to
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - transaction register address
+** \param [in] bytes - number of bytes transferred
+** \return nothing
+**/
+static void I2C_slave_reg_end(const I2C_BUS * bus, I2C_SLAVE * slave, const uint16_t reg_addr, const uint16_t bytes)
+{
+	const uint32_t end = (uint32_t) reg_addr + bytes;
+	const uint32_t top = (slave->cfg.reg_size >= I2C_16B_REG) ? 0x10000UL : 0x100UL;
+
+	slave->reg_addr = (uint16_t) end;
+	slave->reg_gen = (end < top) ? bus->gen : 0;	// Device specific behavior past top of register space (wrap, stick...)
+}
+
+
+
+#if CI2C_STATS
+/*!\brief Get I2C slave statistics snapshot
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in, out] stats - pointer to statistics structure to fill
+** \return nothing
+**/
+void I2C_slave_get_stats(const I2C_SLAVE * slave, I2C_SLAVE_STATS * stats)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	*stats = slave->stats;
+	SREG = sreg;
+}
+
+/*!\brief Reset I2C slave statistics
+** \param [in, out] slave - pointer to the I2C slave structure
+** \return nothing
+**/
+void I2C_slave_reset_stats(I2C_SLAVE * slave)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	memset(&slave->stats, 0, sizeof(slave->stats));
+	SREG = sreg;
+}
+
+/*!\brief Account transaction to slave statistics
 ** \param [in, out] slave - pointer to the I2C slave structure
-** \param [in] reg_addr - register address
+** \param [in] ack - true if transaction succeeded
+** \param [in] bytes - number of data bytes of transaction
+** \param [in] start - transaction start time (us)
+** \return nothing
+**/
+static void I2C_stat_xfer(I2C_SLAVE * slave, const bool ack, const uint32_t bytes, const uint32_t start)
+{
+	const uint32_t t = (uint32_t) micros() - start;
+
+	slave->stats.xfers++;
+	if (ack)	{ slave->stats.bytes += bytes; }
+	slave->stats.time_cumul += t;
+	if (t > slave->stats.time_max)	{ slave->stats.time_max = t; }
+}
+
+/*!\brief Add event to bus events trace
+** \param [in] status - TWI status (or pseudo status)
+** \return nothing
+**/
+static void I2C_trace_add(const uint8_t status)
+{
+	I2C_TRACE_EVT * evt = &i2c_trace.evt[i2c_trace.idx];
+
+	evt->time = (uint32_t) micros();
+	evt->status = status;
+	evt->addr = i2c_st_slave ? I2C_slave_get_xfer_addr(i2c_st_slave) : 0xFF;
+
+	i2c_trace.idx = (uint8_t) ((i2c_trace.idx + 1) % CI2C_TRACE_SIZE);
+	if (i2c_trace.nb < CI2C_TRACE_SIZE)	{ i2c_trace.nb++; }
+}
+
+/*!\brief Get bus events trace snapshot (oldest event first)
+** \param [in, out] evt - pointer to events array to fill
+** \param [in] max - events array size
+** \return Number of events copied
+**/
+uint8_t I2C_trace_get(I2C_TRACE_EVT * evt, const uint8_t max)
+{
+	const uint8_t	sreg = SREG;
+	uint8_t			nb, first;
+
+	cli();
+	nb = (max < i2c_trace.nb) ? max : i2c_trace.nb;
+	first = (uint8_t) ((i2c_trace.idx + CI2C_TRACE_SIZE - nb) % CI2C_TRACE_SIZE);	// Most recent events kept
+	for (uint8_t i = 0 ; i < nb ; i++)	{ evt[i] = i2c_trace.evt[(first + i) % CI2C_TRACE_SIZE]; }
+	SREG = sreg;
+
+	return nb;
+}
+
+/*!\brief Reset bus events trace
 ** \return nothing
 **/
-static inline void __attribute__((__always_inline__)) I2C_slave_set_reg_addr(I2C_SLAVE * slave, const uint16_t reg_addr) {
-	slave->reg_addr = reg_addr; }
+void I2C_trace_reset(void)
+{
+	const uint8_t sreg = SREG;
 
+	cli();
+	i2c_trace.idx = i2c_trace.nb = 0;
+	SREG = sreg;
+}
+#endif
 
 
 /*!\brief Enable I2c module on arduino board (including pull-ups,
@@ -159,49 +661,57 @@ void I2C_reset(void)
 	TWCR = 0;
 	setRegBit(TWCR, TWEA);
 	setRegBit(TWCR, TWEN);
+	I2C_bus_forget_regs(&i2c);
 }
 
-/*!\brief Change I2C frequency
-** \param [in] speed - I2C speed in KHz (max 400KHz on avr)
-** \return Configured bus speed
+/*!\brief I2C bus recovery after failure (bus reset)
+** \return nothing
 **/
-uint16_t I2C_set_speed(const uint16_t speed)
+static void I2C_recover(void)
 {
-	i2c.cfg.speed = (I2C_SPEED) ((speed == 0) ? (uint16_t) I2C_STD : ((speed > (uint16_t) I2C_FM) ? (uint16_t) I2C_FM : speed));
-
-	clrRegBit(TWCR, TWEN);	// Ensure i2c module is disabled
-
-	// Set prescaler and clock frequency
-	clrRegBit(TWSR, TWPS0);
-	clrRegBit(TWSR, TWPS1);
-	TWBR = (((F_CPU / 1000) / i2c.cfg.speed) - 16) / 2;
-
-	I2C_reset();			// re-enable module
+	I2C_STAT_INC(resets);
+	if (TWI_STATUS == LOST_ARBTRTN)	{ I2C_STAT_INC(arb_lost); }
+	I2C_reset();
+}
 
-	return i2c.cfg.speed;
+/*!\brief I2C bus recovery after timeout (bus reset)
+** \return nothing
+**/
+static void I2C_timed_out(void)
+{
+	I2C_STAT_INC(timeouts);
+	I2C_TRACE(CI2C_TRACE_TIMEOUT);
+	I2C_recover();
 }
 
+/*!\brief Change I2C frequency
+** \param [in] speed - I2C speed in KHz (max 400KHz on avr)
+** \return Configured bus speed
+**/
+uint16_t I2C_set_speed(const uint16_t speed) {
+	return I2C_bus_set_speed(NULL, speed); }
+
 /*!\brief Change I2C ack timeout
+** \note Applies to low level functions used on their own, I2C_read / I2C_write use a deadline derived from bus speed & transfer length
 ** \param [in] timeout - I2C ack timeout (500 ms max)
 ** \return Configured timeout
 **/
-uint16_t I2C_set_timeout(const uint16_t timeout)
-{
-	static const uint16_t max_timeout = 500;
-	i2c.cfg.timeout = (timeout > max_timeout) ? max_timeout : timeout;
-	return i2c.cfg.timeout;
-}
+uint16_t I2C_set_timeout(const uint16_t timeout) {
+	return I2C_bus_set_timeout(NULL, timeout); }
+
+/*!\brief Change I2C clock stretching allowance per byte (added to transactions deadline)
+** \param [in] stretch - I2C clock stretching allowance per byte (10000 us max)
+** \return Configured clock stretching allowance
+**/
+uint16_t I2C_set_stretch(const uint16_t stretch) {
+	return I2C_bus_set_stretch(NULL, stretch); }
 
 /*!\brief Change I2C message retries (in case of failure)
 ** \param [in] retries - I2C number of retries (max of 8)
 ** \return Configured number of retries
 **/
-uint8_t I2C_set_retries(const uint8_t retries)
-{
-	static const uint16_t max_retries = 8;
-	i2c.cfg.retries = (retries > max_retries) ? max_retries : retries;
-	return i2c.cfg.retries;
-}
+uint8_t I2C_set_retries(const uint8_t retries) {
+	return I2C_bus_set_retries(NULL, retries); }
 
 /*!\brief Get I2C busy status
 ** \return true if busy
@@ -210,208 +720,1760 @@ bool I2C_is_busy(void) {
 	return i2c.busy; }
 
 
-/*!\brief This function reads or writes the provided data to/from the address specified.
- *        If anything in the write process is not successful, then it will be repeated
- *        up till 3 more times (default). If still not successful, returns NACK
-** \param [in, out] slave - pointer to the I2C slave structure to init
-** \param [in] reg_addr - register address in register map
-** \param [in] data - pointer to the first byte of a block of data to write
-** \param [in] bytes - indicates how many bytes of data to write
-** \param [in] rw - 0 = write, 1 = read operation
-** \return I2C_STATUS status of write attempt
+/*!\brief Init an I2C bus structure (default retries, timeout & clock stretching allowance)
+** \param [in, out] bus - pointer to the I2C bus structure to init
+** \param [in] ops - backend operations
+** \param [in] speed - I2C bus speed in KHz
+** \return nothing
 **/
-static I2C_STATUS I2C_comm(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const I2C_RW rw)
+void I2C_bus_init(I2C_BUS * bus, const I2C_BUS_OPS * ops, const uint16_t speed)
 {
-	uint8_t			retry = i2c.cfg.retries;
-	bool			ack = false;
-	ci2c_fct_ptr	fc = (ci2c_fct_ptr) (rw ? slave->cfg.rd : slave->cfg.wr);
+	memset(bus, 0, sizeof(I2C_BUS));
+	bus->ops = ops;
+	bus->cfg.retries = DEF_CI2C_NB_RETRIES;
+	bus->cfg.timeout = DEF_CI2C_TIMEOUT;
+	bus->cfg.stretch = DEF_CI2C_STRETCH;
+	bus->gen = 1;
+	(void) I2C_bus_set_speed(bus, speed);
+}
 
-	if (I2C_is_busy())	{ return slave->status = I2C_BUSY; }
-	i2c.busy = true;
+/*!\brief Change I2C bus frequency
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in] speed - I2C bus speed in KHz (max 400KHz)
+** \return Configured bus speed
+**/
+uint16_t I2C_bus_set_speed(I2C_BUS * bus, const uint16_t speed)
+{
+	I2C_BUS * b = I2C_BUS_SEL(bus);
 
-	ack = fc(slave, reg_addr, data, bytes);
-	while ((!ack) && (retry != 0))	// If com not successful, retry some more times
-	{
-		delay(1);
-		ack = fc(slave, reg_addr, data, bytes);
-		retry--;
-	}
+	b->cfg.speed = (I2C_SPEED) ((speed == 0) ? (uint16_t) I2C_STD : ((speed > (uint16_t) I2C_FM) ? (uint16_t) I2C_FM : speed));
+	b->cfg.speed = (I2C_SPEED) b->ops->set_speed(b, b->cfg.speed);
+	b->clk = b->cfg.speed;
+	b->byte_us = (9 * 1000U) / b->cfg.speed;
 
-	i2c.busy = false;
-	return slave->status = ack ? I2C_OK : I2C_NACK;
+	return b->cfg.speed;
 }
 
-/*!\brief This function writes the provided data to the address specified.
-** \param [in, out] slave - pointer to the I2C slave structure
-** \param [in] reg_addr - register address in register map
-** \param [in] data - pointer to the first byte of a block of data to write
-** \param [in] bytes - indicates how many bytes of data to write
-** \return I2C_STATUS status of write attempt
+/*!\brief Change I2C bus ack timeout (low level functions used on their own)
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in] timeout - I2C ack timeout (500 ms max)
+** \return Configured timeout
 **/
-I2C_STATUS I2C_write(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes) {
-	return I2C_comm(slave, reg_addr, data, bytes, I2C_WRITE); }
+uint16_t I2C_bus_set_timeout(I2C_BUS * bus, const uint16_t timeout)
+{
+	static const uint16_t	max_timeout = 500;
+	I2C_BUS *				b = I2C_BUS_SEL(bus);
 
-/*!\brief This function reads data from the address specified and stores this
- *        data in the area provided by the pointer.
-** \param [in, out] slave - pointer to the I2C slave structure
-** \param [in] reg_addr - register address in register map
-** \param [in, out] data - pointer to the first byte of a block of data to read
-** \param [in] bytes - indicates how many bytes of data to read
-** \return I2C_STATUS status of read attempt
+	b->cfg.timeout = (timeout > max_timeout) ? max_timeout : timeout;
+	return b->cfg.timeout;
+}
+
+/*!\brief Change I2C bus clock stretching allowance per byte (added to transactions deadline)
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in] stretch - I2C clock stretching allowance per byte (10000 us max)
+** \return Configured clock stretching allowance
 **/
-I2C_STATUS I2C_read(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes) {
-	return I2C_comm(slave, reg_addr, data, bytes, I2C_READ); }
+uint16_t I2C_bus_set_stretch(I2C_BUS * bus, const uint16_t stretch)
+{
+	static const uint16_t	max_stretch = 10000;
+	I2C_BUS *				b = I2C_BUS_SEL(bus);
+
+	b->cfg.stretch = (stretch > max_stretch) ? max_stretch : stretch;
+	return b->cfg.stretch;
+}
 
+/*!\brief Change I2C bus message retries (in case of failure)
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in] retries - I2C number of retries (max of 8)
+** \return Configured number of retries
+**/
+uint8_t I2C_bus_set_retries(I2C_BUS * bus, const uint8_t retries)
+{
+	static const uint16_t	max_retries = 8;
+	I2C_BUS *				b = I2C_BUS_SEL(bus);
 
-/*!\brief Start i2c_timeout timer
-** \attribute inline
-** \return nothing
+	b->cfg.retries = (retries > max_retries) ? max_retries : retries;
+	return b->cfg.retries;
+}
+
+/*!\brief Get I2C bus busy status
+** \param [in] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \return true if busy
 **/
-static inline void __attribute__((__always_inline__)) I2C_start_timeout(void) {
-	i2c.start_wait = (uint16_t) millis(); }
+bool I2C_bus_is_busy(const I2C_BUS * bus) {
+	return bus ? bus->busy : i2c.busy; }
 
-/*!\brief Test i2c_timeout
-** \attribute inline
-** \return true if i2c_timeout occured (false otherwise)
+/*!\brief Set bus slaves are attached to by I2C_slave_init (drivers kept unchanged when default bus is not hardware TWI)
+** \param [in] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \return nothing
 **/
-static inline uint8_t __attribute__((__always_inline__)) I2C_timeout(void) {
-	return (((uint16_t) millis() - i2c.start_wait) >= i2c.cfg.timeout); }
+void I2C_set_default_bus(I2C_BUS * bus) {
+	i2c_def_bus = (bus == &i2c) ? NULL : bus; }
 
-/*!\brief Send start condition
-** \return true if start condition acknowledged (false otherwise)
+/*!\brief Forget internal pointers of all slaves on I2C bus (new bus generation, register address sent on next transaction of each slave)
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \return nothing
 **/
-bool I2C_start(void)
+void I2C_bus_forget_regs(I2C_BUS * bus)
 {
-	I2C_start_timeout();
+	I2C_BUS * b = I2C_BUS_SEL(bus);
 
-	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
+	if (++b->gen == 0)	{ b->gen = 1; }	// 0 kept for unknown slave pointer
+}
 
-	while (!(TWCR & (1 << TWINT)))
-	{ if (I2C_timeout())	{ I2C_reset(); return false; } }
+/*!\brief Test if I2C slave internal pointer is known (register address phase skipped when accessing I2C_slave_get_reg_addr)
+** \param [in] slave - pointer to the I2C slave structure
+** \return true if known
+**/
+bool I2C_slave_reg_addr_known(const I2C_SLAVE * slave) {
+	return I2C_slave_reg_known(I2C_BUS_SEL(slave->cfg.bus), slave); }
 
-	if ((TWI_STATUS == START) || (TWI_STATUS == REPEATED_START))	{ return true; }
-	if (TWI_STATUS == LOST_ARBTRTN)									{ I2C_reset(); }
+/*!\brief Take I2C bus ownership (atomic test and set of busy flag)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return true if bus acquired (false if already owned)
+**/
+static bool I2C_acquire(I2C_BUS * bus)
+{
+	const uint8_t	sreg = SREG;
+	bool			acq = false;
 
-	return false;
+	cli();
+	if ((!bus->busy) && ((bus != &i2c) || (!i2c_slv.active)))	{ bus->busy = acq = true; }
+	SREG = sreg;
+
+	return acq;
 }
 
-/*!\brief Send stop condition
-** \return true if stop condition acknowledged (false otherwise)
+/*!\brief Release I2C bus ownership
+** \attribute inline
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return nothing
 **/
-bool I2C_stop(void)
+static inline void __attribute__((__always_inline__)) I2C_release(I2C_BUS * bus)
 {
-	I2C_start_timeout();
+	bus->busy = false;
+	if ((bus == &i2c) && (i2c_slv.regs))	{ TWCR = (1 << TWEN) | (1 << TWEA) | (1 << TWIE); }	// Addressable again
+}
+
+
+/*!\brief Clock bus at slave speed (bus speed if slave has no speed profile), only when speed differs from previous transaction
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] slave - pointer to the I2C slave structure (NULL for bus speed)
+** \return nothing
+**/
+static void I2C_apply_speed(I2C_BUS * bus, const I2C_SLAVE * slave)
+{
+	const bool		own = (slave != NULL) && (slave->cfg.speed != 0);
+	const uint16_t	speed = own ? I2C_slave_get_speed(slave) : (uint16_t) bus->cfg.speed;
+
+	if (speed == bus->clk)	{ return; }
+
+	bus->clk = speed;
+	bus->byte_us = (9 * 1000U) / speed;
+
+	if (bus == &i2c)	// Precomputed registers (bus idle, no need to disable module)
+	{
+		TWBR = own ? slave->twbr : i2c_clk.twbr;
+		TWSR = (uint8_t) ((TWSR & 0xF8) | (own ? slave->twps : i2c_clk.twps));
+	}
+	else	{ (void) bus->ops->set_speed(bus, speed); }
+}
+
+/*!\brief Arm transaction deadline (whole transaction budget derived from bus speed & transfer length)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] bytes - number of data bytes to transfer
+** \return nothing
+**/
+static void I2C_arm_deadline(I2C_BUS * bus, const uint16_t bytes)
+{
+	bus->start_wait = (uint32_t) micros();
+	bus->budget = ((uint32_t) bytes + CI2C_XFER_OVERHEAD) * ((2 * bus->byte_us) + bus->cfg.stretch);
+	bus->xfer = true;
+}
+
+/*!\brief Prepare next attempt of a failed transaction on a bus (delay, then transaction deadline re-armed)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] bytes - number of data bytes of transaction (deadline computation)
+** \return true if transaction has to be retried (false if no retries left)
+**/
+static bool I2C_bus_retry(I2C_BUS * bus, const uint16_t bytes)
+{
+	if (bus->retry == 0)	{ return false; }
+
+	bus->retry--;
+	delay(CI2C_RETRY_DELAY);
+	I2C_STAT_INC(retries);
+	I2C_arm_deadline(bus, bytes);
+	return true;
+}
+
+/*!\brief Take hardware TWI ownership for a transaction made of low level functions (transaction deadline armed)
+** \param [in] bytes - number of data bytes of transaction (deadline computation)
+** \return true if bus acquired (false if already owned)
+**/
+bool I2C_xfer_begin(const uint16_t bytes)
+{
+	if (!I2C_acquire(&i2c))	{ return false; }
+
+	I2C_bus_forget_regs(&i2c);	// Slaves internal pointers may be moved by custom transaction
+	I2C_apply_speed(&i2c, NULL);
+#if CI2C_STATS
+	i2c_st_slave = NULL;
+#endif
+	i2c.retry = i2c.cfg.retries;
+	I2C_arm_deadline(&i2c, bytes);
+	return true;
+}
+
+/*!\brief Prepare next attempt of a failed transaction (delay, then transaction deadline re-armed)
+** \param [in] bytes - number of data bytes of transaction (deadline computation)
+** \return true if transaction has to be retried (false if no retries left)
+**/
+bool I2C_xfer_retry(const uint16_t bytes) {
+	return I2C_bus_retry(&i2c, bytes); }
+
+/*!\brief End of transaction made of low level functions (release hardware TWI ownership)
+** \return nothing
+**/
+void I2C_xfer_end(void)
+{
+	i2c.xfer = false;
+	I2C_release(&i2c);
+}
+
+/*!\brief Plan mux control register writes selecting slave channel (planned muxes selection unknown until written)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] slave - pointer to the I2C slave structure
+** \param [out] ctl - writes to perform (2 max: channels of mux previously used on bus disabled, then slave channel selected)
+** \return number of writes (0 if slave channel already selected or slave directly on bus)
+**/
+static uint8_t I2C_mux_plan(I2C_BUS * bus, const I2C_SLAVE * slave, I2C_MUX_WR * ctl)
+{
+#if CI2C_MUX
+	I2C_MUX * const	mux = slave->cfg.mux;
+	const uint8_t	sel = (uint8_t) (1 << slave->cfg.chan);
+	uint8_t			nb = 0;
+
+	if (mux == NULL)									{ return 0; }
+	if ((mux->gen == bus->gen) && (mux->sel == sel))	{ return 0; }	// Channel already selected
+
+	if ((bus->mux) && (bus->mux != mux))	// Same addresses may sit behind previous mux channels
+	{
+		ctl[nb].mux = bus->mux;
+		ctl[nb++].sel = 0;
+		I2C_mux_forget(bus->mux);
+	}
+
+	ctl[nb].mux = mux;
+	ctl[nb++].sel = sel;
+	I2C_mux_forget(mux);
+
+	return nb;
+#else
+	(void) bus;
+	(void) slave;
+	(void) ctl;
+	return 0;
+#endif
+}
+
+/*!\brief Mux control register written (selection known in current bus generation)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] ctl - pointer to the control register write performed
+** \return nothing
+**/
+static void I2C_mux_done(I2C_BUS * bus, const I2C_MUX_WR * ctl)
+{
+	I2C_MUX * const mux = ctl->mux;
+
+	mux->sel = ctl->sel;
+	mux->gen = bus->gen;
+	mux->writes++;
+
+	if (mux->sel != 0)			{ bus->mux = mux; }
+	else if (bus->mux == mux)	{ bus->mux = NULL; }
+}
+
+/*!\brief Select slave mux channel, control registers written only when selection changed (STOP after each, channels switched on STOP)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] slave - pointer to the I2C slave structure
+** \return true if slave channel selected
+**/
+static bool I2C_mux_select(I2C_BUS * bus, const I2C_SLAVE * slave)
+{
+	I2C_MUX_WR		ctl[2];
+	I2C_MSG			msgs[2];
+	const uint8_t	nb = I2C_mux_plan(bus, slave, ctl);
+
+	if (nb == 0)	{ return true; }
+
+	for (uint8_t i = 0 ; i < nb ; i++)
+	{
+		msgs[i].addr = ctl[i].mux->addr;
+		msgs[i].flags = I2C_MSG_STOP;
+		msgs[i].len = 1;
+		msgs[i].data = &ctl[i].sel;
+	}
+	if (I2C_msgs(bus, msgs, nb) == false)	{ return false; }
+
+	for (uint8_t i = 0 ; i < nb ; i++)	{ I2C_mux_done(bus, &ctl[i]); }
+	return true;
+}
+
+/*!\brief Perform a transaction, retried in case of failure
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] fc - read/write function
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read/write
+** \param [in] bytes - indicates how many bytes of data to read/write
+** \param [in] retries - number of retries in case of failure
+** \return true if transaction succeeded
+**/
+static bool I2C_retry(I2C_BUS * bus, const ci2c_fct_ptr fc, I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const uint8_t retries)
+{
+	bool ack;
+
+	bus->retry = retries;
+	I2C_arm_deadline(bus, bytes);
+	do	{ ack = ((I2C_slave_get_mux(slave) == NULL) || I2C_mux_select(bus, slave)) && fc(slave, reg_addr, data, bytes); }
+	while ((!ack) && (I2C_bus_retry(bus, bytes)));	// If com not successful, retry some more times
+	bus->xfer = false;
+
+	return ack;
+}
+
+/*!\brief Address only transaction (START, address write, STOP)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] addr - 7 bits slave address
+** \return true if address acknowledged
+**/
+static bool I2C_probe(I2C_BUS * bus, const uint8_t addr)
+{
+	if (bus->ops->xfer)
+	{
+		const I2C_MSG msg = { addr, 0, 0, NULL };
+		return bus->ops->xfer(bus, &msg, 1);
+	}
+
+	if (bus->ops->start(bus) == false)										{ return false; }
+	if (bus->ops->sndSla(bus, (uint8_t) ((addr << 1) | I2C_WRITE)) == false)	{ return false; }	// NACK already sends stop
+	return bus->ops->stop(bus);
+}
+
+/*!\brief Acknowledge polling (address only write attempts until slave answers, to wait for end of memory write cycle)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] slave - pointer to the I2C slave structure
+** \return true if slave acknowledged before timeout
+**/
+static bool I2C_ack_poll(I2C_BUS * bus, I2C_SLAVE * slave)
+{
+	const uint16_t start = (uint16_t) millis();
+
+	do
+	{
+		if (I2C_probe(bus, I2C_slave_get_xfer_addr(slave)))	{ return true; }
+	} while (((uint16_t) millis() - start) < bus->cfg.timeout);
+
+	return false;
+}
+
+/*!\brief Write to a paged memory device: transaction split at page boundaries, each page followed by acknowledge polling
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] fc - write function
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write (or vectored transfer descriptor)
+** \param [in] bytes - indicates how many bytes of data to write
+** \param [in] retries - number of retries of each page in case of failure
+** \param [in] vectored - true if \b data is a vectored transfer descriptor (given unchanged, segments located from register address)
+** \return true if all pages written
+**/
+static bool I2C_wr_pages(I2C_BUS * bus, const ci2c_fct_ptr fc, I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const uint8_t retries, const bool vectored)
+{
+	const uint16_t	mask = slave->cfg.page_size - 1;
+	uint16_t		addr = reg_addr;
+	uint16_t		left = bytes;
+
+	while (left != 0)
+	{
+		const uint16_t	in_page = slave->cfg.page_size - (addr & mask);
+		const uint16_t	nb = (left < in_page) ? left : in_page;
+
+		if (I2C_retry(bus, fc, slave, addr, data, nb, retries) == false)	{ return false; }
+
+		// Device internal pointer rolls over to page start when last byte of page is written
+		if (nb == in_page)	{ I2C_slave_reg_end(bus, slave, addr & ~mask, 0); }
+
+		if (I2C_ack_poll(bus, slave) == false)					{ return false; }
+
+		addr += nb;
+		left -= nb;
+		if (!vectored)	{ data += nb; }
+	}
+
+	return true;
+}
+
+/*!\brief This function reads or writes the provided data to/from the address specified.
+ *        If anything in the write process is not successful, then it will be repeated
+ *        up till 3 more times (default). If still not successful, returns NACK
+ *        Writes to paged memory devices are split at page boundaries (and followed by acknowledge polling)
+** \param [in, out] slave - pointer to the I2C slave structure to init
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \param [in] rw - 0 = write, 1 = read operation
+** \param [in] fc - transaction function
+** \param [in] vectored - true if \b data is a vectored transfer descriptor (not advanced between pages)
+** \return I2C_STATUS status of write attempt
+**/
+static I2C_STATUS I2C_comm(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const I2C_RW rw, const ci2c_fct_ptr fc, const bool vectored)
+{
+	I2C_BUS *		bus = I2C_BUS_SEL(slave->cfg.bus);
+	bool			ack = false;
+	uint8_t			retries;
+
+	if (!I2C_slave_gate(slave, bus->cfg.retries, &retries))	{ return slave->status = I2C_NACK; }	// Circuit breaker open
+	if (!I2C_acquire(bus))									{ return slave->status = I2C_BUSY; }
+
+	I2C_apply_speed(bus, slave);
+
+#if CI2C_STATS
+	const uint32_t start = (uint32_t) micros();
+	i2c_st_slave = slave;
+#endif
+
+	if ((rw == I2C_WRITE) && (slave->cfg.page_size))	{ ack = I2C_wr_pages(bus, fc, slave, reg_addr, data, bytes, retries, vectored); }
+	else												{ ack = I2C_retry(bus, fc, slave, reg_addr, data, bytes, retries); }
+
+#if CI2C_STATS
+	I2C_stat_xfer(slave, ack, bytes, start);
+#endif
+
+	I2C_slave_speed_track(slave, ack);
+	I2C_slave_breaker_track(slave, ack);
+	I2C_release(bus);
+	return slave->status = ack ? I2C_OK : I2C_NACK;
+}
+
+/*!\brief This function writes the provided data to the address specified.
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt
+**/
+I2C_STATUS I2C_write(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes) {
+	return I2C_comm(slave, reg_addr, data, bytes, I2C_WRITE, (ci2c_fct_ptr) slave->cfg.wr, false); }
+
+/*!\brief This function reads data from the address specified and stores this
+ *        data in the area provided by the pointer.
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt
+**/
+I2C_STATUS I2C_read(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes) {
+	return I2C_comm(slave, reg_addr, data, bytes, I2C_READ, (ci2c_fct_ptr) slave->cfg.rd, false); }
+
+/*!\brief Vectored transfer: segments transferred back to back in a single transaction (single address phase, no copy)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] segs - pointer to the first segment
+** \param [in] nb - number of segments
+** \param [in] rw - 0 = write, 1 = read operation
+** \return I2C_STATUS status of transfer attempt
+**/
+static I2C_STATUS I2C_comm_vec(I2C_SLAVE * slave, const uint16_t reg_addr, const I2C_SEG * segs, const uint8_t nb, const I2C_RW rw)
+{
+	const I2C_VEC	vec = { segs, reg_addr };
+	uint32_t		bytes = 0;
+	uint8_t			used = 0;
+
+	for (uint8_t i = 0 ; i < nb ; i++)	{ bytes += segs[i].len; used += (segs[i].len != 0); }
+	if ((bytes == 0) || (bytes > 0xFFFF))	{ return slave->status = I2C_NACK; }
+	if ((used > CI2C_XFER_SEGS) && (I2C_BUS_SEL(slave->cfg.bus)->ops->xfer))	{ return slave->status = I2C_NACK; }	// Messages array of I2C_xfer_segs
+
+	return I2C_comm(slave, reg_addr, (uint8_t *) &vec, (uint16_t) bytes, rw, rw ? (ci2c_fct_ptr) I2C_rdv : (ci2c_fct_ptr) I2C_wrv, true);
+}
+
+/*!\brief This function writes segments to the address specified, in a single transaction (segments sent back to back)
+** \note Same retries, circuit breaker, speed & paging handling as I2C_write (custom write function not used)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] segs - pointer to the first segment
+** \param [in] nb - number of segments (empty segments skipped)
+** \return I2C_STATUS status of write attempt (I2C_NACK if segments are empty, exceed 65535 bytes or CI2C_XFER_SEGS non empty segments on message level buses)
+**/
+I2C_STATUS I2C_writev(I2C_SLAVE * slave, const uint16_t reg_addr, const I2C_SEG * segs, const uint8_t nb) {
+	return I2C_comm_vec(slave, reg_addr, segs, nb, I2C_WRITE); }
+
+/*!\brief This function reads data from the address specified into segments, in a single transaction (segments filled back to back)
+** \note Same retries, circuit breaker & speed handling as I2C_read (custom read function not used)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] segs - pointer to the first segment
+** \param [in] nb - number of segments (empty segments skipped)
+** \return I2C_STATUS status of read attempt (I2C_NACK if segments are empty, exceed 65535 bytes or CI2C_XFER_SEGS non empty segments on message level buses)
+**/
+I2C_STATUS I2C_readv(I2C_SLAVE * slave, const uint16_t reg_addr, const I2C_SEG * segs, const uint8_t nb) {
+	return I2C_comm_vec(slave, reg_addr, segs, nb, I2C_READ); }
+
+/*!\brief Large memory transfer: split at block boundaries, block accessed set in slave address of transactions
+** \details Internal pointer tracked across blocks: a read ending at top of a block leaves it at start of next block
+**			 (next block read on from its start without register address phase).
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] mem_addr - memory address
+** \param [in, out] data - pointer to the first byte of a block of data to read/write
+** \param [in] bytes - indicates how many bytes of data to read/write
+** \param [in] rw - 0 = write, 1 = read operation
+** \return I2C_STATUS status of transfer
+**/
+static I2C_STATUS I2C_comm_mem(I2C_SLAVE * slave, const uint32_t mem_addr, uint8_t * data, const uint32_t bytes, const I2C_RW rw)
+{
+	const uint8_t	bits = 8 * slave->cfg.reg_size;	// Block register address bits
+	const uint32_t	size = I2C_slave_get_mem_size(slave);
+	uint32_t		addr = mem_addr;
+	uint32_t		left = bytes;
+
+	if ((bits == 0) || (bytes == 0) || (mem_addr >= size) || (bytes > (size - mem_addr)))	{ return slave->status = I2C_NACK; }
+
+	while (left != 0)
+	{
+		const uint8_t	blk = (uint8_t) (addr >> bits);
+		const uint32_t	top = (uint32_t) (blk + 1) << bits;
+		const uint16_t	reg = (uint16_t) (addr & ((1UL << bits) - 1));	// Address in block
+		uint32_t		nb = ((top - addr) < left) ? (top - addr) : left;
+		I2C_STATUS		st;
+
+		if (nb > 0x8000)			{ nb = 0x8000; }	// 64KB blocks in two transactions
+		if (blk != slave->blk)		{ slave->blk = blk; I2C_slave_forget_reg_addr(slave); }	// Internal pointer of another block
+
+		st = rw ? I2C_read(slave, reg, data, (uint16_t) nb) : I2C_write(slave, reg, data, (uint16_t) nb);
+		if (st != I2C_OK)	{ return st; }
+
+		addr += nb;
+		data += nb;
+		left -= nb;
+
+		// Read confirmed up to block top: device pointer wrapped to block start, next block read on from there once selected by address
+		if ((rw == I2C_READ) && (addr == top))
+		{
+			slave->blk = (uint8_t) ((blk + 1) & ((1 << slave->cfg.blk_bits) - 1));
+			slave->reg_addr = 0;
+			slave->reg_gen = (addr < size) ? I2C_BUS_SEL(slave->cfg.bus)->gen : 0;	// Top of memory: next access from memory start
+		}
+	}
+
+	return I2C_OK;
+}
+
+/*!\brief This function writes the provided data to the large memory address specified (I2C_slave_set_blocks)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] mem_addr - memory address
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt (I2C_NACK if bytes is 0 or exceeds memory size)
+**/
+I2C_STATUS I2C_write_mem(I2C_SLAVE * slave, const uint32_t mem_addr, uint8_t * data, const uint32_t bytes) {
+	return I2C_comm_mem(slave, mem_addr, data, bytes, I2C_WRITE); }
+
+/*!\brief This function reads data from the large memory address specified (I2C_slave_set_blocks)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] mem_addr - memory address
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt (I2C_NACK if bytes is 0 or exceeds memory size)
+**/
+I2C_STATUS I2C_read_mem(I2C_SLAVE * slave, const uint32_t mem_addr, uint8_t * data, const uint32_t bytes) {
+	return I2C_comm_mem(slave, mem_addr, data, bytes, I2C_READ); }
+
+/*!\brief Source / sink transfer: single transaction retried from the chunk that failed,
+**			writes to paged memory devices split in a transaction per chunk within a page (each followed by acknowledge polling)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in, out] ck - pointer to the transfer descriptor
+** \param [in] rw - 0 = write, 1 = read operation
+** \return I2C_STATUS status of transfer
+**/
+static I2C_STATUS I2C_comm_chunks(I2C_SLAVE * slave, I2C_CHUNKS * ck, const I2C_RW rw)
+{
+	I2C_BUS *		bus = I2C_BUS_SEL(slave->cfg.bus);
+	const uint16_t	page = slave->cfg.page_size;
+	bool			ack = true;
+	uint8_t			retries;
+
+	if (ck->bytes == 0)										{ return slave->status = I2C_NACK; }
+	if (!I2C_slave_gate(slave, bus->cfg.retries, &retries))	{ return slave->status = I2C_NACK; }	// Circuit breaker open
+	if (!I2C_acquire(bus))									{ return slave->status = I2C_BUSY; }
+
+	I2C_apply_speed(bus, slave);
+
+#if CI2C_STATS
+	const uint32_t start = (uint32_t) micros();
+	i2c_st_slave = slave;
+#endif
+
+	if ((rw == I2C_WRITE) && (page))
+	{
+		while ((ack) && (ck->done < ck->bytes))
+		{
+			const uint16_t	addr = (uint16_t) (ck->base + ck->done);
+			const uint16_t	in_page = page - (addr & (page - 1));
+			uint32_t		nb = ck->bytes - ck->done;
+
+			if (nb > CI2C_CHUNK_SIZE)	{ nb = CI2C_CHUNK_SIZE; }
+			if (nb > in_page)			{ nb = in_page; }
+			ck->end = ck->done + nb;
+
+			ack = I2C_retry(bus, (ci2c_fct_ptr) I2C_wr_src, slave, addr, (uint8_t *) ck, (uint16_t) nb, retries);
+
+			// Device internal pointer rolls over to page start when last byte of page is written
+			if ((ack) && (nb == in_page))	{ I2C_slave_reg_end(bus, slave, addr & ~(page - 1), 0); }
+			if (ack)						{ ack = I2C_ack_poll(bus, slave); }
+		}
+	}
+	else
+	{
+		ck->end = ck->bytes;
+		ack = I2C_retry(bus, rw ? (ci2c_fct_ptr) I2C_rd_sink : (ci2c_fct_ptr) I2C_wr_src, slave, ck->base, (uint8_t *) ck,
+						(ck->bytes < CI2C_CHUNK_SIZE) ? (uint16_t) ck->bytes : CI2C_CHUNK_SIZE, retries);	// Deadline re-armed for each chunk
+	}
+
+#if CI2C_STATS
+	I2C_stat_xfer(slave, ack, ck->done, start);
+#endif
+
+	I2C_slave_speed_track(slave, ack);
+	I2C_slave_breaker_track(slave, ack);
+	I2C_release(bus);
+	return slave->status = ack ? I2C_OK : I2C_NACK;
+}
+
+/*!\brief This function writes data pulled from a source to the address specified, by chunks in a single transaction (constant RAM)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] bytes - number of bytes to write
+** \param [in] src - source function, filling chunk buffer with exactly the number of bytes asked (false to abort, no retries then)
+** \param [in] ctx - context given to source function
+** \return I2C_STATUS status of write attempt (I2C_NACK if bytes is 0 or transfer aborted)
+**/
+I2C_STATUS I2C_write_src(I2C_SLAVE * slave, const uint16_t reg_addr, const uint32_t bytes, const ci2c_src_fct_ptr src, void * ctx)
+{
+	I2C_CHUNKS ck = { { .src = src }, ctx, reg_addr, bytes, 0, 0, 0, { 0 } };
+	return I2C_comm_chunks(slave, &ck, I2C_WRITE);
+}
+
+/*!\brief This function reads data from the address specified into a sink, by chunks in a single transaction (constant RAM)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] bytes - number of bytes to read
+** \param [in] sink - sink function (false to abort, no retries then)
+** \param [in] ctx - context given to sink function
+** \return I2C_STATUS status of read attempt (I2C_NACK if bytes is 0 or transfer aborted)
+**/
+I2C_STATUS I2C_read_sink(I2C_SLAVE * slave, const uint16_t reg_addr, const uint32_t bytes, const ci2c_sink_fct_ptr sink, void * ctx)
+{
+	I2C_CHUNKS ck = { { .sink = sink }, ctx, reg_addr, bytes, 0, 0, 0, { 0 } };
+	return I2C_comm_chunks(slave, &ck, I2C_READ);
+}
+
+/*!\brief This function copies data from a slave to another one (or within a slave), by chunks through a CI2C_CHUNK_SIZE bytes buffer
+** \param [in, out] dst - pointer to the destination I2C slave structure
+** \param [in] dst_addr - destination register address
+** \param [in, out] src - pointer to the source I2C slave structure
+** \param [in] src_addr - source register address
+** \param [in] bytes - number of bytes to copy
+** \return I2C_STATUS status of first failed chunk transaction (I2C_NACK if bytes is 0)
+**/
+I2C_STATUS I2C_copy(I2C_SLAVE * dst, const uint16_t dst_addr, I2C_SLAVE * src, const uint16_t src_addr, const uint32_t bytes)
+{
+	uint8_t		buf[CI2C_CHUNK_SIZE];
+	uint32_t	done = 0;
+
+	if (bytes == 0)	{ return I2C_NACK; }
+
+	while (done < bytes)
+	{
+		const uint16_t	addr = (uint16_t) (dst_addr + done);
+		const uint16_t	page = dst->cfg.page_size;
+		uint16_t		nb = ((bytes - done) < CI2C_CHUNK_SIZE) ? (uint16_t) (bytes - done) : CI2C_CHUNK_SIZE;
+		I2C_STATUS		st;
+
+		if ((page) && (nb > (page - (addr & (page - 1)))))	{ nb = page - (addr & (page - 1)); }	// Single page written per chunk
+
+		if ((st = I2C_read(src, (uint16_t) (src_addr + done), buf, nb)) != I2C_OK)	{ return st; }
+		if ((st = I2C_write(dst, addr, buf, nb)) != I2C_OK)							{ return st; }
+		done += nb;
+	}
+
+	return I2C_OK;
+}
+
+/*!\brief Probe I2C slave presence (address only transaction, no retries), circuit breaker closed if acknowledged
+** \param [in, out] slave - pointer to the I2C slave structure
+** \return I2C_STATUS status of probe (I2C_OK if present, I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_slave_probe(I2C_SLAVE * slave)
+{
+	I2C_BUS *	bus = I2C_BUS_SEL(slave->cfg.bus);
+	bool		ack;
+
+	if (!I2C_acquire(bus))	{ return I2C_BUSY; }
+
+	I2C_apply_speed(bus, slave);
+#if CI2C_STATS
+	i2c_st_slave = slave;
+#endif
+	I2C_arm_deadline(bus, 0);
+	ack = I2C_mux_select(bus, slave) && I2C_probe(bus, I2C_slave_get_xfer_addr(slave));
+	bus->xfer = false;
+	I2C_release(bus);
+
+#if CI2C_BREAKER
+	if (ack)							{ slave->brk_cnt = 0; }
+	else if (I2C_slave_is_broken(slave))	{ slave->brk_time = (uint16_t) millis(); }	// Next half-open attempt postponed
+#endif
+
+	return ack ? I2C_OK : I2C_NACK;
+}
+
+/*!\brief Scan I2C bus: address only transaction (no retries) to each address from CI2C_SCAN_FIRST to CI2C_SCAN_LAST
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in, out] map - presence bitmap to fill (CI2C_SCAN_MAP_SIZE bytes, bit set for each acknowledged address)
+** \return I2C_STATUS status of scan (I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_scan(I2C_BUS * bus, uint8_t * map)
+{
+	I2C_BUS * b = I2C_BUS_SEL(bus);
+
+	memset(map, 0, CI2C_SCAN_MAP_SIZE);
+	if (!I2C_acquire(b))	{ return I2C_BUSY; }
+
+	I2C_apply_speed(b, NULL);
+#if CI2C_STATS
+	i2c_st_slave = NULL;
+#endif
+	for (uint8_t addr = CI2C_SCAN_FIRST ; addr <= CI2C_SCAN_LAST ; addr++)
+	{
+		I2C_arm_deadline(b, 0);		// Stuck bus doesn't cost low level functions timeout on each address
+		if (I2C_probe(b, addr))		{ map[addr >> 3] |= (uint8_t) (1 << (addr & 0x07)); }
+	}
+	b->xfer = false;
+	I2C_release(b);
+
+	return I2C_OK;
+}
+
+/*!\brief Combined transfer attempt: messages chained with repeated STARTs, single STOP at the end
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in, out] msgs - pointer to the first message
+** \param [in] nb - number of messages
+** \return true if all messages transferred
+**/
+static bool I2C_msgs(I2C_BUS * bus, const I2C_MSG * msgs, const uint8_t nb)
+{
+	const I2C_BUS_OPS * const ops = bus->ops;
+
+	bus->nack = false;
+	if (ops->xfer)	{ return ops->xfer(bus, msgs, nb); }
+
+	for (const I2C_MSG * msg = msgs ; msg != &msgs[nb] ; msg++)
+	{
+		const I2C_RW	rw = (msg->flags & I2C_MSG_RD) ? I2C_READ : I2C_WRITE;
+		const bool		cont = (msg != &msgs[nb - 1]) && (msg[1].flags & I2C_MSG_NOSTART);	// Data phase continued by next message
+		bool			ok = true;
+
+		bus->nack = false;
+		if (!(msg->flags & I2C_MSG_NOSTART))	{ ok = ops->start(bus) && ops->sndSla(bus, (uint8_t) ((msg->addr << 1) | rw)); }
+		if (ok && (msg->len != 0))
+		{
+			if (rw == I2C_READ)	{ ok = I2C_bus_rd(bus, msg->data, msg->len, !cont); }	// Last byte not acknowledged before next (repeated) START
+			else				{ ok = I2C_bus_wr(bus, msg->data, msg->len); }
+		}
+
+		if (!ok)
+		{
+			if (bus->nack && (msg->flags & I2C_MSG_IGNORE_NACK))	// Stop condition already sent, continuation messages dropped
+			{
+				while ((msg != &msgs[nb - 1]) && (msg[1].flags & I2C_MSG_NOSTART))	{ msg++; }
+				continue;
+			}
+			return false;
+		}
+
+		if ((!cont) && ((msg->flags & I2C_MSG_STOP) || (msg == &msgs[nb - 1])))
+		{
+			if (ops->stop(bus) == false)	{ return false; }
+		}
+	}
+
+	return true;
+}
+
+/*!\brief Combined transfer: messages chained with repeated STARTs under a single bus ownership, single STOP at the end
+** \note Whole list retried in case of failure (bus retries); slaves internal pointers on bus are forgotten
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in, out] msgs - pointer to the first message
+** \param [in] nb - number of messages
+** \return I2C_STATUS status of transfer (I2C_BUSY if bus already owned, I2C_NACK on failure or invalid messages)
+**/
+I2C_STATUS I2C_transfer(I2C_BUS * bus, const I2C_MSG * msgs, const uint8_t nb)
+{
+	I2C_BUS *	b = I2C_BUS_SEL(bus);
+	uint32_t	bytes = nb;		// Address bytes
+	bool		ack;
+
+	for (uint8_t i = 0 ; i < nb ; i++)
+	{
+		if ((msgs[i].len == 0) && (msgs[i].flags & I2C_MSG_RD))	{ return I2C_NACK; }
+		if ((msgs[i].flags & I2C_MSG_NOSTART) && ((i == 0) || ((msgs[i].flags ^ msgs[i - 1].flags) & I2C_MSG_RD)))	{ return I2C_NACK; }	// Continues a message of same direction
+		bytes += msgs[i].len;
+	}
+	if ((nb == 0) || (bytes > 0xFFFF))	{ return I2C_NACK; }
+	if (!I2C_acquire(b))				{ return I2C_BUSY; }
+
+	I2C_bus_forget_regs(b);		// Slaves internal pointers may be moved by messages
+	I2C_apply_speed(b, NULL);
+#if CI2C_STATS
+	i2c_st_slave = NULL;
+#endif
+	b->retry = b->cfg.retries;
+	I2C_arm_deadline(b, (uint16_t) bytes);
+	do	{ ack = I2C_msgs(b, msgs, nb); }
+	while ((!ack) && (I2C_bus_retry(b, (uint16_t) bytes)));
+	b->xfer = false;
+	I2C_release(b);
+
+	return ack ? I2C_OK : I2C_NACK;
+}
+
+/*!\brief Init an I2C mux structure (selection unknown, written on first access to one of its slaves)
+** \param [in, out] mux - pointer to the I2C mux structure to init
+** \param [in] bus - pointer to the upstream I2C bus structure (NULL for hardware TWI)
+** \param [in] addr - 7 bits mux address
+** \return true if initialized (false if address is >7Fh)
+**/
+bool I2C_mux_init(I2C_MUX * mux, I2C_BUS * bus, const uint8_t addr)
+{
+	if (addr > 0x7F)	{ return false; }
+
+	mux->bus = (bus == &i2c) ? NULL : bus;
+	mux->addr = addr;
+	mux->sel = 0;
+	mux->writes = 0;
+	I2C_mux_forget(mux);
+	return true;
+}
+
+/*!\brief Write I2C mux control register
+** \param [in, out] mux - pointer to the I2C mux structure
+** \param [in] sel - enabled channels bitmap
+** \return I2C_STATUS status of write (I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_mux_write(I2C_MUX * mux, const uint8_t sel)
+{
+	I2C_BUS *			b = I2C_BUS_SEL(mux->bus);
+	I2C_MUX_WR			ctl = { mux, sel };
+	const I2C_MSG		msg = { mux->addr, 0, 1, &ctl.sel };
+	bool				ack;
+
+	if (!I2C_acquire(b))	{ return I2C_BUSY; }
+
+	I2C_mux_forget(mux);
+	I2C_apply_speed(b, NULL);
+#if CI2C_STATS
+	i2c_st_slave = NULL;
+#endif
+	b->retry = b->cfg.retries;
+	I2C_arm_deadline(b, 1);
+	do	{ ack = I2C_msgs(b, &msg, 1); }
+	while ((!ack) && (I2C_bus_retry(b, 1)));
+	b->xfer = false;
+	if (ack)	{ I2C_mux_done(b, &ctl); }
+	I2C_release(b);
+
+	return ack ? I2C_OK : I2C_NACK;
+}
+
+/*!\brief Mux channel switching rank of a read request (I2C_mux_order sort key)
+** \param [in] req - pointer to the request
+** \return rank (0: slave directly on bus, 1: channel currently selected, then grouped by mux address & channel)
+**/
+static uint16_t I2C_mux_rank(const I2C_REQ * req)
+{
+	const I2C_SLAVE * const	slave = req->slave;
+	const I2C_MUX * const	mux = I2C_slave_get_mux(slave);
+
+	if (mux == NULL)	{ return 0; }
+#if CI2C_MUX
+	if ((mux->gen == I2C_BUS_SEL(mux->bus)->gen) && (mux->sel == (uint8_t) (1 << slave->cfg.chan)))	{ return 1; }
+	return (uint16_t) (0x400 | (mux->addr << 3) | slave->cfg.chan);
+#else
+	return 0;
+#endif
+}
+
+/*!\brief Order read requests to keep mux channel switches to a minimum (stable insertion sort)
+** \param [in, out] reqs - pointer to the first request
+** \param [in] nb - number of requests
+** \return nothing
+**/
+void I2C_mux_order(I2C_REQ * reqs, const uint8_t nb)
+{
+	for (uint8_t i = 1 ; i < nb ; i++)
+	{
+		const I2C_REQ	req = reqs[i];
+		const uint16_t	rank = I2C_mux_rank(&req);
+		uint8_t			j = i;
+
+		for ( ; (j != 0) && (I2C_mux_rank(&reqs[j - 1]) > rank) ; j--)	{ reqs[j] = reqs[j - 1]; }
+		reqs[j] = req;
+	}
+}
+
+/*!\brief This function performs a batch of reads, ordered by mux channel first
+** \param [in, out] reqs - pointer to the first request
+** \param [in] nb - number of requests
+** \return number of failed requests (0 if all succeeded)
+**/
+uint8_t I2C_read_batch(I2C_REQ * reqs, const uint8_t nb)
+{
+	uint8_t fails = 0;
+
+	I2C_mux_order(reqs, nb);
+	for (I2C_REQ * req = reqs ; req != &reqs[nb] ; req++)
+	{
+		req->status = I2C_read(req->slave, req->reg_addr, req->data, req->bytes);
+		if (req->status != I2C_OK)	{ fails++; }
+	}
+
+	return fails;
+}
+
+/*!\brief Custom transaction: same bus ownership, speed profile, mux channel, retries, circuit breaker & statistics handling as I2C_read / I2C_write
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] fc - transaction function
+** \param [in] reg_addr - register address given to \b fc
+** \param [in, out] data - data given to \b fc (may be a transaction descriptor)
+** \param [in] bytes - number of bytes of transaction (deadline computation & statistics)
+** \return I2C_STATUS status of transaction
+**/
+I2C_STATUS I2C_slave_xfer(I2C_SLAVE * slave, const ci2c_fct_ptr fc, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes) {
+	return I2C_comm(slave, reg_addr, data, bytes, I2C_READ, fc, false); }
+
+/*!\brief Get bus structure slave transactions go through
+** \param [in] slave - pointer to the I2C slave structure
+** \return pointer to the I2C bus structure
+**/
+I2C_BUS * I2C_slave_get_xfer_bus(const I2C_SLAVE * slave) {
+	return I2C_BUS_SEL(slave->cfg.bus); }
+
+
+/*!\brief Init an I2C constant slave (configuration kept in program memory descriptor, internal pointer unknown)
+** \param [in, out] cs - pointer to the I2C constant slave structure to init
+** \param [in] desc - pointer to the slave descriptor (program memory)
+** \return nothing
+**/
+void I2C_cslave_init(I2C_CSLAVE * cs, const I2C_SLAVE_DESC * desc)
+{
+	cs->desc = desc;
+	cs->reg_addr = 0;
+	I2C_cslave_forget_reg_addr(cs);	// Address sent on first access
+	cs->status = I2C_OK;
+}
+
+/*!\brief Constant slave transaction: descriptor fields read from program memory into a transient slave structure,
+**			runtime state written back once done
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read / write
+** \param [in] bytes - indicates how many bytes of data to read / write
+** \param [in] rw - read/write transaction
+** \return I2C_STATUS status of transaction
+**/
+static I2C_STATUS I2C_cslave_comm(I2C_CSLAVE * cs, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const I2C_RW rw)
+{
+	const I2C_SLAVE_DESC * const	desc = cs->desc;
+	const ci2c_fct_ptr				fc = (ci2c_fct_ptr) pgm_read_ptr(rw ? &desc->rd : &desc->wr);
+	I2C_SLAVE						slave;
+	I2C_STATUS						st;
+
+	// Only fields read by transactions set (read/write functions given to I2C_comm, speed profile registers,
+	// adaptive speed & circuit breaker counters unused when disabled)
+	slave.cfg.addr = pgm_read_byte(&desc->addr);
+	slave.cfg.reg_size = (I2C_INT_SIZE) pgm_read_byte(&desc->reg_size);
+	slave.cfg.page_size = pgm_read_word(&desc->page_size);
+	slave.cfg.blk_bits = 0;
+	slave.cfg.blk_shift = 0;
+	slave.cfg.bus = (I2C_BUS *) pgm_read_ptr(&desc->bus);
+	if (slave.cfg.bus == NULL)	{ slave.cfg.bus = i2c_def_bus; }	// Same default bus as I2C_slave_init
+	slave.cfg.speed = 0;
+#if CI2C_ADAPTIVE
+	slave.cfg.adaptive = false;
+#endif
+#if CI2C_BREAKER
+	slave.cfg.breaker = 0;
+#endif
+#if CI2C_MUX
+	slave.cfg.mux = (I2C_MUX *) pgm_read_ptr(&desc->mux);
+	slave.cfg.chan = 0;
+	if (slave.cfg.mux)
+	{
+		slave.cfg.bus = slave.cfg.mux->bus;	// Same as I2C_slave_set_mux
+		slave.cfg.chan = pgm_read_byte(&desc->chan);
+	}
+#endif
+	slave.cfg.pec = false;
+	slave.reg_addr = cs->reg_addr;
+	slave.reg_gen = cs->reg_gen;
+	slave.blk = 0;
+#if CI2C_STATS
+	memset(&slave.stats, 0, sizeof(slave.stats));	// Accounted by transaction (trace events get slave address), then dropped
+#endif
+
+	st = I2C_comm(&slave, reg_addr, data, bytes, rw, fc ? fc : (rw ? (ci2c_fct_ptr) I2C_rd : (ci2c_fct_ptr) I2C_wr), false);
+#if CI2C_STATS
+	i2c_st_slave = NULL;	// Transient slave structure
+#endif
+
+	cs->reg_addr = slave.reg_addr;
+	cs->reg_gen = slave.reg_gen;
+	return cs->status = st;
+}
+
+/*!\brief Write to a constant slave (same handling as I2C_write, without speed profile, adaptive speed, circuit breaker nor statistics)
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt
+**/
+I2C_STATUS I2C_cslave_write(I2C_CSLAVE * cs, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes) {
+	return I2C_cslave_comm(cs, reg_addr, data, bytes, I2C_WRITE); }
+
+/*!\brief Read from a constant slave (same handling as I2C_read, without speed profile, adaptive speed, circuit breaker nor statistics)
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt
+**/
+I2C_STATUS I2C_cslave_read(I2C_CSLAVE * cs, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes) {
+	return I2C_cslave_comm(cs, reg_addr, data, bytes, I2C_READ); }
+
+
+/*!\brief This function launches an interrupt driven transaction (bus ownership taken until completion)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read/write
+** \param [in] bytes - indicates how many bytes of data to read/write
+** \param [in] cb - callback called (from interrupt) with final status (may be NULL)
+** \param [in] rw - 0 = write, 1 = read operation
+** \return I2C_STATUS status of launch attempt (I2C_OK when launched)
+**/
+static I2C_STATUS I2C_comm_async(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const ci2c_cb_fct_ptr cb, const I2C_RW rw)
+{
+	uint8_t retries;
+
+	if (bytes == 0)									{ return slave->status = I2C_NACK; }
+	if (slave->cfg.bus)								{ return slave->status = I2C_NACK; }	// Hardware TWI only
+	if (!I2C_slave_gate(slave, i2c.cfg.retries, &retries))	{ return slave->status = I2C_NACK; }	// Circuit breaker open
+	if (!I2C_acquire(&i2c))							{ return slave->status = I2C_BUSY; }
+
+	I2C_apply_speed(&i2c, slave);
+	i2c_it.slave = slave;
+	i2c_it.cb = cb;
+	i2c_it.buf = data;
+	i2c_it.nb = bytes;
+	i2c_it.reg_addr = reg_addr;
+	i2c_it.rw = rw;
+	i2c_it.retry = retries;
+#if CI2C_STATS
+	i2c_it.t_start = (uint32_t) micros();
+	i2c_st_slave = slave;
+#endif
+
+	slave->status = I2C_BUSY;	// Until completion
+	I2C_it_launch();
+
+	return I2C_OK;
+}
+
+/*!\brief This function writes the provided data to the address specified (interrupt driven, returns immediately).
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write (shall stay valid until completion)
+** \param [in] bytes - indicates how many bytes of data to write
+** \param [in] cb - callback called (from interrupt) with final status (may be NULL)
+** \return I2C_STATUS status of launch attempt (I2C_OK when launched, I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_write_async(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const ci2c_cb_fct_ptr cb) {
+	return I2C_comm_async(slave, reg_addr, data, bytes, cb, I2C_WRITE); }
+
+/*!\brief This function reads data from the address specified (interrupt driven, returns immediately).
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read (shall stay valid until completion)
+** \param [in] bytes - indicates how many bytes of data to read
+** \param [in] cb - callback called (from interrupt) with final status (may be NULL)
+** \return I2C_STATUS status of launch attempt (I2C_OK when launched, I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_read_async(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const ci2c_cb_fct_ptr cb) {
+	return I2C_comm_async(slave, reg_addr, data, bytes, cb, I2C_READ); }
+
+/*!\brief Check asynchronous transaction progress: delayed retry relaunched, transaction past its deadline aborted
+** \return true if an asynchronous transaction is still in progress
+**/
+bool I2C_async_process(void)
+{
+	const uint8_t	sreg = SREG;
+	bool			run;
+
+	cli();
+	if ((i2c_it.slave) && (!i2c_slv.resume))	// Deadline re-armed when a transaction suspended by slave mode restarts
+	{
+		const uint32_t elapsed = (uint32_t) micros() - i2c_it.t_arm;
+
+		if (i2c_it.wait)
+		{
+			if (elapsed >= (CI2C_RETRY_DELAY * 1000UL))	{ I2C_it_launch(); }
+		}
+		else if (elapsed > i2c_it.budget)	// Stuck (no interrupt anymore, or slave stretching clock for too long)
+		{
+			TWCR = (1 << TWEN);		// Interrupt disabled before bus reset
+			I2C_timed_out();
+			I2C_it_done(I2C_TIMEOUT);
+		}
+	}
+	run = (i2c_it.slave != NULL);
+	SREG = sreg;
+
+	return run;
+}
+
+
+/*!\brief Start interrupt driven slave mode (registers map served in place from TWI interrupt)
+** \param [in] addr - own I2C slave address
+** \param [in] reg_sz - internal register map size
+** \param [in, out] regs - registers map (shall stay valid until slave mode is stopped)
+** \param [in] size - registers map size
+** \param [in] on_write - hook called (from interrupt) when master ends writing registers (may be NULL)
+** \return true if slave mode started (false if address is incorrect)
+**/
+bool I2C_slave_mode_start(const uint8_t addr, const I2C_INT_SIZE reg_sz, uint8_t * regs, const uint16_t size, const ci2c_reg_cb_fct_ptr on_write)
+{
+	const uint8_t sreg = SREG;
+
+	if (addr > 0x7F)	{ return false; }
+
+	cli();
+	i2c_slv.regs = regs;
+	i2c_slv.size = size;
+	i2c_slv.reg_size = (reg_sz > I2C_16B_REG) ? I2C_16B_REG : reg_sz;
+	i2c_slv.on_write = on_write;
+	i2c_slv.ptr = 0;
+	i2c_slv.wr_cnt = 0;
+	i2c_slv.active = i2c_slv.resume = false;
+
+	TWAR = (uint8_t) (addr << 1);	// General call not recognized
+	if (!i2c.busy)	{ TWCR = (1 << TWEN) | (1 << TWEA) | (1 << TWIE); }	// Otherwise set when bus is released
+	SREG = sreg;
+
+	return true;
+}
+
+/*!\brief Stop slave mode (own address not acknowledged anymore)
+** \return nothing
+**/
+void I2C_slave_mode_stop(void)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	i2c_slv.regs = NULL;
+	i2c_slv.size = 0;
+	i2c_slv.active = false;
+	if (!i2c.busy)	{ TWCR = (1 << TWEN); }
+	SREG = sreg;
+}
+
+/*!\brief Get slave mode current register address
+** \return Register address of next byte served
+**/
+uint16_t I2C_slave_mode_get_reg_addr(void) {
+	return i2c_slv.ptr; }
+
+
+/*!\brief Start timeout timer of a low level operation (unless a transaction deadline is armed)
+** \attribute inline
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return nothing
+**/
+static inline void __attribute__((__always_inline__)) I2C_start_timeout(I2C_BUS * bus)
+{
+	bus->spin = CI2C_TIMEOUT_SPIN;
+	if (!bus->xfer)
+	{
+		bus->start_wait = (uint32_t) micros();
+		bus->budget = bus->cfg.timeout * 1000UL;
+	}
+}
+
+/*!\brief Test timeout of a low level operation (time only checked every CI2C_TIMEOUT_SPIN polling loops)
+** \attribute inline
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return true if timeout occured (false otherwise)
+**/
+static inline uint8_t __attribute__((__always_inline__)) I2C_timeout(I2C_BUS * bus)
+{
+	if (--bus->spin != 0)	{ return false; }
+	bus->spin = CI2C_TIMEOUT_SPIN;
+	return (((uint32_t) micros() - bus->start_wait) >= bus->budget);
+}
+
+/*!\brief Start bus timeout of a low level operation (unless a transaction deadline is armed)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return nothing
+**/
+void I2C_bus_start_timeout(I2C_BUS * bus) {
+	I2C_start_timeout(bus); }
+
+/*!\brief Test bus timeout of a low level operation (time only checked every few polling loops)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return true if timeout occured
+**/
+bool I2C_bus_timeout(I2C_BUS * bus) {
+	return I2C_timeout(bus); }
+
+/*!\brief Wait for end of current hardware TWI operation (TWINT set, time checked every CI2C_TIMEOUT_SPIN polling loops from now), bus recovered on timeout
+** \attribute inline
+** \return true if operation ended (false on timeout)
+**/
+static inline bool __attribute__((__always_inline__)) I2C_hw_wait(void)
+{
+	i2c.spin = CI2C_TIMEOUT_SPIN;
+	while (!(TWCR & (1 << TWINT)))
+	{ if (I2C_timeout(&i2c))	{ I2C_timed_out(); return false; } }
+
+	return true;
+}
+
+/*!\brief Send start condition
+** \return true if start condition acknowledged (false otherwise)
+**/
+bool I2C_start(void)
+{
+	I2C_start_timeout(&i2c);
+
+	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
+
+	while (!(TWCR & (1 << TWINT)))
+	{ if (I2C_timeout(&i2c))	{ I2C_timed_out(); return false; } }
+
+	I2C_TRACE(TWI_STATUS);
+	if ((TWI_STATUS == START) || (TWI_STATUS == REPEATED_START))	{ return true; }
+	if (TWI_STATUS == LOST_ARBTRTN)									{ I2C_recover(); }
+
+	return false;
+}
+
+/*!\brief Send stop condition
+** \return true if stop condition acknowledged (false otherwise)
+**/
+bool I2C_stop(void)
+{
+	I2C_start_timeout(&i2c);
 
 	TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
 
 	while ((TWCR & (1 << TWSTO)))
-	{ if (I2C_timeout())	{ I2C_reset(); return false; } }
+	{ if (I2C_timeout(&i2c))	{ I2C_timed_out(); return false; } }
+
+	I2C_TRACE(TWI_STATUS);
+	return true;
+}
+
+/*!\brief Send byte on bus
+** \param [in] dat - data to be sent
+** \return true if data sent acknowledged (false otherwise)
+**/
+bool I2C_wr8(const uint8_t dat)
+{
+	TWDR = dat;
+
+	I2C_start_timeout(&i2c);
+
+	TWCR = (1 << TWINT) | (1 << TWEN);
+
+	while (!(TWCR & (1 << TWINT)))
+	{ if (I2C_timeout(&i2c))	{ I2C_timed_out(); return false; } }
+
+	I2C_TRACE(TWI_STATUS);
+	if (TWI_STATUS == MT_DATA_ACK)		{ return true; }
+
+	if (TWI_STATUS == MT_DATA_NACK)		{ I2C_STAT_INC(nacks); i2c.nack = true; I2C_stop(); }
+	else								{ I2C_recover(); }
+
+	return false;
+}
+
+/*!\brief Receive byte from bus
+** \param [in] ack - true if wait for ack
+** \return true if data reception acknowledged (false otherwise)
+**/
+uint8_t I2C_rd8(const bool ack)
+{
+	I2C_start_timeout(&i2c);
+
+	if (ack)	{ TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA); }
+	else		{ TWCR = (1 << TWINT) | (1 << TWEN); }
+
+	while (!(TWCR & (1 << TWINT)))
+	{ if (I2C_timeout(&i2c))	{ I2C_timed_out(); return false; } }
+
+	I2C_TRACE(TWI_STATUS);
+	if (TWI_STATUS == LOST_ARBTRTN)		{ I2C_recover(); return false; }
+
+	return ((((TWI_STATUS == MR_DATA_NACK) && (!ack)) || ((TWI_STATUS == MR_DATA_ACK) && (ack))) ? true : false);
+}
+
+/*!\brief Send I2C address
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in] rw - read/write transaction
+** \return true if I2C chip address sent acknowledged (false otherwise)
+**/
+bool I2C_sndAddr(I2C_SLAVE * slave, const I2C_RW rw)
+{
+#if CI2C_STATS
+	if (!i2c.xfer)	{ i2c_st_slave = slave; }	// Low level function used on its own
+#endif
+
+	return I2C_sndSla((uint8_t) ((I2C_slave_get_xfer_addr(slave) << 1) | rw));
+}
+
+/*!\brief Send I2C address byte
+** \param [in] sla - slave address byte (7 bits address shifted left, read/write bit included)
+** \return true if I2C chip address sent acknowledged (false otherwise)
+**/
+bool I2C_sndSla(const uint8_t sla)
+{
+	TWDR = sla;
+
+	I2C_start_timeout(&i2c);
+
+	TWCR = (1 << TWINT) | (1 << TWEN);
+
+	while (!(TWCR & (1 << TWINT)))
+	{ if (I2C_timeout(&i2c))	{ I2C_timed_out(); return false; } }
+
+	I2C_TRACE(TWI_STATUS);
+	if ((TWI_STATUS == MT_SLA_ACK) || (TWI_STATUS == MR_SLA_ACK))	{ return true; }
+
+	if ((TWI_STATUS == MT_SLA_NACK) || (TWI_STATUS == MR_SLA_NACK))	{ I2C_STAT_INC(nacks); i2c.nack = true; I2C_stop(); }
+	else															{ I2C_recover(); }
+
+	return false;
+}
+
+
+/*!\brief Compute hardware TWI clock registers (smallest prescaler keeping bit rate register in range)
+** \param [in] speed - I2C speed in KHz
+** \param [in, out] twbr - pointer to bit rate register value
+** \param [in, out] twps - pointer to prescaler bits value
+** \return Actual speed in KHz
+**/
+static uint16_t I2C_hw_clk_regs(const uint16_t speed, uint8_t * twbr, uint8_t * twps)
+{
+	const uint32_t	div = (F_CPU / 1000UL) / speed;		// SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS)
+	uint32_t		br = (div > 16) ? ((div - 16) / 2) : 0;
+	uint8_t			ps = 0;
+
+	while ((br > 0xFF) && (ps < 3))	{ br >>= 2; ps++; }
+	if (br > 0xFF)	{ br = 0xFF; }
+
+	*twbr = (uint8_t) br;
+	*twps = ps;
+	return (uint16_t) ((F_CPU / 1000UL) / (16 + ((2 * br) << (2 * ps))));
+}
+
+/*!\brief Hardware TWI backend: set bus clock
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] speed - I2C bus speed in KHz
+** \return Configured bus speed
+**/
+static uint16_t I2C_hw_set_speed(I2C_BUS * bus, const uint16_t speed)
+{
+	uint16_t actual;
+
+	(void) bus;
+
+	actual = I2C_hw_clk_regs(speed, &i2c_clk.twbr, &i2c_clk.twps);
+
+	clrRegBit(TWCR, TWEN);	// Ensure i2c module is disabled
+
+	// Set prescaler and clock frequency
+	TWSR = (uint8_t) ((TWSR & 0xF8) | i2c_clk.twps);
+	TWBR = i2c_clk.twbr;
+
+	I2C_reset();			// re-enable module
+
+	return actual;
+}
+
+/*!\brief Hardware TWI backend: send start condition
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return true if start condition acknowledged (false otherwise)
+**/
+static bool I2C_hw_start(I2C_BUS * bus) {
+	(void) bus; return I2C_start(); }
+
+/*!\brief Hardware TWI backend: send stop condition
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return true if stop condition acknowledged (false otherwise)
+**/
+static bool I2C_hw_stop(I2C_BUS * bus) {
+	(void) bus; return I2C_stop(); }
+
+/*!\brief Hardware TWI backend: send address byte
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] sla - slave address byte
+** \return true if address acknowledged (false otherwise)
+**/
+static bool I2C_hw_sndSla(I2C_BUS * bus, const uint8_t sla) {
+	(void) bus; return I2C_sndSla(sla); }
+
+/*!\brief Hardware TWI backend: send data byte
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] dat - data to be sent
+** \return true if data sent acknowledged (false otherwise)
+**/
+static bool I2C_hw_wr8(I2C_BUS * bus, const uint8_t dat) {
+	(void) bus; return I2C_wr8(dat); }
+
+/*!\brief Hardware TWI backend: receive data byte
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in, out] dat - pointer to received byte
+** \param [in] ack - true if byte has to be acknowledged
+** \return true if data received (false otherwise)
+**/
+static bool I2C_hw_rd8(I2C_BUS * bus, uint8_t * dat, const bool ack)
+{
+	(void) bus;
 
+	if (!I2C_rd8(ack))	{ return false; }
+	*dat = TWDR;
 	return true;
 }
 
-/*!\brief Send byte on bus
-** \param [in] dat - data to be sent
-** \return true if data sent acknowledged (false otherwise)
+/*!\brief Hardware TWI backend: send data bytes burst
+** \details Bytes chained without function call: next byte loaded as soon as previous one is acknowledged,
+**			 status tested once per byte and time checked every CI2C_TIMEOUT_SPIN polling loops over the whole burst.
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] data - pointer to the first byte of a block of data to send
+** \param [in] bytes - number of bytes to send (at least 1)
+** \return true if all bytes acknowledged (stop condition sent on NACK)
 **/
-bool I2C_wr8(const uint8_t dat)
+static bool I2C_hw_wr_burst(I2C_BUS * bus, const uint8_t * data, const uint16_t bytes)
 {
-	TWDR = dat;
-
-	I2C_start_timeout();
+	const uint8_t * const end = data + bytes;
 
-	TWCR = (1 << TWINT) | (1 << TWEN);
+	(void) bus;
+	I2C_start_timeout(&i2c);
 
-	while (!(TWCR & (1 << TWINT)))
-	{ if (I2C_timeout())	{ I2C_reset(); return false; } }
+	while (true)
+	{
+		TWDR = *data++;
+		TWCR = (1 << TWINT) | (1 << TWEN);
+		if (!I2C_hw_wait())				{ return false; }
 
-	if (TWI_STATUS == MT_DATA_ACK)		{ return true; }
+		I2C_TRACE(TWI_STATUS);
+		if (TWI_STATUS != MT_DATA_ACK)	{ break; }
+		if (data == end)				{ return true; }
+	}
 
-	if (TWI_STATUS == MT_DATA_NACK)		{ I2C_stop(); }
-	else								{ I2C_reset(); }
+	if (TWI_STATUS == MT_DATA_NACK)		{ I2C_STAT_INC(nacks); i2c.nack = true; (void) I2C_stop(); }
+	else								{ I2C_recover(); }
 
 	return false;
 }
 
-/*!\brief Receive byte from bus
-** \param [in] ack - true if wait for ack
-** \return true if data reception acknowledged (false otherwise)
+/*!\brief Hardware TWI backend: receive data bytes burst
+** \details Acknowledged bytes chained without function call, last byte NACK set up once out of loop,
+**			 status tested once per byte and time checked every CI2C_TIMEOUT_SPIN polling loops over the whole burst.
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in, out] data - pointer to the first byte of a block of data to receive
+** \param [in] bytes - number of bytes to receive (at least 1)
+** \param [in] last - true if last byte of burst is last byte of transaction (not acknowledged)
+** \return true if all bytes received (false on timeout or arbitration loss)
 **/
-uint8_t I2C_rd8(const bool ack)
+static bool I2C_hw_rd_burst(I2C_BUS * bus, uint8_t * data, const uint16_t bytes, const bool last)
 {
-	I2C_start_timeout();
+	uint8_t * const acked = data + bytes - (last ? 1 : 0);	// End of acknowledged bytes
 
-	if (ack)	{ TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA); }
-	else		{ TWCR = (1 << TWINT) | (1 << TWEN); }
+	(void) bus;
+	I2C_start_timeout(&i2c);
 
-	while (!(TWCR & (1 << TWINT)))
-	{ if (I2C_timeout())	{ I2C_reset(); return false; } }
+	while (data != acked)
+	{
+		TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
+		if (!I2C_hw_wait())				{ return false; }
+
+		I2C_TRACE(TWI_STATUS);
+		if (TWI_STATUS != MR_DATA_ACK)	{ break; }
+		*data++ = TWDR;
+	}
 
-	if (TWI_STATUS == LOST_ARBTRTN)		{ I2C_reset(); return false; }
+	if (data == acked)
+	{
+		if (!last)						{ return true; }
 
-	return ((((TWI_STATUS == MR_DATA_NACK) && (!ack)) || ((TWI_STATUS == MR_DATA_ACK) && (ack))) ? true : false);
+		TWCR = (1 << TWINT) | (1 << TWEN);	// Last byte not acknowledged
+		if (!I2C_hw_wait())				{ return false; }
+
+		I2C_TRACE(TWI_STATUS);
+		if (TWI_STATUS == MR_DATA_NACK)	{ *data = TWDR; return true; }
+	}
+
+	if (TWI_STATUS == LOST_ARBTRTN)		{ I2C_recover(); }
+
+	return false;
 }
 
-/*!\brief Send I2C address
-** \param [in] slave - pointer to the I2C slave structure
-** \param [in] rw - read/write transaction
-** \return true if I2C chip address sent acknowledged (false otherwise)
+
+/*!\brief Send data phase of a transaction (backend burst if any, byte after byte otherwise)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] data - pointer to the first byte of a block of data to send
+** \param [in] bytes - number of bytes to send (at least 1)
+** \return true if all bytes acknowledged
 **/
-bool I2C_sndAddr(I2C_SLAVE * slave, const I2C_RW rw)
+static bool I2C_bus_wr(I2C_BUS * bus, const uint8_t * data, const uint16_t bytes)
 {
-	TWDR = (slave->cfg.addr << 1) | rw;
+	if (bus->ops->wr_burst)	{ return bus->ops->wr_burst(bus, data, bytes); }
 
-	I2C_start_timeout();
+	for (uint16_t cnt = bytes ; cnt != 0 ; cnt--)
+	{
+		if (bus->ops->wr8(bus, *data++) == false)	{ return false; }
+	}
 
-	TWCR = (1 << TWINT) | (1 << TWEN);
+	return true;
+}
 
-	while (!(TWCR & (1 << TWINT)))
-	{ if (I2C_timeout())	{ I2C_reset(); return false; } }
+/*!\brief Receive data phase of a transaction (backend burst if any, byte after byte otherwise)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in, out] data - pointer to the first byte of a block of data to receive
+** \param [in] bytes - number of bytes to receive (at least 1)
+** \param [in] last - true if last byte is last byte of transaction (not acknowledged)
+** \return true if all bytes received
+**/
+static bool I2C_bus_rd(I2C_BUS * bus, uint8_t * data, const uint16_t bytes, const bool last)
+{
+	if (bus->ops->rd_burst)	{ return bus->ops->rd_burst(bus, data, bytes, last); }
 
-	if ((TWI_STATUS == MT_SLA_ACK) || (TWI_STATUS == MR_SLA_ACK))	{ return true; }
+	for (uint16_t cnt = bytes ; --cnt != 0 ; )	// Acknowledged bytes
+	{
+		if (bus->ops->rd8(bus, data++, true) == false)	{ return false; }
+	}
 
-	if ((TWI_STATUS == MT_SLA_NACK) || (TWI_STATUS == MR_SLA_NACK))	{ I2C_stop(); }
-	else															{ I2C_reset(); }
+	return bus->ops->rd8(bus, data, !last);
+}
 
-	return false;
+/*!\brief Data phase of a transaction over segments
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] seg - pointer to the first segment
+** \param [in] off - offset of first byte to transfer (from start of first segment)
+** \param [in] bytes - number of bytes to transfer (at least 1, within segments)
+** \param [in] rw - 0 = write, 1 = read (last byte not acknowledged)
+** \return true if all bytes transferred
+**/
+static bool I2C_bus_segs(I2C_BUS * bus, const I2C_SEG * seg, uint16_t off, uint16_t bytes, const I2C_RW rw)
+{
+	while (off >= seg->len)	{ off -= seg->len; seg++; }
+
+	for ( ; bytes != 0 ; seg++, off = 0)
+	{
+		const uint16_t	nb = ((seg->len - off) < bytes) ? (seg->len - off) : bytes;
+		bool			ok;
+
+		if (nb == 0)	{ continue; }	// Empty segment
+		bytes -= nb;
+
+		if (rw == I2C_READ)	{ ok = I2C_bus_rd(bus, seg->data + off, nb, bytes == 0); }
+		else				{ ok = I2C_bus_wr(bus, seg->data + off, nb); }
+		if (!ok)			{ return false; }
+	}
+
+	return true;
 }
 
 
-/*!\brief This procedure calls appropriate functions to perform a proper send transaction on I2C bus.
+/*!\brief Transaction over segments on a message level backend (register address & data phases handed at once to backend)
+** \param [in, out] bus - pointer to the I2C bus structure
 ** \param [in, out] slave - pointer to the I2C slave structure
 ** \param [in] reg_addr - register address in register map
-** \param [in] data - pointer to the first byte of a block of data to write
-** \param [in] bytes - indicates how many bytes of data to write
-** \return Boolean indicating success/fail of write attempt
+** \param [in] seg - pointer to the first segment
+** \param [in] off - offset of first byte to transfer (from start of first segment)
+** \param [in] bytes - number of bytes to transfer (at least 1, within segments)
+** \param [in] rw - 0 = write, 1 = read
+** \return true if transaction succeeded (false if more than CI2C_XFER_SEGS non empty segments)
 **/
-static bool I2C_wr(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+static bool I2C_xfer_segs(I2C_BUS * bus, I2C_SLAVE * slave, const uint16_t reg_addr, const I2C_SEG * seg, uint16_t off, const uint16_t bytes, const I2C_RW rw)
 {
-	if (bytes == 0)												{ return false; }
+	uint8_t			reg[2] = { (uint8_t) (reg_addr >> 8), (uint8_t) reg_addr };
+	const bool		known = I2C_slave_reg_begin(bus, slave, reg_addr);
+	const bool		addr_phase = (slave->cfg.reg_size) && ((rw == I2C_WRITE) || (!known));	// Register address always sent on writes
+	uint8_t			flags = (rw == I2C_READ) ? I2C_MSG_RD : (addr_phase ? I2C_MSG_NOSTART : 0);	// Written data continues register address
+	uint16_t		nb = 0;
+	uint16_t		left = bytes;
+	I2C_MSG			msgs[CI2C_XFER_SEGS + 1];	// Register address & segments
+	I2C_MSG *		msg = msgs;
+
+	while (off >= seg->len)	{ off -= seg->len; seg++; }
+
+	for (const I2C_SEG * s = seg ; left != 0 ; s++)	// Messages count (one per non empty segment)
+	{
+		const uint16_t len = (s == seg) ? (s->len - off) : s->len;
 
-	if (I2C_start() == false)									{ return false; }
-	if (I2C_sndAddr(slave, I2C_WRITE) == false)					{ return false; }
-	if ((slave->cfg.reg_size) && (reg_addr != slave->reg_addr))	// Don't send address if writing next
+		if (len != 0)	{ nb++; left -= (len < left) ? len : left; }
+	}
+	if (nb > CI2C_XFER_SEGS)	{ return false; }
+	if (addr_phase)				{ nb++; }
+
+	if (addr_phase)	{ *msg++ = (I2C_MSG) { I2C_slave_get_xfer_addr(slave), 0, slave->cfg.reg_size, &reg[2 - slave->cfg.reg_size] }; }
+
+	for (left = bytes ; left != 0 ; seg++, off = 0)
 	{
-		(void) I2C_slave_set_reg_addr(slave, reg_addr);
+		const uint16_t len = ((seg->len - off) < left) ? (seg->len - off) : left;
+
+		if (len == 0)	{ continue; }
+		*msg++ = (I2C_MSG) { I2C_slave_get_xfer_addr(slave), flags, len, seg->data + off };
+		flags |= I2C_MSG_NOSTART;
+		left -= len;
+	}
+
+	bus->nack = false;
+	if (bus->ops->xfer(bus, msgs, nb) == false)	{ return false; }
+
+	I2C_slave_reg_end(bus, slave, reg_addr, bytes);
+	return true;
+}
+
+/*!\brief Send START condition, slave address & register address of a transaction (register address phase elided on reads
+**			when device internal pointer is already known at register address, followed by repeated START & read address then)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] rw - 0 = write, 1 = read operation
+** \return Boolean indicating success/fail of address phases
+**/
+static bool I2C_snd_reg(I2C_BUS * bus, I2C_SLAVE * slave, const uint16_t reg_addr, const I2C_RW rw)
+{
+	const I2C_BUS_OPS * const	ops = bus->ops;
+	const uint8_t				sla = (uint8_t) (I2C_slave_get_xfer_addr(slave) << 1);
+	bool						wr_phase = true;
+
+	if (rw == I2C_WRITE)			{ (void) I2C_slave_reg_begin(bus, slave, reg_addr); }	// Always sent: first bytes of a write are taken as register address by device
+	else if (slave->cfg.reg_size)	{ wr_phase = !I2C_slave_reg_begin(bus, slave, reg_addr); }	// Don't send address if reading next
+	else							{ wr_phase = false; }
 
-		if (slave->cfg.reg_size >= I2C_16B_REG)	// if size >2, 16bit address is used
+	if (wr_phase)
+	{
+		if (ops->start(bus) == false)								{ return false; }
+		if (ops->sndSla(bus, (uint8_t) (sla | I2C_WRITE)) == false)	{ return false; }
+		if (slave->cfg.reg_size)
 		{
-			if (I2C_wr8((uint8_t) (reg_addr >> 8)) == false)	{ return false; }
+			if (slave->cfg.reg_size >= I2C_16B_REG)	// if size >2, 16bit address is used
+			{
+				if (ops->wr8(bus, (uint8_t) (reg_addr >> 8)) == false)	{ return false; }
+			}
+			if (ops->wr8(bus, (uint8_t) reg_addr) == false)			{ return false; }
 		}
-		if (I2C_wr8((uint8_t) reg_addr) == false)				{ return false; }
 	}
 
-	for (uint16_t cnt = 0; cnt < bytes; cnt++)
+	if (rw == I2C_READ)
 	{
-		if (I2C_wr8(*data++) == false)							{ return false; }
-		slave->reg_addr++;
+		if (ops->start(bus) == false)								{ return false; }
+		if (ops->sndSla(bus, (uint8_t) (sla | I2C_READ)) == false)	{ return false; }
 	}
 
-	if (I2C_stop() == false)									{ return false; }
+	return true;
+}
+
+/*!\brief Send transaction over segments (single address phase)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] segs - pointer to the first segment
+** \param [in] off - offset of first byte to write (from start of first segment)
+** \param [in] bytes - indicates how many bytes of data to write
+** \return Boolean indicating success/fail of write attempt
+**/
+static bool I2C_wr_segs(I2C_SLAVE * slave, const uint16_t reg_addr, const I2C_SEG * segs, const uint16_t off, const uint16_t bytes)
+{
+	I2C_BUS * const				bus = I2C_BUS_SEL(slave->cfg.bus);
+	const I2C_BUS_OPS * const	ops = bus->ops;
+
+	if (bytes == 0)												{ return false; }
+	if (ops->xfer)												{ return I2C_xfer_segs(bus, slave, reg_addr, segs, off, bytes, I2C_WRITE); }
+
+	if (I2C_snd_reg(bus, slave, reg_addr, I2C_WRITE) == false)	{ return false; }
+	if (I2C_bus_segs(bus, segs, off, bytes, I2C_WRITE) == false)	{ return false; }
+	if (ops->stop(bus) == false)								{ return false; }
 
+	I2C_slave_reg_end(bus, slave, reg_addr, bytes);
 	return true;
 }
 
+/*!\brief This procedure calls appropriate functions to perform a proper send transaction on I2C bus.
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return Boolean indicating success/fail of write attempt
+**/
+static bool I2C_wr(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+{
+	const I2C_SEG seg = { data, bytes };
+	return I2C_wr_segs(slave, reg_addr, &seg, 0, bytes);
+}
+
+/*!\brief Send transaction of a vectored write (segments located from register address offset, so that pages are handled)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the vectored transfer descriptor
+** \param [in] bytes - indicates how many bytes of data to write
+** \return Boolean indicating success/fail of write attempt
+**/
+static bool I2C_wrv(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+{
+	const I2C_VEC * const vec = (const I2C_VEC *) data;
+	return I2C_wr_segs(slave, reg_addr, vec->segs, reg_addr - vec->base, bytes);
+}
+
+
+/*!\brief Receive transaction over segments (single address phase)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] segs - pointer to the first segment
+** \param [in] off - offset of first byte to read (from start of first segment)
+** \param [in] bytes - indicates how many bytes of data to read
+** \return Boolean indicating success/fail of read attempt
+**/
+static bool I2C_rd_segs(I2C_SLAVE * slave, const uint16_t reg_addr, const I2C_SEG * segs, const uint16_t off, const uint16_t bytes)
+{
+	I2C_BUS * const				bus = I2C_BUS_SEL(slave->cfg.bus);
+	const I2C_BUS_OPS * const	ops = bus->ops;
+
+	if (bytes == 0)													{ return false; }
+	if (ops->xfer)													{ return I2C_xfer_segs(bus, slave, reg_addr, segs, off, bytes, I2C_READ); }
+
+	if (I2C_snd_reg(bus, slave, reg_addr, I2C_READ) == false)		{ return false; }
+	if (I2C_bus_segs(bus, segs, off, bytes, I2C_READ) == false)	{ return false; }
+	if (ops->stop(bus) == false)									{ return false; }
+
+	I2C_slave_reg_end(bus, slave, reg_addr, bytes);
+	return true;
+}
 
 /*!\brief This procedure calls appropriate functions to perform a proper receive transaction on I2C bus.
 ** \param [in, out] slave - pointer to the I2C slave structure
@@ -422,32 +2484,427 @@ static bool I2C_wr(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, c
 **/
 static bool I2C_rd(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
 {
-	if (bytes == 0)													{ return false; }
+	const I2C_SEG seg = { data, bytes };
+	return I2C_rd_segs(slave, reg_addr, &seg, 0, bytes);
+}
+
+/*!\brief Receive transaction of a vectored read
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the vectored transfer descriptor
+** \param [in] bytes - indicates how many bytes of data to read
+** \return Boolean indicating success/fail of read attempt
+**/
+static bool I2C_rdv(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+{
+	const I2C_VEC * const vec = (const I2C_VEC *) data;
+	return I2C_rd_segs(slave, reg_addr, vec->segs, reg_addr - vec->base, bytes);
+}
+
+
+/*!\brief Confirm I2C slave internal pointer after a successful chunked transaction (unknown past 65535 bytes)
+** \param [in] bus - pointer to the I2C bus structure slave is connected to
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - transaction register address
+** \param [in] bytes - number of bytes transferred
+** \return nothing
+**/
+static void I2C_chunks_reg_end(const I2C_BUS * bus, I2C_SLAVE * slave, const uint16_t reg_addr, const uint32_t bytes)
+{
+	if (bytes > 0xFFFF)	{ slave->reg_addr = (uint16_t) (reg_addr + bytes); slave->reg_gen = 0; }
+	else				{ I2C_slave_reg_end(bus, slave, reg_addr, (uint16_t) bytes); }
+}
+
+/*!\brief Abort a chunked transaction (source or sink refused to go on): no more retries
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] stop - true if a stop condition has to be sent (transaction in progress)
+** \return false
+**/
+static bool I2C_chunks_abort(I2C_BUS * bus, const bool stop)
+{
+	if (stop)	{ (void) bus->ops->stop(bus); }
+	bus->retry = 0;
+	return false;
+}
+
+/*!\brief Send transaction of a source write, from first byte not acknowledged yet to end of transaction
+** \details Data acknowledged is kept as written (chunk after chunk), except on paged memories (transaction of a single chunk,
+**			 kept in chunk buffer until stop condition as memory write cycle starts then)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map (unused, transaction resumed from descriptor)
+** \param [in, out] data - pointer to the source transfer descriptor
+** \param [in] bytes - number of bytes of transaction (unused, transaction resumed from descriptor)
+** \return Boolean indicating success/fail of write attempt
+**/
+static bool I2C_wr_src(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+{
+	I2C_CHUNKS * const			ck = (I2C_CHUNKS *) data;
+	I2C_BUS * const				bus = I2C_BUS_SEL(slave->cfg.bus);
+	const I2C_BUS_OPS * const	ops = bus->ops;
+	const uint16_t				addr = (uint16_t) (ck->base + ck->done);
+	const uint32_t				from = ck->done;
+	const bool					paged = (slave->cfg.page_size != 0);
 
-	if ((slave->cfg.reg_size) && (reg_addr != slave->reg_addr))	// Don't send address if reading next
+	(void) reg_addr;
+	(void) bytes;
+
+	if (ck->done >= ck->end)	{ return true; }	// Everything acknowledged, stop condition failed
+
+	if ((!ops->xfer) && (I2C_snd_reg(bus, slave, addr, I2C_WRITE) == false))	{ return false; }
+
+	for (uint32_t pos = from ; pos < ck->end ; )
 	{
-		(void) I2C_slave_set_reg_addr(slave, reg_addr);
+		if (ck->held == 0)	// Chunk buffer free: pull next chunk
+		{
+			const uint16_t nb = ((ck->end - pos) < CI2C_CHUNK_SIZE) ? (uint16_t) (ck->end - pos) : CI2C_CHUNK_SIZE;
 
-		if (I2C_start() == false)									{ return false; }
-		if (I2C_sndAddr(slave, I2C_WRITE) == false)					{ return false; }
-		if (slave->cfg.reg_size >= I2C_16B_REG)	// if size >2, 16bit address is used
+			if (ck->fct.src(ck->ctx, ck->buf, nb) == false)		{ return I2C_chunks_abort(bus, !ops->xfer); }
+			ck->held = nb;
+		}
+
+		I2C_arm_deadline(bus, ck->held);	// Source time not accounted
+		if (ops->xfer)
 		{
-			if (I2C_wr8((uint8_t) (reg_addr >> 8)) == false)		{ return false; }
+			const I2C_SEG seg = { ck->buf, ck->held };
+			if (I2C_xfer_segs(bus, slave, (uint16_t) (ck->base + pos), &seg, 0, ck->held, I2C_WRITE) == false)	{ return false; }
 		}
-		if (I2C_wr8((uint8_t) reg_addr) == false)					{ return false; }
+		else if (I2C_bus_wr(bus, ck->buf, ck->held) == false)	{ return false; }
+
+		pos += ck->held;
+		if (!paged)	{ ck->done += ck->held; ck->held = 0; }	// Chunk written (buffer kept until stop condition otherwise)
 	}
-	if (I2C_start() == false)										{ return false; }
-	if (I2C_sndAddr(slave, I2C_READ) == false)						{ return false; }
 
-	for (uint16_t cnt = 0; cnt < bytes; cnt++)
+	if (!ops->xfer)
 	{
-		if (I2C_rd8((cnt == (bytes - 1)) ? false : true) == false)	{ return false; }
-		*data++ = TWDR;
-		slave->reg_addr++;
+		if (ops->stop(bus) == false)							{ return false; }
+		I2C_chunks_reg_end(bus, slave, addr, ck->end - from);
+	}
+
+	ck->done += ck->held;	// Paged memory chunk
+	ck->held = 0;
+	return true;
+}
+
+/*!\brief Receive transaction of a sink read, from first byte not given to sink yet to end of transfer
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map (unused, transaction resumed from descriptor)
+** \param [in, out] data - pointer to the sink transfer descriptor
+** \param [in] bytes - number of bytes of transaction (unused, transaction resumed from descriptor)
+** \return Boolean indicating success/fail of read attempt
+**/
+static bool I2C_rd_sink(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+{
+	I2C_CHUNKS * const			ck = (I2C_CHUNKS *) data;
+	I2C_BUS * const				bus = I2C_BUS_SEL(slave->cfg.bus);
+	const I2C_BUS_OPS * const	ops = bus->ops;
+	const uint16_t				addr = (uint16_t) (ck->base + ck->done);
+	const uint32_t				from = ck->done;
+
+	(void) reg_addr;
+	(void) bytes;
+
+	if (ck->done >= ck->end)	{ return true; }	// Everything given to sink, stop condition failed
+
+	if ((!ops->xfer) && (I2C_snd_reg(bus, slave, addr, I2C_READ) == false))	{ return false; }
+
+	while (ck->done < ck->end)
+	{
+		const uint16_t	nb = ((ck->end - ck->done) < CI2C_CHUNK_SIZE) ? (uint16_t) (ck->end - ck->done) : CI2C_CHUNK_SIZE;
+		const bool		last = ((ck->done + nb) == ck->end);
+
+		I2C_arm_deadline(bus, nb);	// Sink time not accounted
+		if (ops->xfer)
+		{
+			const I2C_SEG seg = { ck->buf, nb };
+			if (I2C_xfer_segs(bus, slave, (uint16_t) (ck->base + ck->done), &seg, 0, nb, I2C_READ) == false)	{ return false; }
+		}
+		else if (I2C_bus_rd(bus, ck->buf, nb, last) == false)	{ return false; }
+
+		if (ck->fct.sink(ck->ctx, ck->buf, nb) == false)
+		{
+			uint8_t dummy;
+
+			if ((!ops->xfer) && (!last))	{ (void) ops->rd8(bus, &dummy, false); }	// Last byte not acknowledged before stop condition
+			return I2C_chunks_abort(bus, !ops->xfer);
+		}
+		ck->done += nb;
+	}
+
+	if (!ops->xfer)
+	{
+		if (ops->stop(bus) == false)								{ return false; }
+		I2C_chunks_reg_end(bus, slave, addr, ck->end - from);
+	}
+
+	return true;
+}
+
+
+/*!\brief (Re)Start interrupt driven transaction from its beginning
+** \return nothing
+**/
+static void I2C_it_launch(void)
+{
+	I2C_SLAVE *	slave = i2c_it.slave;
+	const bool	elide = I2C_slave_reg_begin(&i2c, slave, i2c_it.reg_addr) && (i2c_it.rw == I2C_READ);	// Write always sends address
+
+	i2c_it.data = i2c_it.buf;
+	i2c_it.bytes = i2c_it.nb;
+	i2c_it.reg_nb = 0;
+	i2c_it.reg_idx = 0;
+	i2c_it.ctl_nb = I2C_mux_plan(&i2c, slave, i2c_it.ctl);
+	i2c_it.ctl_idx = 0;
+	i2c_it.ctl_val = false;
+
+	if ((slave->cfg.reg_size) && (!elide))	// Don't send address if reading next
+	{
+		if (slave->cfg.reg_size >= I2C_16B_REG)	{ i2c_it.reg[i2c_it.reg_nb++] = (uint8_t) (i2c_it.reg_addr >> 8); }
+		i2c_it.reg[i2c_it.reg_nb++] = (uint8_t) i2c_it.reg_addr;
+	}
+
+	i2c_it.phase = ((i2c_it.rw == I2C_READ) && (i2c_it.reg_nb == 0)) ? I2C_READ : I2C_WRITE;
+
+	i2c_it.wait = false;
+	i2c_it.t_arm = (uint32_t) micros();
+	i2c_it.budget = ((uint32_t) i2c_it.nb + (2 * i2c_it.ctl_nb) + CI2C_XFER_OVERHEAD) * ((2 * i2c.byte_us) + i2c.cfg.stretch);
+
+	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+}
+
+/*!\brief Send STOP condition of interrupt driven transaction (STOP takes a few cycles, TWINT won't be set after it)
+** \return true if STOP condition sent (false if bus is stuck: bus reset)
+**/
+static bool I2C_it_stop(void)
+{
+	const uint32_t start = (uint32_t) micros();
+
+	TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA) | (1 << TWSTO);
+	while ((TWCR & (1 << TWSTO)))	// Bounded to a byte time (and clock stretching allowance)
+	{
+		if (((uint32_t) micros() - start) > ((uint32_t) i2c.byte_us + i2c.cfg.stretch))	{ I2C_timed_out(); return false; }
+	}
+
+	return true;
+}
+
+/*!\brief Complete interrupt driven transaction (release bus and call completion callback)
+** \param [in] status - transaction final status
+** \return nothing
+**/
+static void I2C_it_done(const I2C_STATUS status)
+{
+	I2C_SLAVE *				slave = i2c_it.slave;
+	const ci2c_cb_fct_ptr	cb = i2c_it.cb;
+	const bool				ack = (status == I2C_OK);
+
+#if CI2C_STATS
+	I2C_stat_xfer(slave, ack, i2c_it.nb, i2c_it.t_start);
+#endif
+
+	I2C_slave_speed_track(slave, ack);
+	I2C_slave_breaker_track(slave, ack);
+	slave->status = status;
+	i2c_it.slave = NULL;
+	i2c_it.wait = false;
+	I2C_release(&i2c);	// Released before callback (allows to chain transactions from callback)
+	if (cb)		{ cb(slave, status); }
+}
+
+/*!\brief Terminate interrupt driven transaction attempt (completed on success or when no retries left, retry delayed otherwise)
+** \param [in] ack - true if transaction succeeded
+** \return nothing
+**/
+static void I2C_it_end(const bool ack)
+{
+	if ((ack) && (I2C_it_stop()))
+	{
+		I2C_slave_reg_end(&i2c, i2c_it.slave, i2c_it.reg_addr, i2c_it.nb);
+		I2C_it_done(I2C_OK);
+	}
+	else if (i2c_it.retry != 0)	// Attempt relaunched by I2C_async_process once retry delay elapsed
+	{
+		i2c_it.retry--;
+		I2C_STAT_INC(retries);
+		i2c_it.wait = true;
+		i2c_it.t_arm = (uint32_t) micros();
+	}
+	else	{ I2C_it_done(I2C_NACK); }
+}
+
+/*!\brief Mux control register write step of asynchronous transaction (value sent, then STOP switching channels & START of next write or transaction)
+** \attribute inline
+** \return nothing
+**/
+static inline void __attribute__((__always_inline__)) I2C_it_mux(void)
+{
+	if (!i2c_it.ctl_val)
+	{
+		TWDR = i2c_it.ctl[i2c_it.ctl_idx].sel;
+		i2c_it.ctl_val = true;
+		TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+		return;
+	}
+
+	if (!I2C_it_stop())	{ I2C_it_end(false); return; }
+	I2C_mux_done(&i2c, &i2c_it.ctl[i2c_it.ctl_idx++]);
+	i2c_it.ctl_val = false;
+	TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+}
+
+/*!\brief Master asynchronous transactions state machine (TWI interrupt)
+** \attribute inline
+** \return nothing
+**/
+static inline void __attribute__((__always_inline__)) I2C_it_master(void)
+{
+	switch (TWI_STATUS)
+	{
+		case START:
+		case REPEATED_START:
+			if (i2c_it.ctl_idx < i2c_it.ctl_nb)	{ TWDR = (uint8_t) (i2c_it.ctl[i2c_it.ctl_idx].mux->addr << 1); }	// Mux control register write
+			else								{ TWDR = (uint8_t) ((I2C_slave_get_xfer_addr(i2c_it.slave) << 1) | i2c_it.phase); }
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+			break;
+
+		case MT_SLA_ACK:
+		case MT_DATA_ACK:
+			if (i2c_it.ctl_idx < i2c_it.ctl_nb)	{ I2C_it_mux(); }
+			else if (i2c_it.reg_idx < i2c_it.reg_nb)
+			{
+				TWDR = i2c_it.reg[i2c_it.reg_idx++];
+				TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+			}
+			else if (i2c_it.rw == I2C_READ)	// Register address sent, go on with repeated start
+			{
+				i2c_it.phase = I2C_READ;
+				TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN) | (1 << TWIE);
+			}
+			else if (i2c_it.bytes != 0)
+			{
+				TWDR = *i2c_it.data++;
+				i2c_it.bytes--;
+				TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE);
+			}
+			else	{ I2C_it_end(true); }
+			break;
+
+		case MR_DATA_ACK:
+			*i2c_it.data++ = TWDR;
+			// fall through
+		case MR_SLA_ACK:
+			if (--i2c_it.bytes != 0)	{ TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE) | (1 << TWEA); }
+			else						{ TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE); }	// NACK last byte
+			break;
+
+		case MR_DATA_NACK:
+			*i2c_it.data++ = TWDR;
+			I2C_it_end(true);
+			break;
+
+		case LOST_ARBTRTN:
+			I2C_recover();
+			I2C_it_end(false);
+			break;
+
+		default:	// SLA/DATA NACK, bus error
+			I2C_STAT_INC(nacks);
+			(void) I2C_it_stop();
+			I2C_it_end(false);
+			break;
 	}
+}
 
-	if (I2C_stop() == false)										{ return false; }
+/*!\brief End of slave transaction (restart pending asynchronous master transaction if any)
+** \attribute inline
+** \return true if master transaction restarted
+**/
+static inline bool __attribute__((__always_inline__)) I2C_it_slave_end(void)
+{
+	i2c_slv.active = false;
+	if (!i2c_slv.resume)	{ return false; }
 
+	i2c_slv.resume = false;
+	I2C_it_launch();
 	return true;
 }
 
+/*!\brief Slave receiver/transmitter state machine (TWI interrupt), registers map served in place
+** \attribute inline
+** \return nothing
+**/
+static inline void __attribute__((__always_inline__)) I2C_it_slave(void)
+{
+	uint8_t ack = (1 << TWEA);	// Acknowledge next byte
+
+	switch (TWI_STATUS)
+	{
+		case SR_ARB_SLA_ACK:
+		case SR_ARB_GCALL_ACK:
+			i2c_slv.resume = i2c.busy;
+			// fall through
+		case SR_SLA_ACK:
+		case SR_GCALL_ACK:
+			i2c_slv.active = true;
+			i2c_slv.addr_cnt = (uint8_t) i2c_slv.reg_size;
+			i2c_slv.wr_cnt = 0;
+			break;
+
+		case SR_DATA_ACK:
+		case SR_GCALL_DATA_ACK:
+			if (i2c_slv.addr_cnt)	// Register address byte (MSB first)
+			{
+				if (i2c_slv.addr_cnt-- == i2c_slv.reg_size)	{ i2c_slv.ptr = TWDR; }
+				else										{ i2c_slv.ptr = (uint16_t) ((i2c_slv.ptr << 8) | TWDR); }
+			}
+			else if (i2c_slv.ptr < i2c_slv.size)
+			{
+				if (i2c_slv.wr_cnt++ == 0)	{ i2c_slv.wr_start = i2c_slv.ptr; }
+				i2c_slv.regs[i2c_slv.ptr++] = TWDR;
+			}
+			if ((i2c_slv.addr_cnt == 0) && (i2c_slv.ptr >= i2c_slv.size))	{ ack = 0; }	// No room for next byte
+			break;
+
+		case SR_STOP:				// STOP or repeated START
+		case SR_DATA_NACK:			// Not addressed anymore (no STOP reported)
+		case SR_GCALL_DATA_NACK:
+			if ((i2c_slv.wr_cnt) && (i2c_slv.on_write))	{ i2c_slv.on_write(i2c_slv.wr_start, i2c_slv.wr_cnt); }
+			i2c_slv.wr_cnt = 0;
+			if (I2C_it_slave_end())	{ return; }
+			break;
+
+		case ST_ARB_SLA_ACK:
+			i2c_slv.resume = i2c.busy;
+			// fall through
+		case ST_SLA_ACK:
+			i2c_slv.active = true;
+			// fall through
+		case ST_DATA_ACK:
+			if (i2c_slv.ptr < i2c_slv.size)	{ TWDR = i2c_slv.regs[i2c_slv.ptr++]; }
+			else							{ TWDR = 0xFF; }
+			break;
+
+		case ST_DATA_NACK:
+		case ST_LAST_DATA:
+			if (I2C_it_slave_end())	{ return; }
+			break;
+
+		default:	// Bus error
+			i2c_slv.active = false;
+			TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE) | (1 << TWEA) | (1 << TWSTO);
+			return;
+	}
+
+	TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWIE) | ack;
+}
+
+/*!\brief TWI interrupt vector (shared by master asynchronous transactions & slave mode)
+** \isr TWI_vect: TWI interrupt
+** \return nothing
+**/
+ISR(TWI_vect)
+{
+	I2C_TRACE(TWI_STATUS);
+
+	if ((TWI_STATUS >= SR_SLA_ACK) || (!i2c.busy))	{ I2C_it_slave(); }
+	else											{ I2C_it_master(); }
+}
@@ -30,6 +30,62 @@ extern "C" {
 
 #define DEF_CI2C_NB_RETRIES		3		//!< Default cI2C transaction retries
 #define DEF_CI2C_TIMEOUT		100		//!< Default cI2C timeout
+#define DEF_CI2C_STRETCH		20		//!< Default cI2C clock stretching allowance per byte (us)
+
+#ifndef CI2C_STATS
+#define CI2C_STATS				0		//!< cI2C instrumentation (slaves statistics & bus events trace), to be defined for whole build (compiler flags)
+#endif
+
+#ifndef CI2C_TRACE_SIZE
+#define CI2C_TRACE_SIZE			32		//!< cI2C bus events trace ring size (when CI2C_STATS is enabled)
+#endif
+
+#define CI2C_TRACE_TIMEOUT		0x01	//!< Pseudo TWI status traced on timeout
+
+#ifndef CI2C_ADAPTIVE
+#define CI2C_ADAPTIVE			0		//!< cI2C slaves adaptive speed (I2C_slave_set_adaptive, 4 more bytes per slave), to be defined for whole build (compiler flags)
+#endif
+
+#ifndef CI2C_BREAKER
+#define CI2C_BREAKER			0		//!< cI2C slaves circuit breaker (I2C_slave_set_breaker, 4 more bytes per slave), to be defined for whole build (compiler flags)
+#endif
+
+#ifndef CI2C_MUX
+#define CI2C_MUX				0		//!< cI2C slaves behind bus multiplexers (I2C_slave_set_mux, 3 more bytes per slave), to be defined for whole build (compiler flags)
+#endif
+
+#ifndef CI2C_SPEED_FAILS
+#define CI2C_SPEED_FAILS		2		//!< Consecutive failed transactions before an adaptive slave speed is stepped down
+#endif
+
+#ifndef CI2C_SPEED_PROBE
+#define CI2C_SPEED_PROBE		64		//!< Successful transactions before a stepped down adaptive slave speed is probed one step up
+#endif
+
+#define CI2C_SPEED_MAX_DROP		3		//!< Max adaptive slave speed steps down (speed halved on each step)
+
+#ifndef CI2C_BREAKER_PROBE
+#define CI2C_BREAKER_PROBE		100		//!< Time between half-open attempts to a slave with circuit breaker open (ms)
+#endif
+
+#define CI2C_SCAN_FIRST			0x08	//!< First address probed by bus scan
+#define CI2C_SCAN_LAST			0x77	//!< Last address probed by bus scan
+#define CI2C_SCAN_MAP_SIZE		16		//!< Bus scan presence bitmap size (bytes)
+
+#define CI2C_MUX_CHANNELS		8		//!< Channels of a mux (one control register bit per downstream channel)
+
+#ifndef CI2C_CHUNK_SIZE
+#define CI2C_CHUNK_SIZE			32		//!< Chunk buffer size of source / sink transfers & copies (bytes, may be overridden through compiler flags)
+#endif
+
+#ifndef CI2C_XFER_SEGS
+#define CI2C_XFER_SEGS			8		//!< Max non empty segments of a vectored transfer on message level buses (Linux i2c-dev), may be overridden through compiler flags
+#endif
+
+#define I2C_MSG_RD				0x01	//!< Message flag: read message (write otherwise)
+#define I2C_MSG_STOP			0x02	//!< Message flag: stop condition after message (next message starts with a START instead of a repeated START)
+#define I2C_MSG_IGNORE_NACK		0x04	//!< Message flag: NACK doesn't fail transfer (message cut short, next message starts with a START)
+#define I2C_MSG_NOSTART			0x08	//!< Message flag: message continues previous one (no START nor address, same slave & direction)
 
 
 /*!\enum enI2C_RW
@@ -61,7 +117,9 @@ typedef enum __attribute__((__packed__)) enI2C_SPEED {
 typedef enum __attribute__((__packed__)) enI2C_STATUS {
 	I2C_OK = 0x00,	//!< I2C OK
 	I2C_BUSY,		//!< I2C Bus busy
-	I2C_NACK		//!< I2C Not Acknowledge
+	I2C_NACK,		//!< I2C Not Acknowledge
+	I2C_PEC_ERR,	//!< I2C Packet Error Code mismatch (SMBus, ci2c_smbus.h)
+	I2C_TIMEOUT		//!< I2C asynchronous transaction aborted past its deadline (I2C_async_process)
 } I2C_STATUS;
 
 /*!\enum enI2C_INT_SIZE
@@ -76,6 +134,114 @@ typedef enum __attribute__((__packed__)) enI2C_INT_SIZE {
 
 
 typedef bool (*ci2c_fct_ptr) (void*, const uint16_t, uint8_t*, const uint16_t);	//!< i2c read/write function pointer typedef
+typedef void (*ci2c_cb_fct_ptr) (void*, const I2C_STATUS);						//!< i2c asynchronous transaction completion callback typedef
+typedef void (*ci2c_reg_cb_fct_ptr) (const uint16_t, const uint16_t);			//!< i2c slave mode registers written hook typedef (first register address, number of registers)
+typedef bool (*ci2c_src_fct_ptr) (void*, uint8_t*, const uint16_t);			//!< i2c chunked write source typedef (context, buffer to fill, number of bytes), false to abort transfer
+typedef bool (*ci2c_sink_fct_ptr) (void*, const uint8_t*, const uint16_t);		//!< i2c chunked read sink typedef (context, bytes read, number of bytes), false to abort transfer
+
+
+/*!\struct StructI2CSeg
+** \brief ci2c vectored transfer segment (scatter / gather buffer)
+**/
+typedef struct StructI2CSeg {
+	uint8_t *			data;		//!< Segment data
+	uint16_t			len;		//!< Segment length in bytes (may be 0)
+} I2C_SEG;
+
+/*!\struct StructI2CMsg
+** \brief ci2c combined transfer message (one address phase, then data phase)
+**/
+typedef struct StructI2CMsg {
+	uint8_t				addr;		//!< 7 bits slave address
+	uint8_t				flags;		//!< Message flags (I2C_MSG_xxx)
+	uint16_t			len;		//!< Data length in bytes (0 for address only write, at least 1 for read)
+	uint8_t *			data;		//!< Data to write / read
+} I2C_MSG;
+
+
+struct StructI2CBus;
+struct StructI2CMux;
+
+/*!\struct StructI2CBusOps
+** \brief ci2c bus backend operations (low level functions of a bus)
+**/
+typedef struct StructI2CBusOps {
+	uint16_t	(*set_speed)(struct StructI2CBus *, const uint16_t);		//!< Set bus clock (returns configured speed in KHz)
+	bool		(*start)(struct StructI2CBus *);							//!< Send (repeated) start condition
+	bool		(*stop)(struct StructI2CBus *);								//!< Send stop condition
+	bool		(*sndSla)(struct StructI2CBus *, const uint8_t);			//!< Send address byte (true if acknowledged)
+	bool		(*wr8)(struct StructI2CBus *, const uint8_t);				//!< Send data byte (true if acknowledged)
+	bool		(*rd8)(struct StructI2CBus *, uint8_t *, const bool);		//!< Receive data byte, acknowledged if ack (true if received)
+	bool		(*wr_burst)(struct StructI2CBus *, const uint8_t *, const uint16_t);	//!< Send data bytes (true if all acknowledged, NULL: wr8 called for each byte)
+	bool		(*rd_burst)(struct StructI2CBus *, uint8_t *, const uint16_t, const bool);	//!< Receive data bytes, last one not acknowledged if last (true if all received, NULL: rd8 called for each byte)
+	bool		(*xfer)(struct StructI2CBus *, const I2C_MSG *, const uint16_t);			//!< Transfer whole messages list at once (true if transferred, NULL: byte level operations used, which may be NULL otherwise)
+} I2C_BUS_OPS;
+
+/*!\struct StructI2CBus
+** \brief ci2c bus config, control parameters & backend
+**/
+typedef struct StructI2CBus {
+	const I2C_BUS_OPS *	ops;		//!< Backend operations
+	/*!\struct cfg
+	** \brief ci2c bus parameters
+	**/
+	struct {
+		I2C_SPEED		speed;		//!< i2c bus speed
+		uint8_t			retries;	//!< i2c message retries when fail
+		uint16_t		timeout;	//!< i2c timeout of low level functions used on their own (ms)
+		uint16_t		stretch;	//!< i2c clock stretching allowance per byte (us)
+	} cfg;
+	uint16_t			clk;		//!< speed currently clocking bus (slave speed profile or bus speed, KHz)
+	uint16_t			byte_us;	//!< byte duration on bus (us, derived from clk)
+	uint32_t			start_wait;	//!< time start waiting (us)
+	uint32_t			budget;		//!< time allowed since start_wait (us)
+	uint8_t				spin;		//!< polling loops left before next time check
+	bool				xfer;		//!< true if a transaction deadline is armed (low level functions don't re-arm timeout)
+	uint8_t				retry;		//!< retries left for current transaction
+	bool				nack;		//!< set by backend when a byte is not acknowledged (stop condition sent, bus left idle)
+	uint16_t			gen;		//!< Bus generation (changed on reset or foreign access, slaves internal pointers tracked in previous ones become unknown)
+	struct StructI2CMux *	mux;	//!< Mux with a channel possibly enabled (disabled before a channel of another mux is selected)
+	volatile bool		busy;		//!< true if bus already owned (by a blocking transaction or by the interrupt engine)
+} I2C_BUS;
+
+/*!\struct StructI2CMux
+** \brief ci2c bus multiplexer (TCA9548A like: single control register, one bit enabling each downstream channel, applied on STOP)
+**/
+typedef struct StructI2CMux {
+	I2C_BUS *			bus;		//!< Upstream bus (NULL for hardware TWI)
+	uint8_t				addr;		//!< 7 bits mux address
+	uint8_t				sel;		//!< Control register value last written (enabled channels)
+	uint16_t			gen;		//!< Bus generation sel was written in (selection known while equal to bus one, 0: unknown)
+	uint32_t			writes;		//!< Number of control register writes
+} I2C_MUX;
+
+
+#if CI2C_STATS
+/*!\struct StructI2CSlaveStats
+** \brief ci2c slave statistics
+**/
+typedef struct __attribute__((__packed__)) StructI2CSlaveStats {
+	uint32_t			xfers;		//!< Number of transactions
+	uint32_t			bytes;		//!< Number of data bytes transferred (successful transactions)
+	uint32_t			time_cumul;	//!< Cumulated transactions time (us)
+	uint32_t			time_max;	//!< Max transaction time (us)
+	uint16_t			nacks;		//!< Number of NACKs received
+	uint16_t			retries;	//!< Number of transaction retries
+	uint16_t			timeouts;	//!< Number of timeouts
+	uint16_t			arb_lost;	//!< Number of arbitration losses
+	uint16_t			resets;		//!< Number of bus resets
+	uint16_t			fast_fails;	//!< Number of transactions failed without touching bus (circuit breaker open)
+} I2C_SLAVE_STATS;
+
+/*!\struct StructI2CTraceEvt
+** \brief ci2c bus event (traced from low level functions & interrupt)
+**/
+typedef struct StructI2CTraceEvt {
+	uint32_t			time;		//!< Event time (us)
+	uint8_t				status;		//!< TWI status (or CI2C_TRACE_TIMEOUT)
+	uint8_t				addr;		//!< Slave address (0xFF if unknown)
+} I2C_TRACE_EVT;
+#endif
 
 
 /*!\struct StructI2CSlave
@@ -91,11 +257,80 @@ typedef struct __attribute__((__packed__)) StructI2CSlave {
 		I2C_INT_SIZE	reg_size;	//!< Slave internal registers size
 		ci2c_fct_ptr	wr;			//!< Slave write function pointer
 		ci2c_fct_ptr	rd;			//!< Slave read function pointer
+		uint16_t		page_size;	//!< Slave memory write page size (0 if not a paged memory)
+		uint8_t			blk_bits : 4;	//!< Large memory block number bits in slave address (0 if not a large memory)
+		uint8_t			blk_shift : 4;	//!< Large memory block number position in slave address
+		I2C_BUS *		bus;		//!< Bus slave is connected to (NULL for hardware TWI)
+		uint16_t		speed;		//!< Slave speed profile in KHz (0: bus speed)
+#if CI2C_ADAPTIVE
+		bool			adaptive;	//!< Speed stepped down after failures, then probed back up
+#endif
+#if CI2C_BREAKER
+		uint8_t			breaker;	//!< Consecutive failed transactions opening circuit breaker (0: no circuit breaker)
+#endif
+#if CI2C_MUX
+		I2C_MUX *		mux;		//!< Mux slave is reachable through (NULL if directly on bus)
+		uint8_t			chan;		//!< Mux channel slave is connected to
+#endif
+		bool			pec;		//!< SMBus Packet Error Code appended to transactions (ci2c_smbus.h)
 	} cfg;
+	uint8_t				twbr;		//!< Precomputed hardware TWI bit rate register (slave speed profile)
+	uint8_t				twps;		//!< Precomputed hardware TWI prescaler bits (slave speed profile)
+#if CI2C_ADAPTIVE
+	uint8_t				drop;		//!< Speed steps down (adaptive speed)
+	uint8_t				fails;		//!< Consecutive failed transactions (adaptive speed)
+	uint8_t				probe;		//!< Successful transactions left before probing one speed step up (adaptive speed)
+#endif
+#if CI2C_BREAKER
+	uint8_t				brk_cnt;	//!< Consecutive failed transactions (circuit breaker)
+	uint16_t			brk_time;	//!< Circuit breaker opening or last half-open attempt time (ms)
+#endif
 	uint16_t			reg_addr;	//!< Internal current register address
+	uint16_t			reg_gen;	//!< Bus generation reg_addr was confirmed in (internal pointer known while equal to bus one, 0: unknown)
+	uint8_t				blk;		//!< Current large memory block (set in slave address of transactions, reg_addr belongs to it)
 	I2C_STATUS			status;		//!< Status of the last communications
+#if CI2C_STATS
+	I2C_SLAVE_STATS		stats;		//!< Slave statistics
+#endif
 } I2C_SLAVE;
 
+/*!\struct StructI2CReq
+** \brief ci2c batched read request (I2C_read_batch)
+**/
+typedef struct StructI2CReq {
+	I2C_SLAVE *			slave;		//!< Pointer to the I2C slave structure
+	uint16_t			reg_addr;	//!< Register address in register map
+	uint8_t *			data;		//!< Pointer to the first byte of data block to read
+	uint16_t			bytes;		//!< Number of bytes to read
+	I2C_STATUS			status;		//!< Read status (set by I2C_read_batch)
+} I2C_REQ;
+
+/*!\struct StructI2CSlaveDesc
+** \brief ci2c constant slave descriptor (immutable configuration, to be placed in program memory with PROGMEM)
+** \note Fields left out of an initializer are 0 / NULL: default bus (I2C_set_default_bus), no mux, default read/write functions
+**/
+typedef struct StructI2CSlaveDesc {
+	uint8_t				addr;		//!< Slave address
+	I2C_INT_SIZE		reg_size;	//!< Slave internal registers size
+	uint16_t			page_size;	//!< Slave memory write page size (0 if not a paged memory, power of 2 otherwise)
+	I2C_BUS *			bus;		//!< Bus slave is connected to (NULL for default bus, hardware TWI unless changed by I2C_set_default_bus)
+	I2C_MUX *			mux;		//!< Mux slave is reachable through (NULL if directly on bus, ignored unless built with CI2C_MUX)
+	uint8_t				chan;		//!< Mux channel slave is connected to
+	ci2c_fct_ptr		wr;			//!< Slave write function pointer (NULL for default)
+	ci2c_fct_ptr		rd;			//!< Slave read function pointer (NULL for default)
+} I2C_SLAVE_DESC;
+
+/*!\struct StructI2CCSlave
+** \brief ci2c constant slave (runtime state in RAM, configuration read from program memory descriptor)
+** \attribute packed struct
+**/
+typedef struct __attribute__((__packed__)) StructI2CCSlave {
+	const I2C_SLAVE_DESC *	desc;	//!< Slave descriptor (program memory)
+	uint16_t			reg_addr;	//!< Internal current register address
+	uint16_t			reg_gen;	//!< Bus generation reg_addr was confirmed in (0: unknown)
+	I2C_STATUS			status;		//!< Status of the last communications
+} I2C_CSLAVE;
+
 
 /***************************/
 /*** I2C SLAVE FUNCTIONS ***/
@@ -131,6 +366,79 @@ bool I2C_slave_set_addr(I2C_SLAVE * slave, const uint8_t sl_addr);
 **/
 bool I2C_slave_set_reg_size(I2C_SLAVE * slave, const I2C_INT_SIZE reg_sz);
 
+/*!\brief Change I2C slave memory page size (paged memory mode)
+** \details When set, writes are split at page boundaries, each page being followed by acknowledge polling
+**			 (until memory internal write cycle ends) instead of relying on delayed retries.
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] page_size - memory write page size (0 if slave is not a paged memory)
+** \return true if new page size set (false if page size is not a power of 2, paged mode disabled then)
+**/
+bool I2C_slave_set_page_size(I2C_SLAVE * slave, const uint16_t page_size);
+
+/*!\brief Change I2C slave large memory mode (memory spanning several slave addresses)
+** \details Memory is made of 2^\b bits blocks of register space size (256 bytes or 64KB), block number being set in slave address
+**			 at bit \b shift (e.g. 24LC1025: 1 bit at 2, AT24CM01: 1 bit at 0, 24C16: 3 bits at 0). Memory is then accessed with
+**			 32 bits addresses (I2C_read_mem / I2C_write_mem), block accessed being set in slave address of transactions
+**			 (slave address itself unchanged, register functions access current block: I2C_slave_get_mem_addr).
+** \param [in, out] slave - pointer to the I2C slave structure (address of block 0)
+** \param [in] bits - number of block number bits (0 to disable large memory mode)
+** \param [in] shift - block number bits position in slave address
+** \return true if set (false if slave has no register address or block bits exceed 7 bits address, large memory mode disabled then)
+**/
+bool I2C_slave_set_blocks(I2C_SLAVE * slave, const uint8_t bits, const uint8_t shift);
+
+/*!\brief Change I2C slave speed profile (bus clocked at this speed for slave transactions only)
+** \details Hardware TWI clock registers are computed once here: bus clock is only rewritten by transactions
+**			 when previous transaction on the bus used a different speed.
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] speed - I2C slave speed in KHz (max 400KHz, 0 to use bus speed)
+** \return Configured slave speed (actual hardware TWI clock, 0 if bus speed)
+**/
+uint16_t I2C_slave_set_speed(I2C_SLAVE * slave, const uint16_t speed);
+
+/*!\brief Enable/disable I2C slave adaptive speed
+** \details Speed is halved after CI2C_SPEED_FAILS consecutive failed transactions (CI2C_SPEED_MAX_DROP times max),
+**			 and probed back one step up after CI2C_SPEED_PROBE successful transactions.
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] adaptive - true to enable adaptive speed
+** \return true if set (false if slave has no speed profile or adaptive speed is not built: CI2C_ADAPTIVE)
+**/
+bool I2C_slave_set_adaptive(I2C_SLAVE * slave, const bool adaptive);
+
+/*!\brief Change I2C slave circuit breaker threshold
+** \details Once open (after \b fails consecutive failed transactions), slave transactions fail fast (I2C_NACK without touching bus),
+**			 except one half-open attempt (no retries) every CI2C_BREAKER_PROBE ms; breaker is closed by any successful transaction or probe.
+** \param [in, out] slave - pointer to the I2C slave structure
+** \note No effect unless built with CI2C_BREAKER
+** \param [in] fails - consecutive failed transactions opening breaker (0 to disable circuit breaker)
+** \return nothing
+**/
+void I2C_slave_set_breaker(I2C_SLAVE * slave, const uint8_t fails);
+
+/*!\brief Probe I2C slave presence (address only transaction, no retries), circuit breaker closed if acknowledged
+** \note May be called in background (idle loop) on slaves with open circuit breaker to re-enable them as soon as they're back
+** \param [in, out] slave - pointer to the I2C slave structure
+** \return I2C_STATUS status of probe (I2C_OK if present, I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_slave_probe(I2C_SLAVE * slave);
+
+/*!\brief Change I2C bus slave is connected to
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \return nothing
+**/
+void I2C_slave_set_bus(I2C_SLAVE * slave, I2C_BUS * bus);
+
+/*!\brief Change I2C mux channel slave is reachable through (slave attached to mux upstream bus)
+** \details Channel is selected before each slave transaction (blocking or interrupt driven), control register being written only
+**			 when selection changed (channels of the mux previously used on the bus are disabled first, same addresses may sit behind both).
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] mux - pointer to the I2C mux structure (NULL if slave is directly on bus)
+** \param [in] chan - mux channel slave is connected to
+** \return true if set (false if channel is out of range or mux given while not built with CI2C_MUX, slave left unchanged)
+**/
+bool I2C_slave_set_mux(I2C_SLAVE * slave, I2C_MUX * mux, const uint8_t chan);
+
 /*!\brief Get I2C slave address
 ** \attribute inline
 ** \param [in] slave - pointer to the I2C slave structure
@@ -139,6 +447,14 @@ bool I2C_slave_set_reg_size(I2C_SLAVE * slave, const I2C_INT_SIZE reg_sz);
 inline uint8_t __attribute__((__always_inline__)) I2C_slave_get_addr(const I2C_SLAVE * slave) {
 	return slave->cfg.addr; }
 
+/*!\brief Get I2C slave address of transactions (large memory mode: current block set in slave address)
+** \attribute inline
+** \param [in] slave - pointer to the I2C slave structure
+** \return I2C slave address on bus
+**/
+inline uint8_t __attribute__((__always_inline__)) I2C_slave_get_xfer_addr(const I2C_SLAVE * slave) {
+	return (uint8_t) (slave->cfg.addr | (slave->blk << slave->cfg.blk_shift)); }
+
 /*!\brief Get I2C register map size (for access)
 ** \attribute inline
 ** \param [in] slave - pointer to the I2C slave structure
@@ -147,7 +463,73 @@ inline uint8_t __attribute__((__always_inline__)) I2C_slave_get_addr(const I2C_S
 inline bool __attribute__((__always_inline__)) I2C_slave_get_reg_size(const I2C_SLAVE * slave) {
 	return slave->cfg.reg_size; }
 
+/*!\brief Get I2C slave memory page size
+** \attribute inline
+** \param [in] slave - pointer to the I2C slave structure
+** \return memory write page size (0 if not a paged memory)
+**/
+inline uint16_t __attribute__((__always_inline__)) I2C_slave_get_page_size(const I2C_SLAVE * slave) {
+	return slave->cfg.page_size; }
+
+/*!\brief Get I2C slave memory size (large memory mode)
+** \attribute inline
+** \param [in] slave - pointer to the I2C slave structure
+** \return memory size in bytes (register space size if not a large memory)
+**/
+inline uint32_t __attribute__((__always_inline__)) I2C_slave_get_mem_size(const I2C_SLAVE * slave) {
+	return 1UL << ((8 * slave->cfg.reg_size) + slave->cfg.blk_bits); }
+
+/*!\brief Get I2C slave current speed (speed profile, stepped down if adaptive speed dropped it)
+** \attribute inline
+** \param [in] slave - pointer to the I2C slave structure
+** \return slave speed in KHz (0 if bus speed)
+**/
+inline uint16_t __attribute__((__always_inline__)) I2C_slave_get_speed(const I2C_SLAVE * slave) {
+#if CI2C_ADAPTIVE
+	return slave->cfg.speed >> slave->drop;
+#else
+	return slave->cfg.speed;
+#endif
+}
+
+/*!\brief Test if I2C slave circuit breaker is open (slave transactions fail fast)
+** \attribute inline
+** \param [in] slave - pointer to the I2C slave structure
+** \return true if open
+**/
+inline bool __attribute__((__always_inline__)) I2C_slave_is_broken(const I2C_SLAVE * slave) {
+#if CI2C_BREAKER
+	return (slave->cfg.breaker != 0) && (slave->brk_cnt >= slave->cfg.breaker);
+#else
+	(void) slave;
+	return false;
+#endif
+}
+
+/*!\brief Get I2C bus slave is connected to
+** \attribute inline
+** \param [in] slave - pointer to the I2C slave structure
+** \return pointer to the I2C bus structure (NULL for hardware TWI)
+**/
+inline I2C_BUS * __attribute__((__always_inline__)) I2C_slave_get_bus(const I2C_SLAVE * slave) {
+	return slave->cfg.bus; }
+
+/*!\brief Get I2C mux slave is reachable through
+** \attribute inline
+** \param [in] slave - pointer to the I2C slave structure
+** \return pointer to the I2C mux structure (NULL if slave is directly on bus)
+**/
+inline I2C_MUX * __attribute__((__always_inline__)) I2C_slave_get_mux(const I2C_SLAVE * slave) {
+#if CI2C_MUX
+	return slave->cfg.mux;
+#else
+	(void) slave;
+	return NULL;
+#endif
+}
+
 /*!\brief Get I2C current register address (addr may passed this way in procedures if contigous accesses)
+** \note After a failed transaction, start address of the failed transaction (internal pointer unknown)
 ** \attribute inline
 ** \param [in] slave - pointer to the I2C slave structure
 ** \return current register map address
@@ -155,6 +537,31 @@ inline bool __attribute__((__always_inline__)) I2C_slave_get_reg_size(const I2C_
 inline uint16_t __attribute__((__always_inline__)) I2C_slave_get_reg_addr(const I2C_SLAVE * slave) {
 	return slave->reg_addr; }
 
+/*!\brief Get I2C current memory address (large memory mode: current block & current register address)
+** \attribute inline
+** \param [in] slave - pointer to the I2C slave structure
+** \return current memory address
+**/
+inline uint32_t __attribute__((__always_inline__)) I2C_slave_get_mem_addr(const I2C_SLAVE * slave) {
+	return ((uint32_t) slave->blk << (8 * slave->cfg.reg_size)) | slave->reg_addr; }
+
+/*!\brief Test if I2C slave internal pointer is known (register address phase skipped when accessing I2C_slave_get_reg_addr)
+** \details Known only after a confirmed transaction (STOP sent) ending below top of register space,
+**			 unknown after any failure, bus reset, foreign access (I2C_xfer_begin, I2C_bus_forget_regs) or while slave mode is started.
+** \param [in] slave - pointer to the I2C slave structure
+** \return true if known
+**/
+bool I2C_slave_reg_addr_known(const I2C_SLAVE * slave);
+
+/*!\brief Forget I2C slave internal pointer (register address sent on next transaction)
+** \note To be called when device pointer may have changed out of cI2C (device reset, access from another library)
+** \attribute inline
+** \param [in, out] slave - pointer to the I2C slave structure
+** \return nothing
+**/
+inline void __attribute__((__always_inline__)) I2C_slave_forget_reg_addr(I2C_SLAVE * slave) {
+	slave->reg_gen = 0; }
+
 
 /*************************/
 /*** I2C BUS FUNCTIONS ***/
@@ -179,11 +586,19 @@ void I2C_uninit();
 uint16_t I2C_set_speed(const uint16_t speed);
 
 /*!\brief Change I2C ack timeout
+** \note Applies to low level functions used on their own, I2C_read / I2C_write use a deadline for the whole transaction,
+**		 derived from bus speed & transfer length (twice bytes duration + clock stretching allowance per byte)
 ** \param [in] timeout - I2C ack timeout (500 ms max)
 ** \return Configured timeout
 **/
 uint16_t I2C_set_timeout(const uint16_t timeout);
 
+/*!\brief Change I2C clock stretching allowance per byte (added to transactions deadline)
+** \param [in] stretch - I2C clock stretching allowance per byte (10000 us max)
+** \return Configured clock stretching allowance
+**/
+uint16_t I2C_set_stretch(const uint16_t stretch);
+
 /*!\brief Change I2C message retries (in case of failure)
 ** \param [in] retries - I2C number of retries (max of 8)
 ** \return Configured number of retries
@@ -195,6 +610,118 @@ uint8_t I2C_set_retries(const uint8_t retries);
 **/
 bool I2C_is_busy(void);
 
+/*!\brief Init an I2C bus structure (default retries, timeout & clock stretching allowance)
+** \param [in, out] bus - pointer to the I2C bus structure to init
+** \param [in] ops - backend operations
+** \param [in] speed - I2C bus speed in KHz
+** \return nothing
+**/
+void I2C_bus_init(I2C_BUS * bus, const I2C_BUS_OPS * ops, const uint16_t speed);
+
+/*!\brief Change I2C bus frequency
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in] speed - I2C bus speed in KHz (max 400KHz)
+** \return Configured bus speed
+**/
+uint16_t I2C_bus_set_speed(I2C_BUS * bus, const uint16_t speed);
+
+/*!\brief Change I2C bus ack timeout (low level functions used on their own)
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in] timeout - I2C ack timeout (500 ms max)
+** \return Configured timeout
+**/
+uint16_t I2C_bus_set_timeout(I2C_BUS * bus, const uint16_t timeout);
+
+/*!\brief Change I2C bus clock stretching allowance per byte (added to transactions deadline)
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in] stretch - I2C clock stretching allowance per byte (10000 us max)
+** \return Configured clock stretching allowance
+**/
+uint16_t I2C_bus_set_stretch(I2C_BUS * bus, const uint16_t stretch);
+
+/*!\brief Change I2C bus message retries (in case of failure)
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in] retries - I2C number of retries (max of 8)
+** \return Configured number of retries
+**/
+uint8_t I2C_bus_set_retries(I2C_BUS * bus, const uint8_t retries);
+
+/*!\brief Get I2C bus busy status
+** \param [in] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \return true if busy
+**/
+bool I2C_bus_is_busy(const I2C_BUS * bus);
+
+/*!\brief Set bus slaves are attached to by I2C_slave_init (drivers kept unchanged when default bus is not hardware TWI)
+** \param [in] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \return nothing
+**/
+void I2C_set_default_bus(I2C_BUS * bus);
+
+/*!\brief Forget internal pointers of all slaves on I2C bus (new bus generation, register address sent on next transaction of each slave)
+** \note Called on bus reset; to be called when bus was accessed out of cI2C (another master, another library)
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \return nothing
+**/
+void I2C_bus_forget_regs(I2C_BUS * bus);
+
+/*!\brief Scan I2C bus: address only transaction (no retries) to each address from CI2C_SCAN_FIRST to CI2C_SCAN_LAST
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in, out] map - presence bitmap to fill (CI2C_SCAN_MAP_SIZE bytes, bit set for each acknowledged address)
+** \return I2C_STATUS status of scan (I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_scan(I2C_BUS * bus, uint8_t * map);
+
+/*!\brief Test presence of an address in a bus scan bitmap
+** \attribute inline
+** \param [in] map - presence bitmap filled by I2C_scan
+** \param [in] addr - 7 bits slave address
+** \return true if address acknowledged during scan
+**/
+inline bool __attribute__((__always_inline__)) I2C_scan_present(const uint8_t * map, const uint8_t addr) {
+	return (map[(addr >> 3) & 0x0F] & (1 << (addr & 0x07))) != 0; }
+
+/*!\brief Combined transfer: messages chained with repeated STARTs under a single bus ownership, single STOP at the end
+** \note Whole list retried in case of failure (bus retries); slaves internal pointers on bus are forgotten
+** \param [in, out] bus - pointer to the I2C bus structure (NULL for hardware TWI)
+** \param [in, out] msgs - pointer to the first message
+** \param [in] nb - number of messages
+** \return I2C_STATUS status of transfer (I2C_BUSY if bus already owned, I2C_NACK on failure or invalid messages)
+**/
+I2C_STATUS I2C_transfer(I2C_BUS * bus, const I2C_MSG * msgs, const uint8_t nb);
+
+/*!\brief Init an I2C mux structure (selection unknown, written on first access to one of its slaves)
+** \param [in, out] mux - pointer to the I2C mux structure to init
+** \param [in] bus - pointer to the upstream I2C bus structure (NULL for hardware TWI)
+** \param [in] addr - 7 bits mux address
+** \return true if initialized (false if address is >7Fh)
+**/
+bool I2C_mux_init(I2C_MUX * mux, I2C_BUS * bus, const uint8_t addr);
+
+/*!\brief Write I2C mux control register (e.g. 0 to disable all channels before a bus scan)
+** \param [in, out] mux - pointer to the I2C mux structure
+** \param [in] sel - enabled channels bitmap
+** \return I2C_STATUS status of write (I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_mux_write(I2C_MUX * mux, const uint8_t sel);
+
+/*!\brief Forget I2C mux selection (control register written on next access to one of its slaves)
+** \note To be called when mux may have been written or reset out of cI2C (I2C_bus_forget_regs forgets all muxes on a bus)
+** \attribute inline
+** \param [in, out] mux - pointer to the I2C mux structure
+** \return nothing
+**/
+inline void __attribute__((__always_inline__)) I2C_mux_forget(I2C_MUX * mux) {
+	mux->gen = 0; }
+
+/*!\brief Order read requests to keep mux channel switches to a minimum (stable: requests order kept on a same channel)
+** \details Requests to slaves directly on bus come first, then those on the channel currently selected, then the others grouped by mux & channel.
+** \param [in, out] reqs - pointer to the first request
+** \param [in] nb - number of requests
+** \return nothing
+**/
+void I2C_mux_order(I2C_REQ * reqs, const uint8_t nb);
+
 /*!\brief This function writes the provided data to the address specified.
 ** \param [in, out] slave - pointer to the I2C slave structure
 ** \param [in] reg_addr - register address in register map
@@ -234,12 +761,300 @@ I2C_STATUS I2C_read(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data,
 inline I2C_STATUS __attribute__((__always_inline__)) I2C_read_next(I2C_SLAVE * slave, uint8_t * data, const uint16_t bytes) {
 	return I2C_read(slave, slave->reg_addr, data, bytes); }
 
+/*!\brief This function writes the provided data to the large memory address specified (I2C_slave_set_blocks)
+** \details Split at block boundaries (slave address switched to each block) & page boundaries (paged memories)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] mem_addr - memory address
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt (I2C_NACK if bytes is 0 or exceeds memory size)
+**/
+I2C_STATUS I2C_write_mem(I2C_SLAVE * slave, const uint32_t mem_addr, uint8_t * data, const uint32_t bytes);
+
+/*!\brief This inline is a wrapper to I2C_write_mem in case of contigous operations
+** \attribute inline
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt
+**/
+inline I2C_STATUS __attribute__((__always_inline__)) I2C_write_mem_next(I2C_SLAVE * slave, uint8_t * data, const uint32_t bytes) {
+	return I2C_write_mem(slave, I2C_slave_get_mem_addr(slave), data, bytes); }
+
+/*!\brief This function reads data from the large memory address specified (I2C_slave_set_blocks)
+** \details Split at block boundaries (slave address switched to each block): internal pointer is tracked across blocks,
+**			 reading on from the end of a block skips register address phase.
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] mem_addr - memory address
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt (I2C_NACK if bytes is 0 or exceeds memory size)
+**/
+I2C_STATUS I2C_read_mem(I2C_SLAVE * slave, const uint32_t mem_addr, uint8_t * data, const uint32_t bytes);
+
+/*!\brief This inline is a wrapper to I2C_read_mem in case of contigous operations
+** \attribute inline
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt
+**/
+inline I2C_STATUS __attribute__((__always_inline__)) I2C_read_mem_next(I2C_SLAVE * slave, uint8_t * data, const uint32_t bytes) {
+	return I2C_read_mem(slave, I2C_slave_get_mem_addr(slave), data, bytes); }
+
+/*!\brief This function writes segments to the address specified, in a single transaction (segments sent back to back)
+** \note Same retries, circuit breaker, speed & paging handling as I2C_write (custom write function not used)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] segs - pointer to the first segment
+** \param [in] nb - number of segments (empty segments skipped)
+** \return I2C_STATUS status of write attempt (I2C_NACK if segments are empty, exceed 65535 bytes or CI2C_XFER_SEGS non empty segments on message level buses)
+**/
+I2C_STATUS I2C_writev(I2C_SLAVE * slave, const uint16_t reg_addr, const I2C_SEG * segs, const uint8_t nb);
+
+/*!\brief This function reads data from the address specified into segments, in a single transaction (segments filled back to back)
+** \note Same retries, circuit breaker & speed handling as I2C_read (custom read function not used)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] segs - pointer to the first segment
+** \param [in] nb - number of segments (empty segments skipped)
+** \return I2C_STATUS status of read attempt (I2C_NACK if segments are empty, exceed 65535 bytes or CI2C_XFER_SEGS non empty segments on message level buses)
+**/
+I2C_STATUS I2C_readv(I2C_SLAVE * slave, const uint16_t reg_addr, const I2C_SEG * segs, const uint8_t nb);
+
+/*!\brief This function writes data pulled from a source to the address specified, by chunks in a single transaction (constant RAM)
+** \details Source is called for each CI2C_CHUNK_SIZE bytes chunk (bus held meanwhile). After a failure, transaction is retried from
+**			 the chunk that failed (source not called again for data already given). Paged memories get a transaction per chunk
+**			 within a page (each followed by acknowledge polling), message level buses (Linux i2c-dev) a transaction per chunk.
+** \note Same retries, circuit breaker & speed handling as I2C_write (custom write function not used)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] bytes - number of bytes to write
+** \param [in] src - source function, filling chunk buffer with exactly the number of bytes asked (false to abort, no retries then)
+** \param [in] ctx - context given to source function
+** \return I2C_STATUS status of write attempt (I2C_NACK if bytes is 0 or transfer aborted)
+**/
+I2C_STATUS I2C_write_src(I2C_SLAVE * slave, const uint16_t reg_addr, const uint32_t bytes, const ci2c_src_fct_ptr src, void * ctx);
+
+/*!\brief This function reads data from the address specified into a sink, by chunks in a single transaction (constant RAM)
+** \details Sink is called for each CI2C_CHUNK_SIZE bytes chunk received (bus held meanwhile). After a failure, transaction is retried
+**			 from the chunk that failed (sink never given a byte twice). Message level buses (Linux i2c-dev) get a transaction per chunk.
+** \note Same retries, circuit breaker & speed handling as I2C_read (custom read function not used)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] bytes - number of bytes to read
+** \param [in] sink - sink function (false to abort, no retries then)
+** \param [in] ctx - context given to sink function
+** \return I2C_STATUS status of read attempt (I2C_NACK if bytes is 0 or transfer aborted)
+**/
+I2C_STATUS I2C_read_sink(I2C_SLAVE * slave, const uint16_t reg_addr, const uint32_t bytes, const ci2c_sink_fct_ptr sink, void * ctx);
+
+/*!\brief This function copies data from a slave to another one (or within a slave), by chunks through a CI2C_CHUNK_SIZE bytes buffer
+** \details Chunks are read with I2C_read (register address phase skipped from the second one on) & written with I2C_write,
+**			 cut at destination page boundaries for paged memories.
+** \warning Source & destination ranges shall not overlap within a same slave (copied forward)
+** \param [in, out] dst - pointer to the destination I2C slave structure
+** \param [in] dst_addr - destination register address
+** \param [in, out] src - pointer to the source I2C slave structure
+** \param [in] src_addr - source register address
+** \param [in] bytes - number of bytes to copy
+** \return I2C_STATUS status of first failed chunk transaction (I2C_NACK if bytes is 0)
+**/
+I2C_STATUS I2C_copy(I2C_SLAVE * dst, const uint16_t dst_addr, I2C_SLAVE * src, const uint16_t src_addr, const uint32_t bytes);
+
+/*!\brief This function performs a batch of reads, ordered by mux channel first (I2C_mux_order)
+** \note Each request status is set (slave status as after I2C_read), requests array is reordered
+** \param [in, out] reqs - pointer to the first request
+** \param [in] nb - number of requests
+** \return number of failed requests (0 if all succeeded)
+**/
+uint8_t I2C_read_batch(I2C_REQ * reqs, const uint8_t nb);
+
+/*!\brief Custom transaction: same bus ownership, speed profile, mux channel, retries, circuit breaker & statistics handling as I2C_read / I2C_write
+** \details \b fc is called for each attempt with bus owned, driving it with backend operations of I2C_slave_get_xfer_bus (no paging,
+**			 slave internal pointer tracking left to \b fc).
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] fc - transaction function
+** \param [in] reg_addr - register address given to \b fc
+** \param [in, out] data - data given to \b fc (may be a transaction descriptor)
+** \param [in] bytes - number of bytes of transaction (deadline computation & statistics)
+** \return I2C_STATUS status of transaction
+**/
+I2C_STATUS I2C_slave_xfer(I2C_SLAVE * slave, const ci2c_fct_ptr fc, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+
+/*!\brief Get bus structure slave transactions go through (hardware TWI bus structure if slave is not attached to another bus)
+** \param [in] slave - pointer to the I2C slave structure
+** \return pointer to the I2C bus structure
+**/
+I2C_BUS * I2C_slave_get_xfer_bus(const I2C_SLAVE * slave);
+
+
+/******************************/
+/*** I2C CONSTANT SLAVES    ***/
+/******************************/
+
+/*!\brief Init an I2C constant slave (configuration kept in program memory descriptor, internal pointer unknown)
+** \param [in, out] cs - pointer to the I2C constant slave structure to init
+** \param [in] desc - pointer to the slave descriptor (program memory)
+** \return nothing
+**/
+void I2C_cslave_init(I2C_CSLAVE * cs, const I2C_SLAVE_DESC * desc);
+
+/*!\brief Write to a constant slave (same handling as I2C_write, without speed profile, adaptive speed, circuit breaker nor statistics)
+** \note Descriptor is read from program memory into a transient slave structure for the transaction (blocking transactions only)
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt
+**/
+I2C_STATUS I2C_cslave_write(I2C_CSLAVE * cs, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+
+/*!\brief Read from a constant slave (same handling as I2C_read, without speed profile, adaptive speed, circuit breaker nor statistics)
+** \note Descriptor is read from program memory into a transient slave structure for the transaction (blocking transactions only)
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt
+**/
+I2C_STATUS I2C_cslave_read(I2C_CSLAVE * cs, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+
+/*!\brief This inline is a wrapper to I2C_cslave_write in case of contigous operations
+** \attribute inline
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt
+**/
+inline I2C_STATUS __attribute__((__always_inline__)) I2C_cslave_write_next(I2C_CSLAVE * cs, uint8_t * data, const uint16_t bytes) {
+	return I2C_cslave_write(cs, cs->reg_addr, data, bytes); }
+
+/*!\brief This inline is a wrapper to I2C_cslave_read in case of contigous operations
+** \attribute inline
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt
+**/
+inline I2C_STATUS __attribute__((__always_inline__)) I2C_cslave_read_next(I2C_CSLAVE * cs, uint8_t * data, const uint16_t bytes) {
+	return I2C_cslave_read(cs, cs->reg_addr, data, bytes); }
+
+/*!\brief Get I2C constant slave current register address
+** \attribute inline
+** \param [in] cs - pointer to the I2C constant slave structure
+** \return current register map address
+**/
+inline uint16_t __attribute__((__always_inline__)) I2C_cslave_get_reg_addr(const I2C_CSLAVE * cs) {
+	return cs->reg_addr; }
+
+/*!\brief Forget I2C constant slave internal pointer (register address sent on next transaction)
+** \attribute inline
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \return nothing
+**/
+inline void __attribute__((__always_inline__)) I2C_cslave_forget_reg_addr(I2C_CSLAVE * cs) {
+	cs->reg_gen = 0; }
+
+
+/*!\brief This function writes the provided data to the address specified (interrupt driven, returns immediately).
+** \note Hardware TWI only (I2C_NACK returned for slaves on other buses)
+** \note Slave status is I2C_BUSY until completion, bus is owned by the transaction until then (I2C_async_process relaunches delayed retries & aborts it past its deadline)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write (shall stay valid until completion)
+** \param [in] bytes - indicates how many bytes of data to write
+** \param [in] cb - callback called (from interrupt) with final status (may be NULL)
+** \return I2C_STATUS status of launch attempt (I2C_OK when launched, I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_write_async(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const ci2c_cb_fct_ptr cb);
+
+/*!\brief This function reads data from the address specified (interrupt driven, returns immediately).
+** \note Hardware TWI only (I2C_NACK returned for slaves on other buses)
+** \note Slave status is I2C_BUSY until completion, bus is owned by the transaction until then (I2C_async_process relaunches delayed retries & aborts it past its deadline)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read (shall stay valid until completion)
+** \param [in] bytes - indicates how many bytes of data to read
+** \param [in] cb - callback called (from interrupt) with final status (may be NULL)
+** \return I2C_STATUS status of launch attempt (I2C_OK when launched, I2C_BUSY if bus already owned)
+**/
+I2C_STATUS I2C_read_async(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const ci2c_cb_fct_ptr cb);
+
+/*!\brief Check asynchronous transaction progress (to be called periodically from loop while a transaction is in progress)
+** \note Failed attempts are relaunched once retry delay (1ms) elapsed, a transaction past its deadline is aborted
+**		(bus reset, callback called with I2C_TIMEOUT): callback may thus be called from this function
+** \return true if an asynchronous transaction is still in progress
+**/
+bool I2C_async_process(void);
+
+
+/***************************/
+/*** I2C SLAVE MODE      ***/
+/***************************/
+
+/*!\brief Start interrupt driven slave mode (registers map served in place from TWI interrupt)
+** \note Registers address is sent first by master (I2C_8B_REG/I2C_16B_REG, MSB first) and auto-incremented on each byte
+**		 (access beyond map is NACKed when written, read as 0xFF).
+** \note Slave mode is suspended while bus is owned by a master transaction (answering again once released)
+** \param [in] addr - own I2C slave address
+** \param [in] reg_sz - internal register map size
+** \param [in, out] regs - registers map (shall stay valid until slave mode is stopped)
+** \param [in] size - registers map size
+** \param [in] on_write - hook called (from interrupt) when master ends writing registers (may be NULL)
+** \return true if slave mode started (false if address is incorrect)
+**/
+bool I2C_slave_mode_start(const uint8_t addr, const I2C_INT_SIZE reg_sz, uint8_t * regs, const uint16_t size, const ci2c_reg_cb_fct_ptr on_write);
+
+/*!\brief Stop slave mode (own address not acknowledged anymore)
+** \return nothing
+**/
+void I2C_slave_mode_stop(void);
+
+/*!\brief Get slave mode current register address
+** \return Register address of next byte served
+**/
+uint16_t I2C_slave_mode_get_reg_addr(void);
+
+
+#if CI2C_STATS
+/****************************/
+/*** I2C INSTRUMENTATION  ***/
+/****************************/
+
+/*!\brief Get I2C slave statistics snapshot
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in, out] stats - pointer to statistics structure to fill
+** \return nothing
+**/
+void I2C_slave_get_stats(const I2C_SLAVE * slave, I2C_SLAVE_STATS * stats);
+
+/*!\brief Reset I2C slave statistics
+** \param [in, out] slave - pointer to the I2C slave structure
+** \return nothing
+**/
+void I2C_slave_reset_stats(I2C_SLAVE * slave);
+
+/*!\brief Get bus events trace snapshot (oldest event first)
+** \param [in, out] evt - pointer to events array to fill
+** \param [in] max - events array size
+** \return Number of events copied
+**/
+uint8_t I2C_trace_get(I2C_TRACE_EVT * evt, const uint8_t max);
+
+/*!\brief Reset bus events trace
+** \return nothing
+**/
+void I2C_trace_reset(void);
+#endif
+
 
 /***********************************/
 /***  cI2C LOW LEVEL FUNCTIONS   ***/
 /*** THAT MAY BE USEFUL FOR DVPT ***/
 /***********************************/
 /*!\brief I2C bus reset (Release SCL and SDA lines and re-enable module)
+** \note Slaves internal pointers on hardware TWI become unknown
 ** \return nothing
 **/
 void I2C_reset(void);
@@ -273,9 +1088,87 @@ uint8_t I2C_rd8(const bool ack);
 **/
 bool I2C_sndAddr(I2C_SLAVE * slave, const I2C_RW rw);
 
+/*!\brief Start bus timeout of a low level operation (unless a transaction deadline is armed)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return nothing
+**/
+void I2C_bus_start_timeout(I2C_BUS * bus);
+
+/*!\brief Test bus timeout of a low level operation (time only checked every few polling loops)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return true if timeout occured
+**/
+bool I2C_bus_timeout(I2C_BUS * bus);
+
+/*!\brief Send I2C address byte
+** \param [in] sla - slave address byte (7 bits address shifted left, read/write bit included)
+** \return true if I2C chip address sent acknowledged (false otherwise)
+**/
+bool I2C_sndSla(const uint8_t sla);
+
+/*!\brief Take hardware TWI ownership for a transaction made of low level functions (transaction deadline armed)
+** \note Slaves internal pointers on hardware TWI become unknown (foreign access)
+** \param [in] bytes - number of data bytes of transaction (deadline computation)
+** \return true if bus acquired (false if already owned)
+**/
+bool I2C_xfer_begin(const uint16_t bytes);
+
+/*!\brief Prepare next attempt of a failed transaction (delay, then transaction deadline re-armed)
+** \param [in] bytes - number of data bytes of transaction (deadline computation)
+** \return true if transaction has to be retried (false if no retries left)
+**/
+bool I2C_xfer_retry(const uint16_t bytes);
+
+/*!\brief End of transaction made of low level functions (release hardware TWI ownership)
+** \return nothing
+**/
+void I2C_xfer_end(void);
+
 
 #ifdef __cplusplus
 }
+
+/*!\brief I2C_write overload for constant slaves
+** \attribute inline
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt
+**/
+inline I2C_STATUS __attribute__((__always_inline__)) I2C_write(I2C_CSLAVE * cs, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes) {
+	return I2C_cslave_write(cs, reg_addr, data, bytes); }
+
+/*!\brief I2C_write_next overload for constant slaves
+** \attribute inline
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt
+**/
+inline I2C_STATUS __attribute__((__always_inline__)) I2C_write_next(I2C_CSLAVE * cs, uint8_t * data, const uint16_t bytes) {
+	return I2C_cslave_write_next(cs, data, bytes); }
+
+/*!\brief I2C_read overload for constant slaves
+** \attribute inline
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt
+**/
+inline I2C_STATUS __attribute__((__always_inline__)) I2C_read(I2C_CSLAVE * cs, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes) {
+	return I2C_cslave_read(cs, reg_addr, data, bytes); }
+
+/*!\brief I2C_read_next overload for constant slaves
+** \attribute inline
+** \param [in, out] cs - pointer to the I2C constant slave structure
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt
+**/
+inline I2C_STATUS __attribute__((__always_inline__)) I2C_read_next(I2C_CSLAVE * cs, uint8_t * data, const uint16_t bytes) {
+	return I2C_cslave_read_next(cs, data, bytes); }
 #endif
 
 #endif
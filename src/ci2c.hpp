@@ -0,0 +1,143 @@
+/*!\file ci2c.hpp
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c compile time specialized devices (header only C++ layer)
+** \details Slave address & register address size are template parameters: address bytes are constants,
+**			register address size is resolved at compile time and no function pointer is involved (no RAM used for configuration).
+**			Transactions are built from cI2C low level functions, so bus ownership, deadline & retries are shared with C API.
+** \note Register address is sent on every transaction (no slave structure to track internal pointer, no elision)
+**/
+/****************************************************************/
+#ifndef __CI2C_HPP__
+	#define __CI2C_HPP__
+/****************************************************************/
+
+#include "ci2c.h"
+
+
+namespace ci2c {
+
+/*!\class Device
+** \brief I2C slave specialized at compile time
+** \tparam ADDR - I2C slave address (7 bits)
+** \tparam REG - internal register map size (I2C_NO_REG, I2C_8B_REG or I2C_16B_REG)
+**/
+template <uint8_t ADDR, I2C_INT_SIZE REG>
+class Device {
+	static_assert(ADDR <= 0x7F, "I2C slave address shall fit on 7 bits");
+	static_assert(REG <= I2C_16B_REG, "Register map size shall be I2C_NO_REG, I2C_8B_REG or I2C_16B_REG");
+
+	static constexpr uint8_t SLA_W = (uint8_t) ((ADDR << 1) | I2C_WRITE);	//!< Address byte for write
+	static constexpr uint8_t SLA_R = (uint8_t) ((ADDR << 1) | I2C_READ);	//!< Address byte for read
+
+	/*!\brief Send register address (resolved at compile time)
+	** \param [in] reg_addr - register address in register map
+	** \return true if register address acknowledged
+	**/
+	static inline bool __attribute__((__always_inline__)) sndReg(const uint16_t reg_addr)
+	{
+		if (REG >= I2C_16B_REG)	{ if (!I2C_wr8((uint8_t) (reg_addr >> 8)))	{ return false; } }
+		if (REG >= I2C_8B_REG)	{ if (!I2C_wr8((uint8_t) reg_addr))			{ return false; } }
+		return true;
+	}
+
+	/*!\brief Single write attempt
+	** \param [in] reg_addr - register address in register map
+	** \param [in] data - pointer to the first byte of a block of data to write
+	** \param [in] bytes - indicates how many bytes of data to write
+	** \return true if write acknowledged
+	**/
+	static bool wr(const uint16_t reg_addr, const uint8_t * data, const uint16_t bytes)
+	{
+		if (!I2C_start())		{ return false; }
+		if (!I2C_sndSla(SLA_W))	{ return false; }
+		if (!sndReg(reg_addr))	{ return false; }
+
+		for (uint16_t cnt = bytes ; cnt != 0 ; cnt--)
+		{
+			if (!I2C_wr8(*data++))	{ return false; }
+		}
+
+		return I2C_stop();
+	}
+
+	/*!\brief Single read attempt
+	** \param [in] reg_addr - register address in register map
+	** \param [in, out] data - pointer to the first byte of a block of data to read
+	** \param [in] bytes - indicates how many bytes of data to read
+	** \return true if read acknowledged
+	**/
+	static bool rd(const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+	{
+		if (REG != I2C_NO_REG)
+		{
+			if (!I2C_start())		{ return false; }
+			if (!I2C_sndSla(SLA_W))	{ return false; }
+			if (!sndReg(reg_addr))	{ return false; }
+		}
+		if (!I2C_start())			{ return false; }
+		if (!I2C_sndSla(SLA_R))		{ return false; }
+
+		for (uint16_t cnt = bytes ; --cnt != 0 ; )	// Acknowledged bytes
+		{
+			if (!I2C_rd8(true))		{ return false; }
+			*data++ = TWDR;
+		}
+		if (!I2C_rd8(false))		{ return false; }	// Last byte not acknowledged
+		*data = TWDR;
+
+		return I2C_stop();
+	}
+
+public:
+	/*!\brief Init an I2C slave structure matching device (to use C API with it: queue, cache, asynchronous transactions...)
+	** \param [in, out] slave - pointer to the I2C slave structure to init
+	** \return nothing
+	**/
+	static void init_slave(I2C_SLAVE * slave) {
+		I2C_slave_init(slave, ADDR, REG); }
+
+	/*!\brief Write data to the register address specified (retried in case of failure, as I2C_write)
+	** \param [in] reg_addr - register address in register map
+	** \param [in] data - pointer to the first byte of a block of data to write
+	** \param [in] bytes - indicates how many bytes of data to write
+	** \return I2C_STATUS status of write attempt
+	**/
+	static I2C_STATUS write(const uint16_t reg_addr, const uint8_t * data, const uint16_t bytes)
+	{
+		bool ack;
+
+		if (bytes == 0)					{ return I2C_NACK; }
+		if (!I2C_xfer_begin(bytes))		{ return I2C_BUSY; }
+
+		do	{ ack = wr(reg_addr, data, bytes); }
+		while ((!ack) && (I2C_xfer_retry(bytes)));
+
+		I2C_xfer_end();
+		return ack ? I2C_OK : I2C_NACK;
+	}
+
+	/*!\brief Read data from the register address specified (retried in case of failure, as I2C_read)
+	** \param [in] reg_addr - register address in register map
+	** \param [in, out] data - pointer to the first byte of a block of data to read
+	** \param [in] bytes - indicates how many bytes of data to read
+	** \return I2C_STATUS status of read attempt
+	**/
+	static I2C_STATUS read(const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+	{
+		bool ack;
+
+		if (bytes == 0)					{ return I2C_NACK; }
+		if (!I2C_xfer_begin(bytes))		{ return I2C_BUSY; }
+
+		do	{ ack = rd(reg_addr, data, bytes); }
+		while ((!ack) && (I2C_xfer_retry(bytes)));
+
+		I2C_xfer_end();
+		return ack ? I2C_OK : I2C_NACK;
+	}
+};
+
+}	// namespace ci2c
+
+#endif
@@ -0,0 +1,218 @@
+/*!\file ci2c_cache.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c slave registers shadow cache
+** \details Register map image of a slave kept in RAM: cacheable registers are read from image once known,
+**			and writes to cacheable registers are deferred until flush (adjacent dirty registers merged in burst writes).
+**/
+
+#include "ci2c_cache.h"
+
+
+/*!\brief Test bit in registers bitmap
+** \attribute inline
+** \param [in] map - pointer to bitmap
+** \param [in] idx - register index
+** \return true if bit set
+**/
+static inline bool __attribute__((__always_inline__)) I2C_cache_bit(const uint8_t * map, const uint16_t idx) {
+	return ((map[idx >> 3] & (1 << (idx & 7))) != 0); }
+
+/*!\brief Set bit in registers bitmap
+** \attribute inline
+** \param [in, out] map - pointer to bitmap
+** \param [in] idx - register index
+** \return nothing
+**/
+static inline void __attribute__((__always_inline__)) I2C_cache_set(uint8_t * map, const uint16_t idx) {
+	map[idx >> 3] |= (uint8_t) (1 << (idx & 7)); }
+
+/*!\brief Clear bit in registers bitmap
+** \attribute inline
+** \param [in, out] map - pointer to bitmap
+** \param [in] idx - register index
+** \return nothing
+**/
+static inline void __attribute__((__always_inline__)) I2C_cache_clr(uint8_t * map, const uint16_t idx) {
+	map[idx >> 3] &= (uint8_t) ~(1 << (idx & 7)); }
+
+/*!\brief Test if register is cacheable
+** \attribute inline
+** \param [in] cache - pointer to the cache structure
+** \param [in] idx - register index
+** \return true if register is cacheable
+**/
+static inline bool __attribute__((__always_inline__)) I2C_cache_cacheable(const I2C_CACHE * cache, const uint16_t idx) {
+	return ((cache->cacheable == NULL) || I2C_cache_bit(cache->cacheable, idx)); }
+
+/*!\brief Test if registers span is held by cache
+** \attribute inline
+** \param [in] cache - pointer to the cache structure
+** \param [in] reg_addr - register address in register map
+** \param [in] bytes - number of registers
+** \return true if whole span is in cached registers range
+**/
+static inline bool __attribute__((__always_inline__)) I2C_cache_in_range(const I2C_CACHE * cache, const uint16_t reg_addr, const uint16_t bytes) {
+	return ((reg_addr >= cache->base) && (((uint32_t) reg_addr + bytes) <= ((uint32_t) cache->base + cache->nb))); }
+
+
+/*!\brief Init slave registers shadow cache (all registers unknown)
+** \param [in, out] cache - pointer to the cache structure to init
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in] base - first cached register address
+** \param [in] nb - number of cached registers
+** \param [in] img - registers map image storage (nb bytes)
+** \param [in] cacheable - cacheable registers bitmap (CI2C_CACHE_BITMAP_SIZE(nb) bytes, NULL if all registers are cacheable)
+** \param [in] valid - valid registers bitmap storage (CI2C_CACHE_BITMAP_SIZE(nb) bytes)
+** \param [in] dirty - dirty registers bitmap storage (CI2C_CACHE_BITMAP_SIZE(nb) bytes)
+** \return nothing
+**/
+void I2C_cache_init(I2C_CACHE * cache, I2C_SLAVE * slave, const uint16_t base, const uint16_t nb, uint8_t * img, const uint8_t * cacheable, uint8_t * valid, uint8_t * dirty)
+{
+	cache->slave = slave;
+	cache->base = base;
+	cache->nb = nb;
+	cache->img = img;
+	cache->cacheable = cacheable;
+	cache->valid = valid;
+	cache->dirty = dirty;
+
+	I2C_cache_invalidate(cache);
+}
+
+/*!\brief Read registers through cache (only unknown or volatile registers are read from slave)
+** \param [in, out] cache - pointer to the cache structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt
+**/
+I2C_STATUS I2C_cache_read(I2C_CACHE * cache, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+{
+	uint16_t	first = cache->nb, last = 0;
+	uint16_t	idx = reg_addr - cache->base;
+
+	if (!I2C_cache_in_range(cache, reg_addr, bytes))	{ return I2C_read(cache->slave, reg_addr, data, bytes); }
+
+	// Find span of registers that have to be read from slave
+	for (uint16_t i = idx ; i < idx + bytes ; i++)
+	{
+		if (!I2C_cache_cacheable(cache, i) || !I2C_cache_bit(cache->valid, i))
+		{
+			if (i < first)	{ first = i; }
+			last = i;
+		}
+	}
+
+	if (first != cache->nb)
+	{
+		const I2C_STATUS st = I2C_read(cache->slave, cache->base + first, &data[first - idx], last - first + 1);
+		if (st != I2C_OK)	{ return st; }
+	}
+
+	for (uint16_t i = idx ; i < idx + bytes ; i++, data++)
+	{
+		if ((i < first) || (i > last) || I2C_cache_bit(cache->dirty, i))	{ *data = cache->img[i]; }	// Image is newer than slave for dirty registers
+		else if (I2C_cache_cacheable(cache, i))
+		{
+			cache->img[i] = *data;
+			I2C_cache_set(cache->valid, i);
+		}
+	}
+
+	return I2C_OK;
+}
+
+/*!\brief Write registers through cache (deferred until flush, unless a volatile register is written)
+** \param [in, out] cache - pointer to the cache structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt
+**/
+I2C_STATUS I2C_cache_write(I2C_CACHE * cache, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes)
+{
+	const uint16_t	idx = reg_addr - cache->base;
+	bool			through = false;
+
+	if (!I2C_cache_in_range(cache, reg_addr, bytes))	{ return I2C_write(cache->slave, reg_addr, data, bytes); }
+
+	for (uint16_t i = idx ; i < idx + bytes ; i++)
+	{
+		if (!I2C_cache_cacheable(cache, i))	{ through = true; break; }
+	}
+
+	if (through)	// Volatile register written: write through (whole span)
+	{
+		const I2C_STATUS st = I2C_write(cache->slave, reg_addr, data, bytes);
+		if (st != I2C_OK)	{ return st; }
+	}
+
+	for (uint16_t i = idx ; i < idx + bytes ; i++, data++)
+	{
+		if (!I2C_cache_cacheable(cache, i))	{ continue; }
+
+		cache->img[i] = *data;
+		I2C_cache_set(cache->valid, i);
+		if (through)	{ I2C_cache_clr(cache->dirty, i); }
+		else			{ I2C_cache_set(cache->dirty, i); }
+	}
+
+	return I2C_OK;
+}
+
+/*!\brief Write dirty registers to slave (adjacent dirty registers merged in burst writes)
+** \note Up to CI2C_CACHE_GAP known clean registers between dirty ones are rewritten to merge bursts
+** \param [in, out] cache - pointer to the cache structure
+** \return I2C_STATUS status of flush attempt (dirty registers not written are kept dirty)
+**/
+I2C_STATUS I2C_cache_flush(I2C_CACHE * cache)
+{
+	uint16_t i = 0;
+
+	while (i < cache->nb)
+	{
+		uint16_t	end = i, gap = 0;
+		I2C_STATUS	st;
+
+		if (!I2C_cache_bit(cache->dirty, i))	{ i++; continue; }
+
+		for (uint16_t j = i + 1 ; j < cache->nb ; j++)
+		{
+			if (I2C_cache_bit(cache->dirty, j))											{ end = j; gap = 0; }
+			else if ((I2C_cache_cacheable(cache, j)) && (I2C_cache_bit(cache->valid, j))
+					&& (++gap <= CI2C_CACHE_GAP))										{ continue; }
+			else																		{ break; }
+		}
+
+		st = I2C_write(cache->slave, cache->base + i, &cache->img[i], end - i + 1);
+		if (st != I2C_OK)	{ return st; }
+
+		for ( ; i <= end ; i++)		{ I2C_cache_clr(cache->dirty, i); }
+	}
+
+	return I2C_OK;
+}
+
+/*!\brief Invalidate cache (all registers unknown, pending dirty registers dropped)
+** \param [in, out] cache - pointer to the cache structure
+** \return nothing
+**/
+void I2C_cache_invalidate(I2C_CACHE * cache)
+{
+	memset(cache->valid, 0, CI2C_CACHE_BITMAP_SIZE(cache->nb));
+	memset(cache->dirty, 0, CI2C_CACHE_BITMAP_SIZE(cache->nb));
+}
+
+/*!\brief Test if cache holds registers not yet written to slave
+** \param [in] cache - pointer to the cache structure
+** \return true if some registers are dirty
+**/
+bool I2C_cache_is_dirty(const I2C_CACHE * cache)
+{
+	for (uint16_t i = 0 ; i < CI2C_CACHE_BITMAP_SIZE(cache->nb) ; i++)
+	{
+		if (cache->dirty[i])	{ return true; }
+	}
+	return false;
+}
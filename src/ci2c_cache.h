@@ -0,0 +1,95 @@
+/*!\file ci2c_cache.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c slave registers shadow cache declarations
+** \details Register map image of a slave kept in RAM: cacheable registers are read from image once known,
+**			and writes to cacheable registers are deferred until flush (adjacent dirty registers merged in burst writes).
+**/
+/****************************************************************/
+#ifndef __CI2C_CACHE_H__
+	#define __CI2C_CACHE_H__
+/****************************************************************/
+
+#include "ci2c.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CI2C_CACHE_GAP
+#define CI2C_CACHE_GAP				3	//!< Max number of clean registers bridged between dirty ones when flushing (may be overridden through compiler flags)
+#endif
+
+#define CI2C_CACHE_BITMAP_SIZE(nb)	(((nb) + 7) / 8)	//!< Size of a registers bitmap (in bytes) for \b nb registers
+
+
+/*!\struct StructI2CCache
+** \brief ci2c slave registers shadow cache (storage provided by user)
+**/
+typedef struct StructI2CCache {
+	I2C_SLAVE *			slave;		//!< Pointer to the I2C slave structure
+	uint16_t			base;		//!< First cached register address
+	uint16_t			nb;			//!< Number of cached registers
+	uint8_t *			img;		//!< Registers map image (nb bytes)
+	const uint8_t *		cacheable;	//!< Cacheable registers bitmap (bit cleared for volatile registers)
+	uint8_t *			valid;		//!< Registers known in image bitmap
+	uint8_t *			dirty;		//!< Registers modified in image and not yet written bitmap
+} I2C_CACHE;
+
+
+/*!\brief Init slave registers shadow cache (all registers unknown)
+** \param [in, out] cache - pointer to the cache structure to init
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in] base - first cached register address
+** \param [in] nb - number of cached registers
+** \param [in] img - registers map image storage (nb bytes)
+** \param [in] cacheable - cacheable registers bitmap (CI2C_CACHE_BITMAP_SIZE(nb) bytes, NULL if all registers are cacheable)
+** \param [in] valid - valid registers bitmap storage (CI2C_CACHE_BITMAP_SIZE(nb) bytes)
+** \param [in] dirty - dirty registers bitmap storage (CI2C_CACHE_BITMAP_SIZE(nb) bytes)
+** \return nothing
+**/
+void I2C_cache_init(I2C_CACHE * cache, I2C_SLAVE * slave, const uint16_t base, const uint16_t nb, uint8_t * img, const uint8_t * cacheable, uint8_t * valid, uint8_t * dirty);
+
+/*!\brief Read registers through cache (only unknown or volatile registers are read from slave)
+** \param [in, out] cache - pointer to the cache structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read
+** \param [in] bytes - indicates how many bytes of data to read
+** \return I2C_STATUS status of read attempt
+**/
+I2C_STATUS I2C_cache_read(I2C_CACHE * cache, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+
+/*!\brief Write registers through cache (deferred until flush, unless a volatile register is written)
+** \param [in, out] cache - pointer to the cache structure
+** \param [in] reg_addr - register address in register map
+** \param [in] data - pointer to the first byte of a block of data to write
+** \param [in] bytes - indicates how many bytes of data to write
+** \return I2C_STATUS status of write attempt
+**/
+I2C_STATUS I2C_cache_write(I2C_CACHE * cache, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes);
+
+/*!\brief Write dirty registers to slave (adjacent dirty registers merged in burst writes)
+** \param [in, out] cache - pointer to the cache structure
+** \return I2C_STATUS status of flush attempt (dirty registers not written are kept dirty)
+**/
+I2C_STATUS I2C_cache_flush(I2C_CACHE * cache);
+
+/*!\brief Invalidate cache (all registers unknown, pending dirty registers dropped)
+** \param [in, out] cache - pointer to the cache structure
+** \return nothing
+**/
+void I2C_cache_invalidate(I2C_CACHE * cache);
+
+/*!\brief Test if cache holds registers not yet written to slave
+** \param [in] cache - pointer to the cache structure
+** \return true if some registers are dirty
+**/
+bool I2C_cache_is_dirty(const I2C_CACHE * cache);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
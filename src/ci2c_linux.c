@@ -0,0 +1,192 @@
+/*!\file ci2c_linux.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c Linux i2c-dev bus
+** \details Messages lists are translated to i2c-dev messages and issued with a single I2C_RDWR ioctl,
+**			chains of messages continued with I2C_MSG_NOSTART are merged through the bounce buffer (I2C_M_NOSTART being seldom supported by adapters,
+**			buffer allocated for the transfer when merged chains exceed it),
+**			a single message is transferred in place.
+**/
+
+#if defined(__linux__)
+
+#include "ci2c_linux.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#define I2C_LINUX(bus)			((I2C_LINUX_BUS *) (bus))							//!< Linux bus from its generic bus
+
+
+// Linux backend prototypes
+static uint16_t I2C_linux_set_speed(I2C_BUS * bus, const uint16_t speed);
+static bool I2C_linux_xfer(I2C_BUS * bus, const I2C_MSG * msgs, const uint16_t nb);
+
+static const I2C_BUS_OPS i2c_linux_ops = { I2C_linux_set_speed, NULL, NULL, NULL, NULL, NULL, NULL, NULL, I2C_linux_xfer };	//!< Linux backend operations (messages level only)
+
+
+/*!\brief I2C_RDWR ioctl on adapter
+** \param [in] fd - adapter file descriptor
+** \param [in, out] msgs - pointer to the first i2c-dev message
+** \param [in] nb - number of messages
+** \return ioctl result (negative on failure, errno set)
+**/
+static int I2C_linux_ioctl(int fd, struct i2c_msg * msgs, const uint32_t nb)
+{
+	struct i2c_rdwr_ioctl_data rdwr = { msgs, nb };
+	return ioctl(fd, I2C_RDWR, &rdwr);
+}
+
+/*!\brief Get number of messages of a chain (message followed by messages continued with I2C_MSG_NOSTART)
+** \param [in] msgs - pointer to the first message of chain
+** \param [in] nb - number of messages left in list
+** \param [in, out] len - pointer to chain length in bytes
+** \return number of messages of chain
+**/
+static uint16_t I2C_linux_chain(const I2C_MSG * msgs, const uint16_t nb, uint16_t * len)
+{
+	uint16_t cnt = 1;
+
+	*len = msgs[0].len;
+	while ((cnt < nb) && (msgs[cnt].flags & I2C_MSG_NOSTART))	{ *len += msgs[cnt++].len; }
+
+	return cnt;
+}
+
+
+/*!\brief Linux backend: set bus clock
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] speed - I2C bus speed in KHz
+** \return Configured bus speed (informative, adapter clock is set by the kernel)
+**/
+static uint16_t I2C_linux_set_speed(I2C_BUS * bus, const uint16_t speed)
+{
+	(void) bus;
+	return speed;
+}
+
+/*!\brief Linux backend: transfer messages list with a single I2C_RDWR ioctl
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] msgs - pointer to the first message
+** \param [in] nb - number of messages
+** \return true if all messages transferred (bus nack flag set if adapter reported a NACK)
+**/
+static bool I2C_linux_xfer(I2C_BUS * bus, const I2C_MSG * msgs, const uint16_t nb)
+{
+	I2C_LINUX_BUS * const		lx = I2C_LINUX(bus);
+	struct i2c_msg				lmsgs[I2C_RDWR_IOCTL_MAX_MSGS];
+	uint32_t					lnb = 0;
+	uint32_t					need = 0;	// Merged chains bytes
+	uint32_t					used = 0;	// Bounce buffer bytes
+	uint8_t *					buf = lx->buf;
+	uint16_t					len, cnt;
+	bool						ok;
+
+	for (uint16_t i = 0 ; i < nb ; i += cnt, lnb++)
+	{
+		cnt = I2C_linux_chain(&msgs[i], (uint16_t) (nb - i), &len);
+		if (cnt != 1)	{ need += len; }
+	}
+	if (lnb > I2C_RDWR_IOCTL_MAX_MSGS)	{ return false; }
+	if ((need > CI2C_LINUX_BUF) && ((buf = (uint8_t *) malloc(need)) == NULL))	{ return false; }	// Bounce buffer too small for this transfer
+
+	lnb = 0;
+	for (uint16_t i = 0 ; i < nb ; i += cnt)
+	{
+		struct i2c_msg * const m = &lmsgs[lnb];
+
+		cnt = I2C_linux_chain(&msgs[i], (uint16_t) (nb - i), &len);
+		m->addr = msgs[i].addr;
+		m->flags = (msgs[i].flags & I2C_MSG_RD) ? I2C_M_RD : 0;
+		if (msgs[i].flags & I2C_MSG_IGNORE_NACK)		{ m->flags |= I2C_M_IGNORE_NAK; }
+		if (msgs[i + cnt - 1].flags & I2C_MSG_STOP)	{ m->flags |= I2C_M_STOP; }
+		m->len = len;
+
+		if (cnt == 1)	{ m->buf = msgs[i].data; }	// Transferred in place
+		else
+		{
+			m->buf = &buf[used];
+			if (m->flags & I2C_M_RD)	{ used += len; }	// Scattered back after transfer
+			else
+			{
+				for (uint16_t j = i ; j < i + cnt ; j++)
+				{
+					if (msgs[j].len)	{ memcpy(&buf[used], msgs[j].data, msgs[j].len); used += msgs[j].len; }
+				}
+			}
+		}
+		lnb++;
+	}
+
+	lx->calls++;
+	if (!(ok = (lx->rdwr(lx->fd, lmsgs, lnb) >= 0)))	{ bus->nack = (errno == ENXIO) || (errno == EREMOTEIO); }	// Address / data not acknowledged
+
+	for (uint16_t i = 0, k = 0 ; (ok) && (i < nb) ; i += cnt, k++)	// Merged reads scattered back
+	{
+		const uint8_t * src = lmsgs[k].buf;
+
+		cnt = I2C_linux_chain(&msgs[i], (uint16_t) (nb - i), &len);
+		if ((cnt == 1) || (!(lmsgs[k].flags & I2C_M_RD)))	{ continue; }
+
+		for (uint16_t j = i ; j < i + cnt ; j++)
+		{
+			if (msgs[j].len)	{ memcpy(msgs[j].data, src, msgs[j].len); src += msgs[j].len; }
+		}
+	}
+
+	if (buf != lx->buf)	{ free(buf); }
+	return ok;
+}
+
+
+/*!\brief Init a Linux i2c-dev bus on adapter /dev/i2c-\b adapter
+** \param [in, out] lx - pointer to the Linux bus structure to init
+** \param [in] adapter - adapter number
+** \param [in] speed - I2C bus speed in KHz (informative, adapter clock is set by the kernel)
+** \return true if adapter opened
+**/
+bool I2C_linux_init(I2C_LINUX_BUS * lx, const uint8_t adapter, const uint16_t speed)
+{
+	char	path[16];
+	int		fd;
+
+	(void) snprintf(path, sizeof(path), "/dev/i2c-%u", adapter);
+	if ((fd = open(path, O_RDWR)) < 0)	{ return false; }
+
+	I2C_linux_init_fd(lx, fd, NULL, speed);
+	return true;
+}
+
+/*!\brief Init a Linux i2c-dev bus on an already opened file descriptor
+** \param [in, out] lx - pointer to the Linux bus structure to init
+** \param [in] fd - adapter file descriptor
+** \param [in] rdwr - I2C_RDWR ioctl function (NULL for ioctl, fake adapter otherwise)
+** \param [in] speed - I2C bus speed in KHz (informative, adapter clock is set by the kernel)
+** \return nothing
+**/
+void I2C_linux_init_fd(I2C_LINUX_BUS * lx, const int fd, const ci2c_rdwr_fct_ptr rdwr, const uint16_t speed)
+{
+	lx->fd = fd;
+	lx->rdwr = rdwr ? rdwr : I2C_linux_ioctl;
+	lx->calls = 0;
+	I2C_bus_init(&lx->bus, &i2c_linux_ops, speed);
+}
+
+/*!\brief Close Linux i2c-dev bus adapter
+** \param [in, out] lx - pointer to the Linux bus structure
+** \return nothing
+**/
+void I2C_linux_close(I2C_LINUX_BUS * lx)
+{
+	if (lx->fd >= 0)	{ (void) close(lx->fd); }
+	lx->fd = -1;
+}
+
+#endif
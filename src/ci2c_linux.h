@@ -0,0 +1,82 @@
+/*!\file ci2c_linux.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c Linux i2c-dev bus declarations
+** \details I2C master through a Linux /dev/i2c-N adapter, used as an I2C_BUS backend: each transaction (register address write,
+**			repeated START, data read) is handed to the kernel as a single I2C_RDWR ioctl, so I2C_read / I2C_write cost one syscall.
+**			Drivers stay unchanged once the bus is set as default bus (I2C_set_default_bus) before their slaves are initialized.
+** \note Built on Linux only (extras/linux platform shim); clock speed is set by the kernel (device tree / module parameters).
+** \warning Slaves internal pointers tracking assumes the process owns the adapter (I2C_bus_forget_regs when other processes access it).
+** \warning <linux/i2c-dev.h> defines I2C_SLAVE (ioctl request) and can't be included along with cI2C headers (<linux/i2c.h> can).
+**/
+/****************************************************************/
+#ifndef __CI2C_LINUX_H__
+	#define __CI2C_LINUX_H__
+/****************************************************************/
+
+#include "ci2c.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CI2C_LINUX_BUF
+#define CI2C_LINUX_BUF			256		//!< Bounce buffer size (messages continued with I2C_MSG_NOSTART merged in a single i2c-dev message, buffer allocated for larger transfers)
+#endif
+
+
+struct i2c_msg;
+
+typedef int (*ci2c_rdwr_fct_ptr) (int, struct i2c_msg *, const uint32_t);	//!< I2C_RDWR ioctl function pointer typedef (file descriptor, i2c-dev messages, number of messages)
+
+
+/*!\struct StructI2CLinuxBus
+** \brief ci2c Linux i2c-dev bus (adapter & bounce buffer)
+**/
+typedef struct StructI2CLinuxBus {
+	I2C_BUS				bus;					//!< Generic bus (first member, pointer given to I2C_slave_set_bus / I2C_set_default_bus)
+	int					fd;						//!< Adapter file descriptor
+	ci2c_rdwr_fct_ptr	rdwr;					//!< I2C_RDWR ioctl function (replaced by a fake adapter in host tests)
+	uint32_t			calls;					//!< Number of I2C_RDWR calls issued
+	uint8_t				buf[CI2C_LINUX_BUF];	//!< Bounce buffer
+} I2C_LINUX_BUS;
+
+
+/*!\brief Init a Linux i2c-dev bus on adapter /dev/i2c-\b adapter
+** \param [in, out] lx - pointer to the Linux bus structure to init
+** \param [in] adapter - adapter number
+** \param [in] speed - I2C bus speed in KHz (informative, adapter clock is set by the kernel)
+** \return true if adapter opened
+**/
+bool I2C_linux_init(I2C_LINUX_BUS * lx, const uint8_t adapter, const uint16_t speed);
+
+/*!\brief Init a Linux i2c-dev bus on an already opened file descriptor
+** \param [in, out] lx - pointer to the Linux bus structure to init
+** \param [in] fd - adapter file descriptor
+** \param [in] rdwr - I2C_RDWR ioctl function (NULL for ioctl, fake adapter otherwise)
+** \param [in] speed - I2C bus speed in KHz (informative, adapter clock is set by the kernel)
+** \return nothing
+**/
+void I2C_linux_init_fd(I2C_LINUX_BUS * lx, const int fd, const ci2c_rdwr_fct_ptr rdwr, const uint16_t speed);
+
+/*!\brief Close Linux i2c-dev bus adapter
+** \param [in, out] lx - pointer to the Linux bus structure
+** \return nothing
+**/
+void I2C_linux_close(I2C_LINUX_BUS * lx);
+
+/*!\brief Get generic bus of a Linux i2c-dev bus (to attach slaves with I2C_slave_set_bus or I2C_set_default_bus)
+** \attribute inline
+** \param [in] lx - pointer to the Linux bus structure
+** \return pointer to the I2C bus structure
+**/
+inline I2C_BUS * __attribute__((__always_inline__)) I2C_linux_get_bus(I2C_LINUX_BUS * lx) {
+	return &lx->bus; }
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,180 @@
+/*!\file ci2c_queue.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c transactions queue
+** \details Pending transactions are held in a statically allocated ring (ordered by priority, then by arrival),
+**			and drained back-to-back by interrupt driven transactions (next one is launched from completion interrupt).
+**/
+
+#include "ci2c_queue.h"
+
+/*!\struct i2c_q
+** \brief static ci2c transactions queue
+**/
+static struct {
+	I2C_TRANSACTION		ring[CI2C_QUEUE_SIZE];	//!< Pending transactions ring
+	I2C_TRANSACTION		cur;					//!< Transaction currently on the bus
+	uint8_t				head;					//!< Index of next transaction to launch
+	uint8_t				nb;						//!< Number of pending transactions
+	volatile bool		running;				//!< true if a queued transaction is on the bus
+	I2C_QUEUE_STATS		stats;					//!< Queue statistics
+} i2c_q;
+
+
+// Needed prototypes
+static void I2C_queue_launch(void);
+
+
+/*!\brief Queued transaction completion callback (chains next pending transaction)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] status - transaction final status
+** \return nothing
+**/
+static void I2C_queue_cb(void * slave, const I2C_STATUS status)
+{
+	const ci2c_cb_fct_ptr cb = i2c_q.cur.cb;
+
+	i2c_q.running = false;
+	I2C_queue_launch();		// Launch next one first (no idle gap on bus)
+	if (cb)		{ cb(slave, status); }
+}
+
+/*!\brief Launch next pending transaction (shall be called with interrupts disabled or from interrupt)
+** \return nothing
+**/
+static void I2C_queue_launch(void)
+{
+	while ((!i2c_q.running) && (i2c_q.nb != 0))
+	{
+		I2C_TRANSACTION *	tr = &i2c_q.ring[i2c_q.head];
+		I2C_STATUS			st;
+		uint32_t			wait;
+
+		if (I2C_is_busy())	{ return; }		// Bus owned by blocking transaction: I2C_queue_process will retry
+
+		i2c_q.cur = *tr;
+		i2c_q.running = true;
+
+		st = (tr->rw == I2C_READ)	? I2C_read_async(tr->slave, tr->reg_addr, tr->data, tr->bytes, I2C_queue_cb)
+									: I2C_write_async(tr->slave, tr->reg_addr, tr->data, tr->bytes, I2C_queue_cb);
+
+		if (st == I2C_BUSY)	{ i2c_q.running = false; return; }
+
+		i2c_q.head = (uint8_t) ((i2c_q.head + 1) % CI2C_QUEUE_SIZE);
+		i2c_q.stats.depth = --i2c_q.nb;
+
+		wait = (uint32_t) micros() - i2c_q.cur.post_time;
+		i2c_q.stats.wait_cumul += wait;
+		if (wait > i2c_q.stats.wait_max)	{ i2c_q.stats.wait_max = wait; }
+
+		if (st != I2C_OK)	// Rejected right away (non busy status): completed, next one launched
+		{
+			i2c_q.running = false;
+			if (i2c_q.cur.cb)	{ i2c_q.cur.cb(i2c_q.cur.slave, st); }
+		}
+	}
+}
+
+
+/*!\brief Post a transaction to the queue (launched right away if bus is idle)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read/write (shall stay valid until completion)
+** \param [in] bytes - indicates how many bytes of data to read/write
+** \param [in] rw - 0 = write, 1 = read operation
+** \param [in] prio - transaction priority (higher value served first, same priority served in order)
+** \param [in] cb - callback called (from interrupt) with final status (may be NULL)
+** \return I2C_STATUS status of post attempt (I2C_OK when queued, I2C_BUSY if queue is full, I2C_NACK if bytes is 0)
+**/
+I2C_STATUS I2C_queue_post(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const I2C_RW rw, const uint8_t prio, const ci2c_cb_fct_ptr cb)
+{
+	const uint8_t	sreg = SREG;
+	uint8_t			pos;
+
+	if (bytes == 0)		{ return I2C_NACK; }
+
+	cli();
+
+	i2c_q.stats.posted++;
+	if (i2c_q.nb >= CI2C_QUEUE_SIZE)
+	{
+		i2c_q.stats.dropped++;
+		SREG = sreg;
+		return I2C_BUSY;
+	}
+
+	// Shift lower priority transactions back to insert after same or higher priority ones
+	pos = i2c_q.nb;
+	while (pos != 0)
+	{
+		const uint8_t	prev = (uint8_t) ((i2c_q.head + pos - 1) % CI2C_QUEUE_SIZE);
+
+		if (i2c_q.ring[prev].prio >= prio)	{ break; }
+		i2c_q.ring[(prev + 1) % CI2C_QUEUE_SIZE] = i2c_q.ring[prev];
+		pos--;
+	}
+
+	I2C_TRANSACTION * tr = &i2c_q.ring[(i2c_q.head + pos) % CI2C_QUEUE_SIZE];
+	tr->slave = slave;
+	tr->reg_addr = reg_addr;
+	tr->data = data;
+	tr->bytes = bytes;
+	tr->rw = rw;
+	tr->prio = prio;
+	tr->cb = cb;
+	tr->post_time = (uint32_t) micros();
+
+	i2c_q.stats.depth = ++i2c_q.nb;
+	if (i2c_q.nb > i2c_q.stats.depth_max)	{ i2c_q.stats.depth_max = i2c_q.nb; }
+
+	I2C_queue_launch();
+
+	SREG = sreg;
+	return I2C_OK;
+}
+
+/*!\brief Check current transaction progress (I2C_async_process), then launch next pending transaction if bus is idle
+** \note To be called from loop while transactions are pending (delayed retries, deadline, bus owned by a blocking transaction while posting)
+** \return nothing
+**/
+void I2C_queue_process(void)
+{
+	const uint8_t sreg = SREG;
+
+	(void) I2C_async_process();
+	cli();
+	I2C_queue_launch();
+	SREG = sreg;
+}
+
+/*!\brief Get number of pending transactions
+** \return Number of transactions waiting in queue (current transaction excluded)
+**/
+uint8_t I2C_queue_depth(void) {
+	return i2c_q.nb; }
+
+/*!\brief Get transactions queue statistics snapshot
+** \param [in, out] stats - pointer to statistics structure to fill
+** \return nothing
+**/
+void I2C_queue_get_stats(I2C_QUEUE_STATS * stats)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	*stats = i2c_q.stats;
+	SREG = sreg;
+}
+
+/*!\brief Reset transactions queue statistics
+** \return nothing
+**/
+void I2C_queue_reset_stats(void)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	memset(&i2c_q.stats, 0, sizeof(i2c_q.stats));
+	i2c_q.stats.depth = i2c_q.stats.depth_max = i2c_q.nb;
+	SREG = sreg;
+}
@@ -0,0 +1,96 @@
+/*!\file ci2c_queue.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c transactions queue declarations
+** \details Pending transactions are held in a statically allocated ring (ordered by priority, then by arrival),
+**			and drained back-to-back by interrupt driven transactions (next one is launched from completion interrupt).
+**/
+/****************************************************************/
+#ifndef __CI2C_QUEUE_H__
+	#define __CI2C_QUEUE_H__
+/****************************************************************/
+
+#include "ci2c.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CI2C_QUEUE_SIZE
+#define CI2C_QUEUE_SIZE			8		//!< cI2C transactions queue capacity (may be overridden through compiler flags)
+#endif
+
+#define CI2C_PRIO_LOW			0		//!< Low priority transaction (bulk transfers)
+#define CI2C_PRIO_NORMAL		1		//!< Normal priority transaction
+#define CI2C_PRIO_URGENT		255		//!< Urgent priority transaction (jumps ahead of every other pending transaction)
+
+
+/*!\struct StructI2CTransaction
+** \brief ci2c queued transaction
+**/
+typedef struct StructI2CTransaction {
+	I2C_SLAVE *			slave;		//!< Pointer to the I2C slave structure
+	uint16_t			reg_addr;	//!< Register address in register map
+	uint8_t *			data;		//!< Pointer to the first byte of data block (shall stay valid until completion)
+	uint16_t			bytes;		//!< Number of bytes to read/write
+	I2C_RW				rw;			//!< Transaction direction
+	uint8_t				prio;		//!< Transaction priority (higher value served first)
+	ci2c_cb_fct_ptr		cb;			//!< Completion callback (may be NULL)
+	uint32_t			post_time;	//!< Time when transaction was posted (us)
+} I2C_TRANSACTION;
+
+
+/*!\struct StructI2CQueueStats
+** \brief ci2c transactions queue statistics (for ring sizing)
+**/
+typedef struct StructI2CQueueStats {
+	uint32_t			posted;		//!< Number of transactions posted
+	uint32_t			dropped;	//!< Number of transactions refused (queue full)
+	uint32_t			wait_cumul;	//!< Cumulated wait time between post and launch (us, wraps after about 71 minutes)
+	uint32_t			wait_max;	//!< Maximum wait time between post and launch (us)
+	uint8_t				depth;		//!< Current queue depth
+	uint8_t				depth_max;	//!< Maximum queue depth reached
+} I2C_QUEUE_STATS;
+
+
+/*!\brief Post a transaction to the queue (launched right away if bus is idle)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - pointer to the first byte of a block of data to read/write (shall stay valid until completion)
+** \param [in] bytes - indicates how many bytes of data to read/write
+** \param [in] rw - 0 = write, 1 = read operation
+** \param [in] prio - transaction priority (higher value served first, same priority served in order)
+** \param [in] cb - callback called (from interrupt) with final status (may be NULL)
+** \return I2C_STATUS status of post attempt (I2C_OK when queued, I2C_BUSY if queue is full, I2C_NACK if bytes is 0)
+**/
+I2C_STATUS I2C_queue_post(I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const I2C_RW rw, const uint8_t prio, const ci2c_cb_fct_ptr cb);
+
+/*!\brief Check current transaction progress (I2C_async_process), then launch next pending transaction if bus is idle
+** \note To be called from loop while transactions are pending (delayed retries, deadline, bus owned by a blocking transaction while posting)
+** \return nothing
+**/
+void I2C_queue_process(void);
+
+/*!\brief Get number of pending transactions
+** \return Number of transactions waiting in queue (current transaction excluded)
+**/
+uint8_t I2C_queue_depth(void);
+
+/*!\brief Get transactions queue statistics snapshot
+** \param [in, out] stats - pointer to statistics structure to fill
+** \return nothing
+**/
+void I2C_queue_get_stats(I2C_QUEUE_STATS * stats);
+
+/*!\brief Reset transactions queue statistics
+** \return nothing
+**/
+void I2C_queue_reset_stats(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,224 @@
+/*!\file ci2c_sched.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c periodic polling scheduler
+** \details Periodic read jobs (deadline at next release) dispatched earliest deadline first from I2C_sched_process,
+**			job sets refused when bus load estimate (utilization plus longest job blocking the shortest period) exceeds CI2C_SCHED_MAX_LOAD.
+**/
+
+#include "ci2c_sched.h"
+
+/*!\struct i2c_sched
+** \brief static ci2c periodic jobs table
+**/
+static struct {
+	I2C_JOB *			jobs[CI2C_SCHED_SIZE];	//!< Scheduled jobs
+	uint8_t				nb;						//!< Number of scheduled jobs
+} i2c_sched;
+
+
+/*!\brief Test if time \b a is before time \b b (wrapping microseconds counter)
+** \attribute inline
+** \param [in] a - time (us)
+** \param [in] b - time (us)
+** \return true if \b a is before \b b
+**/
+static inline bool __attribute__((__always_inline__)) I2C_sched_before(const uint32_t a, const uint32_t b) {
+	return ((int32_t) (a - b) < 0); }
+
+/*!\brief Compute bus load of a job
+** \param [in] cost - job time (us)
+** \param [in] period - job period (us)
+** \return bus load (per mille, 1000 if job doesn't fit in its period)
+**/
+static uint32_t I2C_sched_ratio(const uint32_t cost, const uint32_t period)
+{
+	if (cost >= period)					{ return 1000U; }
+	if (cost > (UINT32_MAX / 1000U))	{ return cost / (period / 1000U); }	// Period above 4s
+	return (cost * 1000U) / period;
+}
+
+/*!\brief Compute bus load of a job set
+** \param [in] job - pointer to an extra job structure accounted along with scheduled jobs (NULL if none)
+** \return bus load (per mille)
+**/
+static uint32_t I2C_sched_set_load(const I2C_JOB * job)
+{
+	uint32_t	load = 0, cost_max = 0, period_min = UINT32_MAX;
+
+	for (uint8_t i = 0 ; i <= i2c_sched.nb ; i++)
+	{
+		const I2C_JOB * const j = (i < i2c_sched.nb) ? i2c_sched.jobs[i] : job;
+
+		if (j == NULL)					{ continue; }
+		load += I2C_sched_ratio(j->cost, j->period);
+		if (j->cost > cost_max)			{ cost_max = j->cost; }
+		if (j->period < period_min)		{ period_min = j->period; }
+	}
+
+	if (period_min != UINT32_MAX)	{ load += I2C_sched_ratio(cost_max, period_min); }	// Running job not preempted
+	return load;
+}
+
+
+/*!\brief Estimate bus time of a read (address phases, register address & data at slave speed, START/STOP conditions)
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in] bytes - number of bytes to read
+** \return estimated time (us, CI2C_SCHED_OVERHEAD included)
+**/
+uint32_t I2C_sched_cost(const I2C_SLAVE * slave, const uint16_t bytes)
+{
+	uint16_t	speed = I2C_slave_get_speed(slave);
+	uint32_t	nb = (uint32_t) bytes + 2;	// Address byte, START/STOP conditions
+
+	if (speed == 0)				{ speed = (uint16_t) I2C_slave_get_xfer_bus(slave)->cfg.speed; }
+	if (speed == 0)				{ speed = (uint16_t) I2C_STD; }
+	if (slave->cfg.reg_size)	{ nb += (uint32_t) slave->cfg.reg_size + 1; }	// Register address write, then repeated START
+
+	return ((nb * 9000U) / speed) + CI2C_SCHED_OVERHEAD;	// 9 clocks per byte
+}
+
+/*!\brief Add a periodic read job (first release right away)
+** \param [in, out] job - pointer to the job structure (shall stay valid until removed)
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - destination buffer (\b bytes long)
+** \param [in] bytes - number of bytes to read
+** \param [in] period - job period (us)
+** \param [in] cb - callback called after each run with job pointer & read status (may be NULL)
+** \return I2C_STATUS status of add attempt (I2C_OK when added, I2C_BUSY if jobs table is full or bus would be overloaded, I2C_NACK if bytes or period is 0)
+**/
+I2C_STATUS I2C_sched_add(I2C_JOB * job, I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const uint32_t period, const ci2c_cb_fct_ptr cb)
+{
+	if ((bytes == 0) || (period == 0))			{ return I2C_NACK; }
+	if (i2c_sched.nb >= CI2C_SCHED_SIZE)		{ return I2C_BUSY; }
+
+	job->slave = slave;
+	job->reg_addr = reg_addr;
+	job->data = data;
+	job->bytes = bytes;
+	job->period = period;
+	job->cb = cb;
+	job->cost = I2C_sched_cost(slave, bytes);
+
+	if (I2C_sched_set_load(job) > CI2C_SCHED_MAX_LOAD)	{ return I2C_BUSY; }	// Deadlines couldn't be guaranteed
+
+	I2C_sched_reset_stats(job);
+	job->release = (uint32_t) micros();
+	i2c_sched.jobs[i2c_sched.nb++] = job;
+
+	return I2C_OK;
+}
+
+/*!\brief Remove a periodic read job
+** \param [in] job - pointer to the job structure
+** \return true if job was scheduled
+**/
+bool I2C_sched_remove(const I2C_JOB * job)
+{
+	for (uint8_t i = 0 ; i < i2c_sched.nb ; i++)
+	{
+		if (i2c_sched.jobs[i] != job)	{ continue; }
+
+		i2c_sched.nb--;
+		for ( ; i < i2c_sched.nb ; i++)	{ i2c_sched.jobs[i] = i2c_sched.jobs[i + 1]; }
+		return true;
+	}
+
+	return false;
+}
+
+/*!\brief Run a job, then release it again one period later (releases already past their deadline skipped)
+** \param [in, out] job - pointer to the job structure
+** \param [in] start - run start time (us)
+** \return false if bus was already owned (job left due)
+**/
+static bool I2C_sched_run(I2C_JOB * job, const uint32_t start)
+{
+	const I2C_STATUS	st = I2C_read(job->slave, job->reg_addr, job->data, job->bytes);
+	const uint32_t		end = (uint32_t) micros();
+	const uint32_t		late = start - job->release;
+
+	if (st == I2C_BUSY)		{ return false; }
+
+	job->stats.runs++;
+	job->stats.jitter_cumul += late;
+	if (late > job->stats.jitter_max)							{ job->stats.jitter_max = late; }
+	if (st != I2C_OK)											{ job->stats.fails++; }
+	if (I2C_sched_before(job->release + job->period, end))		{ job->stats.misses++; }
+
+	job->release += job->period;
+	if (!I2C_sched_before(end, job->release + job->period))	// Next deadline already passed
+	{
+		const uint32_t skip = (end - job->release) / job->period;
+
+		job->release += skip * job->period;
+		job->stats.skips += skip;
+	}
+
+	if (job->cb)	{ job->cb(job, st); }
+	return true;
+}
+
+/*!\brief Run due jobs, earliest deadline first (at most as many runs as scheduled jobs per call)
+** \return number of jobs run
+**/
+uint8_t I2C_sched_process(void)
+{
+	uint8_t nb = 0;
+
+	while (nb < i2c_sched.nb)
+	{
+		const uint32_t	now = (uint32_t) micros();
+		I2C_JOB *		job = NULL;
+
+		for (uint8_t i = 0 ; i < i2c_sched.nb ; i++)
+		{
+			I2C_JOB * const j = i2c_sched.jobs[i];
+
+			if (I2C_sched_before(now, j->release))	{ continue; }	// Not released yet
+			if ((job == NULL) || I2C_sched_before(j->release + j->period, job->release + job->period))	{ job = j; }
+		}
+
+		if (job == NULL)					{ break; }
+		if (!I2C_sched_run(job, now))		{ break; }	// Bus owned (asynchronous transaction): next call
+		nb++;
+	}
+
+	return nb;
+}
+
+/*!\brief Get time left before next job release
+** \return time left (us, 0 if a job is due)
+**/
+uint32_t I2C_sched_next(void)
+{
+	const uint32_t	now = (uint32_t) micros();
+	uint32_t		left = UINT32_MAX;
+
+	for (uint8_t i = 0 ; i < i2c_sched.nb ; i++)
+	{
+		const I2C_JOB * const j = i2c_sched.jobs[i];
+
+		if (!I2C_sched_before(now, j->release))	{ return 0; }
+		if ((j->release - now) < left)			{ left = j->release - now; }
+	}
+
+	return left;
+}
+
+/*!\brief Get bus load of scheduled jobs (admission criterion: utilization plus longest job blocking the shortest period)
+** \return bus load (per mille)
+**/
+uint16_t I2C_sched_load(void)
+{
+	const uint32_t load = I2C_sched_set_load(NULL);
+	return (load > UINT16_MAX) ? UINT16_MAX : (uint16_t) load;
+}
+
+/*!\brief Reset job statistics
+** \param [in, out] job - pointer to the job structure
+** \return nothing
+**/
+void I2C_sched_reset_stats(I2C_JOB * job) {
+	memset(&job->stats, 0, sizeof(job->stats)); }
@@ -0,0 +1,115 @@
+/*!\file ci2c_sched.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c periodic polling scheduler declarations
+** \details Periodic read jobs (deadline at next release) dispatched earliest deadline first from I2C_sched_process.
+**			Job bus time is estimated from slave speed & length when added, and job sets which would overload the bus are refused
+**			(utilization plus longest job blocking the shortest period, jobs not being preempted once on the bus).
+** \note Jobs are run as blocking I2C_read (any bus), to be managed & processed from main loop context only
+**/
+/****************************************************************/
+#ifndef __CI2C_SCHED_H__
+	#define __CI2C_SCHED_H__
+/****************************************************************/
+
+#include "ci2c.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CI2C_SCHED_SIZE
+#define CI2C_SCHED_SIZE			16		//!< Max number of periodic jobs (may be overridden through compiler flags)
+#endif
+
+#ifndef CI2C_SCHED_MAX_LOAD
+#define CI2C_SCHED_MAX_LOAD		900		//!< Max bus load accepted (per mille, margin left to main loop latency)
+#endif
+
+#ifndef CI2C_SCHED_OVERHEAD
+#define CI2C_SCHED_OVERHEAD		40		//!< CPU time accounted to each job run on top of its bus time (us)
+#endif
+
+
+/*!\struct StructI2CJobStats
+** \brief ci2c periodic job statistics
+**/
+typedef struct StructI2CJobStats {
+	uint32_t			runs;		//!< Number of runs
+	uint32_t			fails;		//!< Number of runs not ending with I2C_OK
+	uint32_t			misses;		//!< Number of runs ended past their deadline
+	uint32_t			skips;		//!< Number of releases skipped (job late by more than its period)
+	uint32_t			jitter_cumul;	//!< Cumulated start delay after release (us)
+	uint32_t			jitter_max;	//!< Max start delay after release (us)
+} I2C_JOB_STATS;
+
+/*!\struct StructI2CJob
+** \brief ci2c periodic read job (storage provided by user)
+**/
+typedef struct StructI2CJob {
+	I2C_SLAVE *			slave;		//!< Pointer to the I2C slave structure
+	uint16_t			reg_addr;	//!< Register address in register map
+	uint8_t *			data;		//!< Destination buffer
+	uint16_t			bytes;		//!< Number of bytes to read
+	uint32_t			period;		//!< Job period (us)
+	ci2c_cb_fct_ptr		cb;			//!< Callback called after each run with job pointer & read status (may be NULL)
+	uint32_t			cost;		//!< Estimated job time (us)
+	uint32_t			release;	//!< Current release time (us), deadline at next release
+	I2C_JOB_STATS		stats;		//!< Job statistics
+} I2C_JOB;
+
+
+/*!\brief Estimate bus time of a read (address phases, register address & data at slave speed, START/STOP conditions)
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in] bytes - number of bytes to read
+** \return estimated time (us, CI2C_SCHED_OVERHEAD included)
+**/
+uint32_t I2C_sched_cost(const I2C_SLAVE * slave, const uint16_t bytes);
+
+/*!\brief Add a periodic read job (first release right away)
+** \param [in, out] job - pointer to the job structure (shall stay valid until removed)
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register address in register map
+** \param [in, out] data - destination buffer (\b bytes long)
+** \param [in] bytes - number of bytes to read
+** \param [in] period - job period (us)
+** \param [in] cb - callback called after each run with job pointer & read status (may be NULL)
+** \return I2C_STATUS status of add attempt (I2C_OK when added, I2C_BUSY if jobs table is full or bus would be overloaded, I2C_NACK if bytes or period is 0)
+**/
+I2C_STATUS I2C_sched_add(I2C_JOB * job, I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * data, const uint16_t bytes, const uint32_t period, const ci2c_cb_fct_ptr cb);
+
+/*!\brief Remove a periodic read job
+** \param [in] job - pointer to the job structure
+** \return true if job was scheduled
+**/
+bool I2C_sched_remove(const I2C_JOB * job);
+
+/*!\brief Run due jobs, earliest deadline first (at most as many runs as scheduled jobs per call)
+** \note To be called from loop as often as possible (dispatch latency shows as jitter)
+** \return number of jobs run
+**/
+uint8_t I2C_sched_process(void);
+
+/*!\brief Get time left before next job release
+** \return time left (us, 0 if a job is due)
+**/
+uint32_t I2C_sched_next(void);
+
+/*!\brief Get bus load of scheduled jobs (admission criterion: utilization plus longest job blocking the shortest period)
+** \return bus load (per mille)
+**/
+uint16_t I2C_sched_load(void);
+
+/*!\brief Reset job statistics
+** \param [in, out] job - pointer to the job structure
+** \return nothing
+**/
+void I2C_sched_reset_stats(I2C_JOB * job);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,344 @@
+/*!\file ci2c_smbus.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c SMBus
+** \details SMBus protocols over I2C_SLAVE, Packet Error Code updated byte after byte from a program memory table
+**			(no second pass over buffers), checked on reads; message level buses get a single message list with PEC computed beforehand.
+**/
+
+#include "ci2c_smbus.h"
+
+
+/*!\struct StructI2CSmbusOp
+** \brief SMBus transaction descriptor (given as data to SMBus transaction function)
+**/
+typedef struct StructI2CSmbusOp {
+	const uint8_t *		wr;			//!< Data written after command code
+	uint8_t				wr_nb;		//!< Number of bytes written after command code
+	bool				wr_blk;		//!< Byte count sent before written data
+	uint8_t *			rd;			//!< Data read (NULL for write only transactions)
+	uint8_t				rd_nb;		//!< Number of bytes to read (max for block read)
+	bool				rd_blk;		//!< Byte count received before read data
+	uint8_t				got;		//!< Number of data bytes read
+	bool				pec_err;	//!< PEC mismatch on last attempt
+} I2C_SMBUS_OP;
+
+
+/*!\brief SMBus PEC table (CRC-8, polynomial 0x07, one entry per byte value)
+**/
+static const uint8_t smbus_crc8[256] PROGMEM = {
+	0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+	0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+	0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+	0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+	0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+	0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+	0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+	0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+	0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+	0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+	0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+	0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+	0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+	0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+	0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+	0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3
+};
+
+
+/*!\brief SMBus PEC update with a single byte
+** \attribute inline
+** \param [in] crc - current PEC
+** \param [in] dat - byte to account
+** \return updated PEC
+**/
+static inline uint8_t __attribute__((__always_inline__)) I2C_smbus_crc8(const uint8_t crc, const uint8_t dat) {
+	return pgm_read_byte(&smbus_crc8[crc ^ dat]); }
+
+/*!\brief SMBus Packet Error Code update (CRC-8, polynomial x8 + x2 + x + 1, table driven)
+** \param [in] crc - current PEC (0 before address byte)
+** \param [in] data - pointer to bytes to account
+** \param [in] nb - number of bytes
+** \return updated PEC
+**/
+uint8_t I2C_smbus_pec(uint8_t crc, const uint8_t * data, const uint16_t nb)
+{
+	for (uint16_t i = 0 ; i < nb ; i++)	{ crc = I2C_smbus_crc8(crc, data[i]); }
+	return crc;
+}
+
+
+/*!\brief SMBus transaction attempt (command code & data written, then data read after repeated START), PEC updated as bytes go
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in, out] data - pointer to the SMBus transaction descriptor
+** \param [in] bytes - number of bytes of transaction (unused)
+** \return Boolean indicating success/fail of transaction attempt
+**/
+static bool I2C_smbus_fct(I2C_SLAVE * slave, const uint16_t cmd, uint8_t * data, const uint16_t bytes)
+{
+	I2C_SMBUS_OP * const		op = (I2C_SMBUS_OP *) data;
+	I2C_BUS * const				bus = I2C_slave_get_xfer_bus(slave);
+	const I2C_BUS_OPS * const	ops = bus->ops;
+	const uint8_t				sla = (uint8_t) (I2C_slave_get_xfer_addr(slave) << 1);
+	const bool					pec = slave->cfg.pec;
+	uint8_t						crc, nb;
+
+	(void) bytes;
+	op->pec_err = false;
+	op->got = 0;
+
+	if (ops->start(bus) == false)									{ return false; }
+	if (ops->sndSla(bus, (uint8_t) (sla | I2C_WRITE)) == false)		{ return false; }
+	if (ops->wr8(bus, (uint8_t) cmd) == false)						{ return false; }
+	crc = I2C_smbus_crc8(I2C_smbus_crc8(0, (uint8_t) (sla | I2C_WRITE)), (uint8_t) cmd);
+
+	if (op->wr_blk)
+	{
+		if (ops->wr8(bus, op->wr_nb) == false)						{ return false; }
+		crc = I2C_smbus_crc8(crc, op->wr_nb);
+	}
+	for (uint8_t i = 0 ; i < op->wr_nb ; i++)
+	{
+		if (ops->wr8(bus, op->wr[i]) == false)						{ return false; }
+		crc = I2C_smbus_crc8(crc, op->wr[i]);
+	}
+
+	if (op->rd == NULL)
+	{
+		if ((pec) && (ops->wr8(bus, crc) == false))				{ return false; }
+		return ops->stop(bus);
+	}
+
+	if (ops->start(bus) == false)									{ return false; }	// Repeated START
+	if (ops->sndSla(bus, (uint8_t) (sla | I2C_READ)) == false)		{ return false; }
+	crc = I2C_smbus_crc8(crc, (uint8_t) (sla | I2C_READ));
+
+	nb = op->rd_nb;
+	if (op->rd_blk)
+	{
+		uint8_t cnt;
+
+		if (ops->rd8(bus, &cnt, true) == false)						{ return false; }
+		crc = I2C_smbus_crc8(crc, cnt);
+		if ((cnt == 0) || (cnt > nb))	// Block doesn't fit: last byte clocked not acknowledged to end transaction
+		{
+			(void) ops->rd8(bus, &cnt, false);
+			(void) ops->stop(bus);
+			return false;
+		}
+		nb = cnt;
+	}
+	for (uint8_t i = 0 ; i < nb ; i++)
+	{
+		if (ops->rd8(bus, &op->rd[i], (pec) || (i != (nb - 1))) == false)	{ return false; }	// Last byte not acknowledged (PEC excepted)
+		crc = I2C_smbus_crc8(crc, op->rd[i]);
+	}
+	op->got = nb;
+
+	if (pec)
+	{
+		uint8_t rx;
+
+		if (ops->rd8(bus, &rx, false) == false)						{ return false; }
+		op->pec_err = (rx != crc);
+	}
+
+	return (ops->stop(bus)) && (!op->pec_err);
+}
+
+/*!\brief Fill a message of SMBus transaction on a message level bus
+** \attribute inline
+** \param [out] msg - pointer to the message
+** \param [in] addr - 7 bits slave address
+** \param [in] flags - message flags (I2C_MSG_xxx)
+** \param [in] data - pointer to message data
+** \param [in] len - message length
+** \return nothing
+**/
+static inline void __attribute__((__always_inline__)) I2C_smbus_msg(I2C_MSG * msg, const uint8_t addr, const uint8_t flags, uint8_t * data, const uint16_t len) {
+	msg->addr = addr;
+	msg->flags = flags;
+	msg->len = len;
+	msg->data = data; }
+
+/*!\brief SMBus transaction attempt on a message level bus (e.g. Linux i2c-dev): single message list, PEC computed before writing,
+**			checked once read
+** \note Block read clocks the largest block expected (byte count can't be known beforehand): PEC is then the byte after actual block
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in, out] data - pointer to the SMBus transaction descriptor
+** \param [in] bytes - number of bytes of transaction (unused)
+** \return Boolean indicating success/fail of transaction attempt
+**/
+static bool I2C_smbus_fct_msgs(I2C_SLAVE * slave, const uint16_t cmd, uint8_t * data, const uint16_t bytes)
+{
+	I2C_SMBUS_OP * const	op = (I2C_SMBUS_OP *) data;
+	I2C_BUS * const			bus = I2C_slave_get_xfer_bus(slave);
+	const uint8_t			addr = I2C_slave_get_xfer_addr(slave);
+	const bool				pec = slave->cfg.pec;
+	uint8_t					hdr[2] = { (uint8_t) cmd, op->wr_nb };	// Command code & byte count
+	uint8_t					cnt = 0, rx = 0, crc, nb;
+	I2C_MSG					msgs[5];
+	uint8_t					n = 0;
+
+	(void) bytes;
+	op->pec_err = false;
+	op->got = 0;
+
+	crc = I2C_smbus_crc8(0, (uint8_t) ((addr << 1) | I2C_WRITE));
+	crc = I2C_smbus_pec(crc, hdr, (uint16_t) (1 + op->wr_blk));
+	crc = I2C_smbus_pec(crc, op->wr, op->wr_nb);
+
+	I2C_smbus_msg(&msgs[n++], addr, 0, hdr, (uint16_t) (1 + op->wr_blk));
+	if (op->wr_nb)	{ I2C_smbus_msg(&msgs[n++], addr, I2C_MSG_NOSTART, (uint8_t *) op->wr, op->wr_nb); }
+
+	if (op->rd == NULL)
+	{
+		if (pec)	{ I2C_smbus_msg(&msgs[n++], addr, I2C_MSG_NOSTART, &crc, 1); }
+		return bus->ops->xfer(bus, msgs, n);
+	}
+
+	if (op->rd_blk)	{ I2C_smbus_msg(&msgs[n++], addr, I2C_MSG_RD, &cnt, 1); }
+	I2C_smbus_msg(&msgs[n++], addr, op->rd_blk ? (I2C_MSG_RD | I2C_MSG_NOSTART) : I2C_MSG_RD, op->rd, op->rd_nb);
+	if (pec)		{ I2C_smbus_msg(&msgs[n++], addr, I2C_MSG_RD | I2C_MSG_NOSTART, &rx, 1); }
+	if (bus->ops->xfer(bus, msgs, n) == false)	{ return false; }
+
+	crc = I2C_smbus_crc8(crc, (uint8_t) ((addr << 1) | I2C_READ));
+	nb = op->rd_nb;
+	if (op->rd_blk)
+	{
+		if ((cnt == 0) || (cnt > nb))	{ return false; }	// Block doesn't fit
+		crc = I2C_smbus_crc8(crc, cnt);
+		if (cnt < nb)	{ rx = op->rd[cnt]; }	// PEC right after actual block
+		nb = cnt;
+	}
+	crc = I2C_smbus_pec(crc, op->rd, nb);
+	op->got = nb;
+
+	op->pec_err = (pec) && (rx != crc);
+	return !op->pec_err;
+}
+
+/*!\brief Perform SMBus transaction (bus retries in case of failure, PEC mismatch included)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in, out] op - pointer to the SMBus transaction descriptor
+** \return I2C_STATUS status of transaction (I2C_PEC_ERR if last attempt failed on PEC mismatch)
+**/
+static I2C_STATUS I2C_smbus_comm(I2C_SLAVE * slave, const uint8_t cmd, I2C_SMBUS_OP * op)
+{
+	const uint16_t		bytes = (uint16_t) (1 + op->wr_blk + op->wr_nb + ((op->rd) ? (1 + op->rd_blk + op->rd_nb) : 0) + slave->cfg.pec);
+	const ci2c_fct_ptr	fc = (I2C_slave_get_xfer_bus(slave)->ops->xfer) ? (ci2c_fct_ptr) I2C_smbus_fct_msgs : (ci2c_fct_ptr) I2C_smbus_fct;
+
+	op->pec_err = false;
+	if ((I2C_slave_xfer(slave, fc, cmd, (uint8_t *) op, bytes) == I2C_NACK) && (op->pec_err))
+	{
+		slave->status = I2C_PEC_ERR;
+	}
+	I2C_slave_forget_reg_addr(slave);	// Command code is not a register address to be continued
+
+	return slave->status;
+}
+
+
+/*!\brief SMBus Write Byte
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in] val - data byte
+** \return I2C_STATUS status of write attempt
+**/
+I2C_STATUS I2C_smbus_write_byte(I2C_SLAVE * slave, const uint8_t cmd, const uint8_t val)
+{
+	I2C_SMBUS_OP op = { &val, 1, false, NULL, 0, false, 0, false };
+	return I2C_smbus_comm(slave, cmd, &op);
+}
+
+/*!\brief SMBus Read Byte
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in, out] val - pointer to data byte
+** \return I2C_STATUS status of read attempt (I2C_PEC_ERR on PEC mismatch)
+**/
+I2C_STATUS I2C_smbus_read_byte(I2C_SLAVE * slave, const uint8_t cmd, uint8_t * val)
+{
+	I2C_SMBUS_OP op = { NULL, 0, false, val, 1, false, 0, false };
+	return I2C_smbus_comm(slave, cmd, &op);
+}
+
+/*!\brief SMBus Write Word (low byte first)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in] val - data word
+** \return I2C_STATUS status of write attempt
+**/
+I2C_STATUS I2C_smbus_write_word(I2C_SLAVE * slave, const uint8_t cmd, const uint16_t val)
+{
+	const uint8_t	wr[2] = { (uint8_t) val, (uint8_t) (val >> 8) };
+	I2C_SMBUS_OP	op = { wr, 2, false, NULL, 0, false, 0, false };
+
+	return I2C_smbus_comm(slave, cmd, &op);
+}
+
+/*!\brief SMBus Read Word (low byte first)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in, out] val - pointer to data word
+** \return I2C_STATUS status of read attempt (I2C_PEC_ERR on PEC mismatch)
+**/
+I2C_STATUS I2C_smbus_read_word(I2C_SLAVE * slave, const uint8_t cmd, uint16_t * val)
+{
+	uint8_t			rd[2];
+	I2C_SMBUS_OP	op = { NULL, 0, false, rd, 2, false, 0, false };
+
+	if (I2C_smbus_comm(slave, cmd, &op) == I2C_OK)	{ *val = (uint16_t) (rd[0] | (rd[1] << 8)); }
+	return slave->status;
+}
+
+/*!\brief SMBus Process Call (word written, word read back in the same transaction)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in] val - data word written
+** \param [in, out] res - pointer to data word read
+** \return I2C_STATUS status of call attempt (I2C_PEC_ERR on PEC mismatch)
+**/
+I2C_STATUS I2C_smbus_process_call(I2C_SLAVE * slave, const uint8_t cmd, const uint16_t val, uint16_t * res)
+{
+	const uint8_t	wr[2] = { (uint8_t) val, (uint8_t) (val >> 8) };
+	uint8_t			rd[2];
+	I2C_SMBUS_OP	op = { wr, 2, false, rd, 2, false, 0, false };
+
+	if (I2C_smbus_comm(slave, cmd, &op) == I2C_OK)	{ *res = (uint16_t) (rd[0] | (rd[1] << 8)); }
+	return slave->status;
+}
+
+/*!\brief SMBus Block Write (byte count sent before data)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in] data - pointer to data block
+** \param [in] len - data block length (1 to CI2C_SMBUS_BLOCK_MAX)
+** \return I2C_STATUS status of write attempt (I2C_NACK if length is out of range)
+**/
+I2C_STATUS I2C_smbus_block_write(I2C_SLAVE * slave, const uint8_t cmd, const uint8_t * data, const uint8_t len)
+{
+	I2C_SMBUS_OP op = { data, len, true, NULL, 0, false, 0, false };
+
+	if ((len == 0) || (len > CI2C_SMBUS_BLOCK_MAX))	{ return slave->status = I2C_NACK; }
+	return I2C_smbus_comm(slave, cmd, &op);
+}
+
+/*!\brief SMBus Block Read (byte count received before data)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in, out] data - pointer to data block
+** \param [in, out] len - pointer to data block size, set to number of bytes read (transaction fails if block sent is larger)
+** \return I2C_STATUS status of read attempt (I2C_PEC_ERR on PEC mismatch)
+**/
+I2C_STATUS I2C_smbus_block_read(I2C_SLAVE * slave, const uint8_t cmd, uint8_t * data, uint8_t * len)
+{
+	I2C_SMBUS_OP op = { NULL, 0, false, data, (*len > CI2C_SMBUS_BLOCK_MAX) ? CI2C_SMBUS_BLOCK_MAX : *len, true, 0, false };
+
+	(void) I2C_smbus_comm(slave, cmd, &op);
+	*len = (slave->status == I2C_OK) ? op.got : 0;
+	return slave->status;
+}
@@ -0,0 +1,115 @@
+/*!\file ci2c_smbus.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c SMBus declarations
+** \details SMBus protocols (byte / word data, process call, block read / write) over I2C_SLAVE, with optional Packet Error Code:
+**			CRC-8 updated from a program memory table as each byte goes through the bus, checked on reads (I2C_PEC_ERR on mismatch).
+**			Transactions get the same retries, speed profile, mux channel & circuit breaker handling as I2C_read / I2C_write.
+** \note On message level buses (e.g. Linux i2c-dev), each transaction is a single message list with PEC computed beforehand
+**		 and checked once read; block reads then clock the largest block expected (byte count can't be known beforehand)
+**/
+/****************************************************************/
+#ifndef __CI2C_SMBUS_H__
+	#define __CI2C_SMBUS_H__
+/****************************************************************/
+
+#include "ci2c.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CI2C_SMBUS_BLOCK_MAX		32		//!< SMBus block max length (bytes)
+
+
+/*!\brief Enable/disable SMBus Packet Error Code on slave transactions
+** \attribute inline
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] pec - true to append PEC to writes and check it on reads
+** \return nothing
+**/
+inline void __attribute__((__always_inline__)) I2C_smbus_set_pec(I2C_SLAVE * slave, const bool pec) {
+	slave->cfg.pec = pec; }
+
+/*!\brief Get SMBus Packet Error Code use on slave transactions
+** \attribute inline
+** \param [in] slave - pointer to the I2C slave structure
+** \return true if PEC enabled
+**/
+inline bool __attribute__((__always_inline__)) I2C_smbus_get_pec(const I2C_SLAVE * slave) {
+	return slave->cfg.pec; }
+
+/*!\brief SMBus Packet Error Code update (CRC-8, polynomial x8 + x2 + x + 1, table driven)
+** \param [in] crc - current PEC (0 before address byte)
+** \param [in] data - pointer to bytes to account
+** \param [in] nb - number of bytes
+** \return updated PEC
+**/
+uint8_t I2C_smbus_pec(uint8_t crc, const uint8_t * data, const uint16_t nb);
+
+/*!\brief SMBus Write Byte
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in] val - data byte
+** \return I2C_STATUS status of write attempt
+**/
+I2C_STATUS I2C_smbus_write_byte(I2C_SLAVE * slave, const uint8_t cmd, const uint8_t val);
+
+/*!\brief SMBus Read Byte
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in, out] val - pointer to data byte
+** \return I2C_STATUS status of read attempt (I2C_PEC_ERR on PEC mismatch)
+**/
+I2C_STATUS I2C_smbus_read_byte(I2C_SLAVE * slave, const uint8_t cmd, uint8_t * val);
+
+/*!\brief SMBus Write Word (low byte first)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in] val - data word
+** \return I2C_STATUS status of write attempt
+**/
+I2C_STATUS I2C_smbus_write_word(I2C_SLAVE * slave, const uint8_t cmd, const uint16_t val);
+
+/*!\brief SMBus Read Word (low byte first)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in, out] val - pointer to data word
+** \return I2C_STATUS status of read attempt (I2C_PEC_ERR on PEC mismatch)
+**/
+I2C_STATUS I2C_smbus_read_word(I2C_SLAVE * slave, const uint8_t cmd, uint16_t * val);
+
+/*!\brief SMBus Process Call (word written, word read back in the same transaction)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in] val - data word written
+** \param [in, out] res - pointer to data word read
+** \return I2C_STATUS status of call attempt (I2C_PEC_ERR on PEC mismatch)
+**/
+I2C_STATUS I2C_smbus_process_call(I2C_SLAVE * slave, const uint8_t cmd, const uint16_t val, uint16_t * res);
+
+/*!\brief SMBus Block Write (byte count sent before data)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in] data - pointer to data block
+** \param [in] len - data block length (1 to CI2C_SMBUS_BLOCK_MAX)
+** \return I2C_STATUS status of write attempt (I2C_NACK if length is out of range)
+**/
+I2C_STATUS I2C_smbus_block_write(I2C_SLAVE * slave, const uint8_t cmd, const uint8_t * data, const uint8_t len);
+
+/*!\brief SMBus Block Read (byte count received before data)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] cmd - command code
+** \param [in, out] data - pointer to data block
+** \param [in, out] len - pointer to data block size, set to number of bytes read (transaction fails if block sent is larger)
+** \return I2C_STATUS status of read attempt (I2C_PEC_ERR on PEC mismatch)
+**/
+I2C_STATUS I2C_smbus_block_read(I2C_SLAVE * slave, const uint8_t cmd, uint8_t * data, uint8_t * len);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,234 @@
+/*!\file ci2c_stream.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c streaming reads
+** \details A slave register (sensor FIFO, ADC conversion result...) is read chunk after chunk in background
+**			(interrupt driven transactions) straight into a caller supplied ring of chunk slots (2 slots: double buffer).
+**			Producer (interrupt) only writes head index, consumer (application) only writes tail index: no lock needed.
+**/
+
+#include "ci2c_stream.h"
+
+/*!\struct i2c_s
+** \brief static ci2c started streams
+**/
+static struct {
+	I2C_STREAM *		first;		//!< Started streams list
+	I2C_STREAM *		cur;		//!< Stream owning the chunk read in progress
+	uint8_t				nb;			//!< Number of started streams
+} i2c_s;
+
+
+// Needed prototypes
+static void I2C_stream_launch(I2C_STREAM * from);
+
+
+/*!\brief Test if stream has a chunk read to launch
+** \param [in] stream - pointer to the stream structure
+** \return true if a chunk read is wanted
+**/
+static bool I2C_stream_wants(I2C_STREAM * stream)
+{
+	if ((!stream->run) || (stream->reading))							{ return false; }
+	if ((stream->mode == I2C_STREAM_TRIGGERED) && (!stream->pending))	{ return false; }
+
+	if (I2C_stream_available(stream) >= stream->nb_slots)	// All slots filled: wait for consumer
+	{
+		if (!stream->stalled)	{ stream->stalled = true; stream->overruns++; }
+		return false;
+	}
+
+	return true;
+}
+
+/*!\brief Chunk read completion callback (commits chunk and launches next read)
+** \param [in, out] slave - pointer to the I2C slave structure
+** \param [in] status - transaction final status
+** \return nothing
+**/
+static void I2C_stream_cb(void * slave, const I2C_STATUS status)
+{
+	I2C_STREAM * stream = i2c_s.cur;
+
+	stream->reading = false;
+	i2c_s.cur = NULL;
+
+	if (status == I2C_OK)
+	{
+		stream->head++;		// Chunk filled (slot now owned by consumer)
+		stream->chunks++;
+		if (stream->pending)	{ stream->pending--; }
+	}
+	else	{ stream->run = false; }	// Slave not answering: stream stopped (slave status tells why)
+
+	I2C_stream_launch(stream->next);	// Other streams served first (round robin)
+	if ((status == I2C_OK) && (stream->cb))	{ stream->cb(slave, status); }
+}
+
+/*!\brief Launch next wanted chunk read (shall be called with interrupts disabled or from interrupt)
+** \param [in] from - stream to start looking from (round robin, NULL for first started stream)
+** \return nothing
+**/
+static void I2C_stream_launch(I2C_STREAM * from)
+{
+	I2C_STREAM * stream = i2c_s.first;
+
+	if ((i2c_s.cur) || (I2C_is_busy()))	{ return; }	// Bus owned: launched on completion or by I2C_stream_process
+
+	if (from)
+	{
+		while ((stream != NULL) && (stream != from))	{ stream = stream->next; }
+		if (stream == NULL)	{ return; }		// Stream not started (or stopped meanwhile): nothing to launch
+	}
+
+	for (uint8_t n = i2c_s.nb ; n != 0 ; n--)	// Each started stream looked at once at most
+	{
+		if (I2C_stream_wants(stream))
+		{
+			uint8_t * slot = &stream->buf[(stream->head & (stream->nb_slots - 1)) * stream->chunk];
+
+			i2c_s.cur = stream;
+			stream->reading = true;
+			if (I2C_read_async(stream->slave, stream->reg_addr, slot, stream->chunk, I2C_stream_cb) == I2C_OK)	{ return; }
+
+			stream->reading = false;
+			i2c_s.cur = NULL;
+			return;
+		}
+
+		stream = stream->next ? stream->next : i2c_s.first;
+	}
+}
+
+/*!\brief Launch next wanted chunk read from application context
+** \param [in] from - stream to start looking from
+** \return nothing
+**/
+static void I2C_stream_kick(I2C_STREAM * from)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	I2C_stream_launch(from);
+	SREG = sreg;
+}
+
+
+/*!\brief Init streaming read context
+** \param [in, out] stream - pointer to the stream structure to init
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register read on each chunk (FIFO data register)
+** \param [in] buf - chunk slots storage (nb_slots * chunk bytes)
+** \param [in] chunk - chunk size (bytes read per transaction)
+** \param [in] nb_slots - number of chunk slots (power of 2, 2 for double buffering)
+** \param [in] mode - refill mode
+** \param [in] cb - callback called (from interrupt) each time a chunk is filled (may be NULL)
+** \return true if stream initialized (false if chunk is 0 or nb_slots is not a power of 2)
+**/
+bool I2C_stream_init(I2C_STREAM * stream, I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * buf, const uint16_t chunk, const uint8_t nb_slots, const I2C_STREAM_MODE mode, const ci2c_cb_fct_ptr cb)
+{
+	if ((chunk == 0) || (nb_slots == 0) || ((nb_slots & (nb_slots - 1)) != 0))	{ return false; }
+
+	memset(stream, 0, sizeof(I2C_STREAM));
+	stream->slave = slave;
+	stream->reg_addr = reg_addr;
+	stream->buf = buf;
+	stream->chunk = chunk;
+	stream->nb_slots = nb_slots;
+	stream->mode = mode;
+	stream->cb = cb;
+
+	return true;
+}
+
+/*!\brief Start streaming (first chunk read launched in I2C_STREAM_CONTINUOUS mode)
+** \param [in, out] stream - pointer to the stream structure
+** \return nothing
+**/
+void I2C_stream_start(I2C_STREAM * stream)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	if (!stream->run)
+	{
+		I2C_STREAM ** link = &i2c_s.first;
+
+		while ((*link != NULL) && (*link != stream))	{ link = &(*link)->next; }
+		if (*link == NULL)	{ stream->next = NULL; *link = stream; i2c_s.nb++; }
+
+		stream->stalled = false;
+		stream->run = true;
+	}
+	I2C_stream_launch(stream);
+	SREG = sreg;
+}
+
+/*!\brief Stop streaming (chunk read in progress is completed, filled slots are kept)
+** \param [in, out] stream - pointer to the stream structure
+** \return nothing
+**/
+void I2C_stream_stop(I2C_STREAM * stream)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	stream->run = false;
+	stream->pending = 0;
+	stream->stalled = false;
+	for (I2C_STREAM ** link = &i2c_s.first ; *link != NULL ; link = &(*link)->next)
+	{
+		if (*link == stream)	{ *link = stream->next; i2c_s.nb--; break; }
+	}
+	stream->next = NULL;	// Completion of a chunk read in progress resumes other streams from first one
+	SREG = sreg;
+}
+
+/*!\brief Request one chunk read (I2C_STREAM_TRIGGERED mode, may be called from interrupt)
+** \param [in, out] stream - pointer to the stream structure
+** \return nothing
+**/
+void I2C_stream_trigger(I2C_STREAM * stream)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	if (stream->pending != 0xFF)	{ stream->pending++; }
+	I2C_stream_launch(stream);
+	SREG = sreg;
+}
+
+/*!\brief Get oldest filled chunk
+** \param [in] stream - pointer to the stream structure
+** \return Pointer to chunk (NULL if no chunk filled)
+**/
+uint8_t * I2C_stream_peek(const I2C_STREAM * stream)
+{
+	if (I2C_stream_available(stream) == 0)	{ return NULL; }
+	return &stream->buf[(stream->tail & (stream->nb_slots - 1)) * stream->chunk];
+}
+
+/*!\brief Release oldest filled chunk (slot given back to producer)
+** \param [in, out] stream - pointer to the stream structure
+** \return nothing
+**/
+void I2C_stream_release(I2C_STREAM * stream)
+{
+	if (I2C_stream_available(stream) == 0)	{ return; }
+
+	stream->tail++;
+	if (stream->stalled)
+	{
+		stream->stalled = false;
+		I2C_stream_kick(stream);
+	}
+}
+
+/*!\brief Check chunk read progress (I2C_async_process), then launch pending chunk reads if bus is idle
+** \return nothing
+**/
+void I2C_stream_process(void)
+{
+	(void) I2C_async_process();
+	I2C_stream_kick(NULL);
+}
@@ -0,0 +1,114 @@
+/*!\file ci2c_stream.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c streaming reads declarations
+** \details A slave register (sensor FIFO, ADC conversion result...) is read chunk after chunk in background
+**			(interrupt driven transactions) straight into a caller supplied ring of chunk slots (2 slots: double buffer).
+**			Producer (interrupt) only writes head index, consumer (application) only writes tail index: no lock needed.
+**/
+/****************************************************************/
+#ifndef __CI2C_STREAM_H__
+	#define __CI2C_STREAM_H__
+/****************************************************************/
+
+#include "ci2c.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!\enum enI2C_STREAM_MODE
+** \brief Streaming refill mode
+**/
+typedef enum __attribute__((__packed__)) enI2C_STREAM_MODE {
+	I2C_STREAM_CONTINUOUS = 0,	//!< Next chunk read as soon as previous one is completed (while a slot is free)
+	I2C_STREAM_TRIGGERED		//!< One chunk read per I2C_stream_trigger call (e.g. from slave FIFO watermark interrupt pin)
+} I2C_STREAM_MODE;
+
+
+/*!\struct StructI2CStream
+** \brief ci2c streaming read context (storage provided by user)
+**/
+typedef struct StructI2CStream {
+	I2C_SLAVE *			slave;		//!< Pointer to the I2C slave structure
+	uint16_t			reg_addr;	//!< Register read on each chunk (not incremented)
+	uint8_t *			buf;		//!< Chunk slots storage (nb_slots * chunk bytes)
+	uint16_t			chunk;		//!< Chunk size (bytes read per transaction)
+	uint8_t				nb_slots;	//!< Number of chunk slots (power of 2)
+	I2C_STREAM_MODE		mode;		//!< Refill mode
+	volatile uint8_t	head;		//!< Producer index (chunks filled, free running, written from interrupt only)
+	volatile uint8_t	tail;		//!< Consumer index (chunks released, free running, written by application only)
+	volatile uint8_t	pending;	//!< Triggers not served yet (I2C_STREAM_TRIGGERED)
+	volatile bool		reading;	//!< Chunk read in progress
+	volatile bool		stalled;	//!< Producer waiting for a free slot
+	volatile bool		run;		//!< Stream started
+	uint32_t			chunks;		//!< Number of chunks read
+	uint32_t			overruns;	//!< Number of times producer found all slots filled (consumer behind)
+	ci2c_cb_fct_ptr		cb;			//!< Chunk ready callback (from interrupt, may be NULL)
+	struct StructI2CStream *	next;	//!< Next started stream
+} I2C_STREAM;
+
+
+/*!\brief Init streaming read context
+** \param [in, out] stream - pointer to the stream structure to init
+** \param [in] slave - pointer to the I2C slave structure
+** \param [in] reg_addr - register read on each chunk (FIFO data register)
+** \param [in] buf - chunk slots storage (nb_slots * chunk bytes)
+** \param [in] chunk - chunk size (bytes read per transaction)
+** \param [in] nb_slots - number of chunk slots (power of 2, 2 for double buffering)
+** \param [in] mode - refill mode
+** \param [in] cb - callback called (from interrupt) each time a chunk is filled (may be NULL)
+** \return true if stream initialized (false if chunk is 0 or nb_slots is not a power of 2)
+**/
+bool I2C_stream_init(I2C_STREAM * stream, I2C_SLAVE * slave, const uint16_t reg_addr, uint8_t * buf, const uint16_t chunk, const uint8_t nb_slots, const I2C_STREAM_MODE mode, const ci2c_cb_fct_ptr cb);
+
+/*!\brief Start streaming (first chunk read launched in I2C_STREAM_CONTINUOUS mode)
+** \param [in, out] stream - pointer to the stream structure
+** \return nothing
+**/
+void I2C_stream_start(I2C_STREAM * stream);
+
+/*!\brief Stop streaming (chunk read in progress is completed, filled slots are kept)
+** \param [in, out] stream - pointer to the stream structure
+** \return nothing
+**/
+void I2C_stream_stop(I2C_STREAM * stream);
+
+/*!\brief Request one chunk read (I2C_STREAM_TRIGGERED mode, may be called from interrupt)
+** \param [in, out] stream - pointer to the stream structure
+** \return nothing
+**/
+void I2C_stream_trigger(I2C_STREAM * stream);
+
+/*!\brief Get oldest filled chunk
+** \param [in] stream - pointer to the stream structure
+** \return Pointer to chunk (NULL if no chunk filled)
+**/
+uint8_t * I2C_stream_peek(const I2C_STREAM * stream);
+
+/*!\brief Release oldest filled chunk (slot given back to producer)
+** \param [in, out] stream - pointer to the stream structure
+** \return nothing
+**/
+void I2C_stream_release(I2C_STREAM * stream);
+
+/*!\brief Check chunk read progress (I2C_async_process), then launch pending chunk reads if bus is idle
+** \note To be called from loop while streaming (delayed retries, deadline, bus owned by another transaction while triggering/releasing)
+** \return nothing
+**/
+void I2C_stream_process(void);
+
+/*!\brief Get number of filled chunks
+** \param [in] stream - pointer to the stream structure
+** \return Number of chunks filled and not released
+**/
+inline uint8_t __attribute__((__always_inline__)) I2C_stream_available(const I2C_STREAM * stream) {
+	return (uint8_t) (stream->head - stream->tail); }
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,269 @@
+/*!\file ci2c_sw.c
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c bit-banged bus
+** \details Lines are driven low by setting pin as output (port output latch cleared) and released by setting pin as input,
+**			SCL is read back after release to follow clock stretching (bounded by bus timeout),
+**			SDA is read back when released to detect arbitration loss.
+**/
+
+#include "ci2c_sw.h"
+
+#if defined(__AVR__)
+	#include <util/delay_basic.h>
+#endif
+
+#define SDA_LOW(sw)				I2C_sw_dir((sw)->sda_dir, (sw)->sda_mask, true)		//!< pull SDA low
+#define SDA_REL(sw)				I2C_sw_dir((sw)->sda_dir, (sw)->sda_mask, false)	//!< release SDA
+#define SCL_LOW(sw)				I2C_sw_dir((sw)->scl_dir, (sw)->scl_mask, true)		//!< pull SCL low
+#define SCL_REL(sw)				I2C_sw_dir((sw)->scl_dir, (sw)->scl_mask, false)	//!< release SCL
+#define SDA_IN(sw)				((*(sw)->sda_in & (sw)->sda_mask) != 0)				//!< SDA line level
+#define SCL_IN(sw)				((*(sw)->scl_in & (sw)->scl_mask) != 0)				//!< SCL line level
+#define I2C_SW_DELAY(sw)		_delay_loop_1((sw)->half)							//!< wait for half SCL period
+
+#define I2C_SW(bus)				((I2C_SW_BUS *) (bus))								//!< bit-banged bus from its generic bus
+
+
+// Bit-banged backend prototypes
+static uint16_t I2C_sw_set_speed(I2C_BUS * bus, const uint16_t speed);
+static bool I2C_sw_start(I2C_BUS * bus);
+static bool I2C_sw_stop(I2C_BUS * bus);
+static bool I2C_sw_wr8(I2C_BUS * bus, const uint8_t dat);
+static bool I2C_sw_rd8(I2C_BUS * bus, uint8_t * dat, const bool ack);
+
+static const I2C_BUS_OPS i2c_sw_ops = { I2C_sw_set_speed, I2C_sw_start, I2C_sw_stop, I2C_sw_wr8, I2C_sw_wr8, I2C_sw_rd8, NULL, NULL, NULL };	//!< Bit-banged backend operations (address byte sent as data byte, no burst: bit timing dominates)
+
+
+/*!\brief Drive (output) or release (input) a line: port direction register read-modify-write with interrupts disabled
+**			(register shared with the other pins of the port, which interrupt routines may change meanwhile)
+** \attribute inline
+** \param [in, out] dir - pointer to the port direction register
+** \param [in] mask - pin mask in port
+** \param [in] low - true to pull line low, false to release it
+** \return nothing
+**/
+static inline void __attribute__((__always_inline__)) I2C_sw_dir(volatile uint8_t * dir, const uint8_t mask, const bool low)
+{
+	const uint8_t sreg = SREG;
+
+	cli();
+	if (low)	{ *dir |= mask; }
+	else		{ *dir &= (uint8_t) ~mask; }
+	SREG = sreg;
+}
+
+
+/*!\brief Release both lines (STOP like sequence, bus not owned anymore), slaves internal pointers become unknown
+** \param [in, out] sw - pointer to the bit-banged bus structure
+** \return nothing
+**/
+static void I2C_sw_abort(I2C_SW_BUS * sw)
+{
+	SCL_REL(sw);
+	I2C_SW_DELAY(sw);
+	SDA_REL(sw);
+	I2C_SW_DELAY(sw);
+	sw->started = false;
+	I2C_bus_forget_regs(&sw->bus);
+}
+
+/*!\brief Release SCL and wait for it to be high (slave may stretch clock)
+** \param [in, out] sw - pointer to the bit-banged bus structure
+** \return true if SCL high (false on timeout)
+**/
+static bool I2C_sw_clock(I2C_SW_BUS * sw)
+{
+	SCL_REL(sw);
+	I2C_SW_DELAY(sw);
+
+	if (!SCL_IN(sw))
+	{
+		I2C_bus_start_timeout(&sw->bus);
+		do
+		{
+			if (I2C_bus_timeout(&sw->bus))	{ return false; }
+			I2C_SW_DELAY(sw);
+		} while (!SCL_IN(sw));
+	}
+
+	return true;
+}
+
+/*!\brief Send a bit (SCL low on entry & exit)
+** \param [in, out] sw - pointer to the bit-banged bus structure
+** \param [in] bit - bit value
+** \return true if bit sent (false on timeout or arbitration loss)
+**/
+static bool I2C_sw_wr_bit(I2C_SW_BUS * sw, const bool bit)
+{
+	if (bit)	{ SDA_REL(sw); }
+	else		{ SDA_LOW(sw); }
+	I2C_SW_DELAY(sw);
+
+	if (!I2C_sw_clock(sw))		{ return false; }
+	if (bit && !SDA_IN(sw))		{ return false; }	// Arbitration lost
+
+	SCL_LOW(sw);
+	return true;
+}
+
+/*!\brief Receive a bit (SCL low on entry & exit)
+** \param [in, out] sw - pointer to the bit-banged bus structure
+** \param [in, out] bit - pointer to received bit
+** \return true if bit received (false on timeout)
+**/
+static bool I2C_sw_rd_bit(I2C_SW_BUS * sw, bool * bit)
+{
+	SDA_REL(sw);
+	I2C_SW_DELAY(sw);
+
+	if (!I2C_sw_clock(sw))		{ return false; }
+	*bit = SDA_IN(sw);
+
+	SCL_LOW(sw);
+	return true;
+}
+
+
+/*!\brief Bit-banged backend: set bus clock
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] speed - I2C bus speed in KHz (0 for I2C_STD)
+** \return Configured bus speed (bounded by F_CPU)
+**/
+static uint16_t I2C_sw_set_speed(I2C_BUS * bus, const uint16_t speed)
+{
+	const uint32_t	cycles = (F_CPU / 2000UL) / (speed ? speed : (uint16_t) I2C_STD);	// Half SCL period (same default as I2C_bus_set_speed)
+	uint32_t		loops = (cycles > (CI2C_SW_OVERHEAD + 3)) ? ((cycles - CI2C_SW_OVERHEAD + 2) / 3) : 1;
+
+	if (loops > 0xFF)	{ loops = 0xFF; }
+	I2C_SW(bus)->half = (uint8_t) loops;
+
+	return (uint16_t) ((F_CPU / 2000UL) / ((3 * loops) + CI2C_SW_OVERHEAD));
+}
+
+/*!\brief Bit-banged backend: send (repeated) start condition
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return true if start condition sent (false if bus busy or stuck)
+**/
+static bool I2C_sw_start(I2C_BUS * bus)
+{
+	I2C_SW_BUS * const sw = I2C_SW(bus);
+
+	if (sw->started)	// Repeated START: release SDA while SCL low, then clock high
+	{
+		SDA_REL(sw);
+		I2C_SW_DELAY(sw);
+		if (!I2C_sw_clock(sw))	{ I2C_sw_abort(sw); return false; }
+	}
+
+	if (!SDA_IN(sw) || !SCL_IN(sw))	{ return false; }	// Bus owned by another master (or stuck)
+
+	SDA_LOW(sw);
+	I2C_SW_DELAY(sw);
+	SCL_LOW(sw);
+
+	sw->started = true;
+	return true;
+}
+
+/*!\brief Bit-banged backend: send stop condition
+** \param [in, out] bus - pointer to the I2C bus structure
+** \return true if stop condition sent (false on timeout or arbitration loss)
+**/
+static bool I2C_sw_stop(I2C_BUS * bus)
+{
+	I2C_SW_BUS * const sw = I2C_SW(bus);
+
+	if (!sw->started)	{ return true; }
+
+	SDA_LOW(sw);
+	I2C_SW_DELAY(sw);
+	if (!I2C_sw_clock(sw))	{ I2C_sw_abort(sw); return false; }
+	SDA_REL(sw);
+	I2C_SW_DELAY(sw);
+
+	sw->started = false;
+	return SDA_IN(sw);
+}
+
+/*!\brief Bit-banged backend: send byte (address or data)
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in] dat - byte to be sent
+** \return true if byte acknowledged (stop condition sent on NACK)
+**/
+static bool I2C_sw_wr8(I2C_BUS * bus, const uint8_t dat)
+{
+	I2C_SW_BUS * const	sw = I2C_SW(bus);
+	bool				nack;
+
+	for (uint8_t mask = 0x80 ; mask != 0 ; mask >>= 1)
+	{
+		if (!I2C_sw_wr_bit(sw, (dat & mask) != 0))	{ I2C_sw_abort(sw); return false; }
+	}
+
+	if (!I2C_sw_rd_bit(sw, &nack))	{ I2C_sw_abort(sw); return false; }
+	if (nack)						{ bus->nack = true; (void) I2C_sw_stop(bus); return false; }
+
+	return true;
+}
+
+/*!\brief Bit-banged backend: receive byte
+** \param [in, out] bus - pointer to the I2C bus structure
+** \param [in, out] dat - pointer to received byte
+** \param [in] ack - true if byte has to be acknowledged
+** \return true if byte received (false on timeout or arbitration loss)
+**/
+static bool I2C_sw_rd8(I2C_BUS * bus, uint8_t * dat, const bool ack)
+{
+	I2C_SW_BUS * const	sw = I2C_SW(bus);
+	uint8_t				val = 0;
+	bool				bit;
+
+	for (uint8_t cnt = 8 ; cnt != 0 ; cnt--)
+	{
+		if (!I2C_sw_rd_bit(sw, &bit))	{ I2C_sw_abort(sw); return false; }
+		val = (uint8_t) ((val << 1) | bit);
+	}
+
+	if (!I2C_sw_wr_bit(sw, !ack))		{ I2C_sw_abort(sw); return false; }
+
+	*dat = val;
+	return true;
+}
+
+
+/*!\brief Init a bit-banged bus on two GPIO pins (lines released)
+** \param [in, out] sw - pointer to the bit-banged bus structure to init
+** \param [in] sda_pin - SDA Arduino pin number
+** \param [in] scl_pin - SCL Arduino pin number
+** \param [in] speed - I2C bus speed in KHz (max 400KHz, actual speed bounded by F_CPU)
+** \return true if pins are valid
+**/
+bool I2C_sw_init(I2C_SW_BUS * sw, const uint8_t sda_pin, const uint8_t scl_pin, const uint16_t speed)
+{
+	const uint8_t	sda_port = digitalPinToPort(sda_pin);
+	const uint8_t	scl_port = digitalPinToPort(scl_pin);
+	uint8_t			oldSREG;
+
+	if ((sda_port == NOT_A_PIN) || (scl_port == NOT_A_PIN) || (sda_pin == scl_pin))	{ return false; }
+
+	sw->sda_in = portInputRegister(sda_port);
+	sw->sda_dir = portModeRegister(sda_port);
+	sw->sda_mask = digitalPinToBitMask(sda_pin);
+	sw->scl_in = portInputRegister(scl_port);
+	sw->scl_dir = portModeRegister(scl_port);
+	sw->scl_mask = digitalPinToBitMask(scl_pin);
+
+	oldSREG = SREG;
+	cli();
+	SDA_REL(sw);	// Inputs (lines released)
+	SCL_REL(sw);
+	*portOutputRegister(sda_port) &= (uint8_t) ~sw->sda_mask;	// Output latches low (no internal pull-up, low when driven)
+	*portOutputRegister(scl_port) &= (uint8_t) ~sw->scl_mask;
+	SREG = oldSREG;
+
+	sw->started = false;
+	I2C_bus_init(&sw->bus, &i2c_sw_ops, speed);
+
+	return true;
+}
@@ -0,0 +1,66 @@
+/*!\file ci2c_sw.h
+** \author SMFSW
+** \copyright MIT SMFSW (2017-2018)
+** \brief arduino i2c in plain c bit-banged bus declarations
+** \details Software I2C master on any couple of GPIO pins (open drain emulated through port direction register),
+**			used as an I2C_BUS backend: slaves attached with I2C_slave_set_bus are then handled by I2C_read/I2C_write
+**			(and all services built on top of them) on this bus instead of hardware TWI.
+** \note Blocking bus (CPU busy clocking lines): hardware TWI asynchronous transactions & slave mode keep running meanwhile.
+** \warning External pull-ups required on both lines (port direction registers changed with interrupts disabled, other pins of the ports may be driven from interrupts).
+**/
+/****************************************************************/
+#ifndef __CI2C_SW_H__
+	#define __CI2C_SW_H__
+/****************************************************************/
+
+#include "ci2c.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CI2C_SW_OVERHEAD
+#define CI2C_SW_OVERHEAD		17		//!< CPU cycles spent per half SCL period out of delay loop (may be overridden through compiler flags)
+#endif
+
+
+/*!\struct StructI2CSwBus
+** \brief ci2c bit-banged bus (pins & timing)
+**/
+typedef struct StructI2CSwBus {
+	I2C_BUS				bus;		//!< Generic bus (first member, pointer given to I2C_slave_set_bus)
+	volatile uint8_t *	sda_in;		//!< SDA port input register
+	volatile uint8_t *	sda_dir;	//!< SDA port direction register
+	volatile uint8_t *	scl_in;		//!< SCL port input register
+	volatile uint8_t *	scl_dir;	//!< SCL port direction register
+	uint8_t				sda_mask;	//!< SDA pin mask in port
+	uint8_t				scl_mask;	//!< SCL pin mask in port
+	uint8_t				half;		//!< Delay loops (3 cycles each) per half SCL period
+	bool				started;	//!< true if bus is owned (START sent)
+} I2C_SW_BUS;
+
+
+/*!\brief Init a bit-banged bus on two GPIO pins (lines released)
+** \param [in, out] sw - pointer to the bit-banged bus structure to init
+** \param [in] sda_pin - SDA Arduino pin number
+** \param [in] scl_pin - SCL Arduino pin number
+** \param [in] speed - I2C bus speed in KHz (max 400KHz, actual speed bounded by F_CPU)
+** \return true if pins are valid
+**/
+bool I2C_sw_init(I2C_SW_BUS * sw, const uint8_t sda_pin, const uint8_t scl_pin, const uint16_t speed);
+
+/*!\brief Get generic bus of a bit-banged bus (to attach slaves with I2C_slave_set_bus)
+** \attribute inline
+** \param [in] sw - pointer to the bit-banged bus structure
+** \return pointer to the I2C bus structure
+**/
+inline I2C_BUS * __attribute__((__always_inline__)) I2C_sw_get_bus(I2C_SW_BUS * sw) {
+	return &sw->bus; }
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif